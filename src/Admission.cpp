@@ -0,0 +1,135 @@
+/*******************************************************************************
+ * Admission.cpp
+ *
+ * Connection admission control for the game server.
+ *
+ * Architecture:
+ * - Requests are only recorded when they arrive; admit() runs once per server
+ *   update and hands out at most what the token bucket and the handshake cap
+ *   allow, so a storm costs a queue push per connection and nothing else
+ * - Closed connections are removed from the queues lazily (the waiting set
+ *   is the source of truth), keeping close O(1)
+ * - Held seats expire on their own; tokens are random and single-use
+ ******************************************************************************/
+
+#include "Admission.h"
+#include <random>
+
+AdmissionControl::AdmissionControl()
+    : acceptRate(ACCEPTS_PER_SECOND, ACCEPT_BURST) {
+}
+
+/**
+ * Queues a connection request.
+ *
+ * @param connection The connecting handle
+ * @param address Remote address; requests from the address of a held seat go first
+ * @param now Current time
+ * @return false if the queue is full and the request must be refused
+ */
+bool AdmissionControl::request(ConnectionId connection, const std::string& address, Clock::time_point now) {
+    totals.requested++;
+    if (queued() >= MAX_QUEUED) {
+        totals.refusedBusy++;
+        return false;
+    }
+
+    // Entries of abandoned requests are normally skipped by admit(); drop them here
+    // too when requests pile up faster than they are admitted
+    if (priorityQueue.size() + queue.size() >= 2 * MAX_QUEUED) {
+        for (auto* pending : {&priorityQueue, &queue}) {
+            std::erase_if(*pending, [this](ConnectionId id) { return !waiting.count(id); });
+        }
+    }
+
+    expireSeats(now);
+    bool resuming = false;
+    for (const auto& [token, seat] : heldSeatsByToken) {
+        resuming = resuming || seat.address == address;
+    }
+    (resuming ? priorityQueue : queue).push_back(connection);
+    waiting.insert(connection);
+    return true;
+}
+
+std::vector<AdmissionControl::ConnectionId> AdmissionControl::admit(Clock::time_point now) {
+    std::vector<ConnectionId> admitted;
+    while (pendingHandshakes.size() < MAX_PENDING_HANDSHAKES && (!priorityQueue.empty() || !queue.empty())) {
+        auto& source = priorityQueue.empty() ? queue : priorityQueue;
+        ConnectionId connection = source.front();
+        if (!waiting.count(connection)) {
+            source.pop_front();     // Closed while queued
+            continue;
+        }
+        if (!acceptRate.consume(now)) {
+            break;
+        }
+        source.pop_front();
+        waiting.erase(connection);
+        pendingHandshakes.insert(connection);
+        admitted.push_back(connection);
+        totals.admitted++;
+    }
+    return admitted;
+}
+
+void AdmissionControl::connected(ConnectionId connection) {
+    if (pendingHandshakes.erase(connection)) {
+        totals.connected++;
+    }
+}
+
+void AdmissionControl::closed(ConnectionId connection) {
+    if (waiting.erase(connection) || pendingHandshakes.erase(connection)) {
+        totals.abandoned++;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Resume Tokens
+ *---------------------------------------------------------------------------*/
+
+std::string AdmissionControl::issueResumeToken() {
+    static thread_local std::mt19937_64 generator{std::random_device{}()};
+    static const char HEX[] = "0123456789abcdef";
+
+    std::string token;
+    for (int part = 0; part < 2; part++) {
+        uint64_t bits = generator();
+        for (int digit = 0; digit < 16; digit++) {
+            token.push_back(HEX[(bits >> (4 * digit)) & 0xF]);
+        }
+    }
+    return token;
+}
+
+void AdmissionControl::holdSeat(const std::string& token, const std::string& address, Clock::time_point now) {
+    if (!token.empty()) {
+        heldSeatsByToken[token] = HeldSeat{address, now + std::chrono::milliseconds(RESUME_WINDOW_MS)};
+    }
+}
+
+bool AdmissionControl::resume(const std::string& token, Clock::time_point now) {
+    expireSeats(now);
+    if (token.empty() || !heldSeatsByToken.erase(token)) {
+        return false;
+    }
+    totals.resumed++;
+    return true;
+}
+
+bool AdmissionControl::isHeld(const std::string& token, Clock::time_point now) {
+    expireSeats(now);
+    return heldSeatsByToken.count(token) > 0;
+}
+
+size_t AdmissionControl::heldSeats(Clock::time_point now) {
+    expireSeats(now);
+    return heldSeatsByToken.size();
+}
+
+void AdmissionControl::expireSeats(Clock::time_point now) {
+    for (auto it = heldSeatsByToken.begin(); it != heldSeatsByToken.end();) {
+        it = now >= it->second.expires ? heldSeatsByToken.erase(it) : std::next(it);
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "TokenBucket.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Connection admission for GameServer (network thread only). Connection requests wait
+// in a bounded queue and are accepted at a bounded rate, with a cap on how many
+// accepted connections may still be completing their handshake, so a reconnect wave
+// is spread out instead of stalling the matches in progress.
+//
+// Resume tokens: every player gets one in its handshake. When it drops, its seat is
+// held for RESUME_WINDOW_MS; the token reclaims the seat, and requests from the address
+// of a held seat skip the ordinary queue.
+class AdmissionControl {
+public:
+    using Clock = std::chrono::steady_clock;
+    using ConnectionId = uint32_t;
+
+    static constexpr double ACCEPTS_PER_SECOND = 20.0;
+    static constexpr double ACCEPT_BURST = 10.0;
+    static constexpr size_t MAX_PENDING_HANDSHAKES = 16;
+    static constexpr size_t MAX_QUEUED = 256;
+    static constexpr int RESUME_WINDOW_MS = 30000;
+
+    // Running totals, reported as one summary line instead of a line per connection
+    struct Counters {
+        uint64_t requested = 0;     // Connection attempts
+        uint64_t admitted = 0;      // Accepted by the transport
+        uint64_t connected = 0;     // Finished the transport handshake
+        uint64_t refusedBusy = 0;   // Queue was full
+        uint64_t refusedFull = 0;   // No free seat
+        uint64_t abandoned = 0;     // Gave up while queued or handshaking
+        uint64_t resumed = 0;       // Reclaimed a held seat
+        uint64_t disconnected = 0;  // Connected clients removed for any reason
+
+        bool operator==(const Counters&) const = default;
+    };
+
+    AdmissionControl();
+
+    // Queues a connection request; false if it has to be refused right away
+    bool request(ConnectionId connection, const std::string& address, Clock::time_point now);
+    // Requests to accept now: held-seat addresses first, within the accept rate and handshake cap
+    std::vector<ConnectionId> admit(Clock::time_point now);
+    void connected(ConnectionId connection);
+    // Gone at whatever stage (queued, handshaking or connected)
+    void closed(ConnectionId connection);
+
+    std::string issueResumeToken();
+    void holdSeat(const std::string& token, const std::string& address, Clock::time_point now);
+    // Consumes the hold if the token still has one
+    bool resume(const std::string& token, Clock::time_point now);
+    bool isHeld(const std::string& token, Clock::time_point now);
+    size_t heldSeats(Clock::time_point now);
+
+    Counters& counters() { return totals; }
+    size_t queued() const { return waiting.size(); }
+    size_t handshaking() const { return pendingHandshakes.size(); }
+    bool tracks(ConnectionId connection) const { return waiting.count(connection) || pendingHandshakes.count(connection); }
+
+private:
+    struct HeldSeat {
+        std::string address;
+        Clock::time_point expires;
+    };
+
+    TokenBucket acceptRate;
+    std::deque<ConnectionId> priorityQueue;
+    std::deque<ConnectionId> queue;
+    std::unordered_set<ConnectionId> waiting;               // Queued and not yet abandoned
+    std::unordered_set<ConnectionId> pendingHandshakes;
+    std::unordered_map<std::string, HeldSeat> heldSeatsByToken;
+    Counters totals;
+
+    void expireSeats(Clock::time_point now);
+};
@@ -0,0 +1,605 @@
+/*******************************************************************************
+ * AnalysisTool.cpp
+ *
+ * Headless command-line front end for the search engines, intended for analysis
+ * servers (no window, no networking).
+ *
+ * Commands:
+ * - bench [maxThreads] [depth] [repeats] [network]: Lazy SMP nodes-per-second scaling,
+ *   optionally with NNUE evaluation ("line" = built-in network, or a weights file)
+ * - nnue-export <file>: write the built-in line network as a weights file
+ * - solve <file> [threads] [memoryMB] [maxNodes]: exact df-pn solutions for a file
+ *   of positions, solved in parallel and streamed to stdout as they finish
+ * - tablebase <file> [threads]: generate the endgame tablebase (retrograde analysis)
+ * - probe <file> <position>: look up a position in a tablebase
+ * - tournament <output> <engines> [games] [threads] [swissRounds]: bot-vs-bot
+ *   tournament between engine specs, results streamed to <output>
+ * - selfplay <output> [games] [threads] [depth]: self-play training dataset
+ * - dataset <file>: summary of a self-play dataset
+ * - perft [depth] [threads] [position]: leaf counts of every engine variant, checked
+ *   against known-good counts, split across threads by root move
+ ******************************************************************************/
+
+#include "Board.h"
+#include "Dataset.h"
+#include "Nnue.h"
+#include "ProofNumberSolver.h"
+#include "SearchEngine.h"
+#include "SelfPlay.h"
+#include "Tablebase.h"
+#include "Tournament.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Bench positions, row-major, '.' = empty. Side to move follows from the mark counts.
+const char* BENCH_POSITIONS[] = {
+    ".........",
+    "....X....",
+    "X...O....",
+    "X.O.X....",
+    ".X..O..X.",
+    "XO..X...O",
+};
+
+/**
+ * Loads a position string (one character per cell) into the board.
+ *
+ * @param text Row-major position ('X', 'O', '.')
+ * @param board Board to fill (reset first)
+ * @param toMove Set to the side to move (X moves first, so O moves when the counts are unequal)
+ * @param error Set if the string is not a legal position
+ * @param allowFinished Also accept positions whose game is already over
+ * @return false for the wrong length, unknown characters, mark counts no game can reach,
+ *         or (unless allowFinished) a finished game
+ */
+bool loadPosition(const std::string& text, Board& board, TileState& toMove, std::string& error,
+                  bool allowFinished = false) {
+    board.resetBoard();
+    int size = board.getSize();
+    if (text.size() != static_cast<size_t>(size * size)) {
+        error = "expected " + std::to_string(size * size) + " cells, got " + std::to_string(text.size());
+        return false;
+    }
+
+    int xCount = 0;
+    int oCount = 0;
+    for (int i = 0; i < size * size; i++) {
+        if (text[i] == 'X' || text[i] == 'x') {
+            board.setTile(i % size, i / size, TileState::X);
+            xCount++;
+        } else if (text[i] == 'O' || text[i] == 'o') {
+            board.setTile(i % size, i / size, TileState::O);
+            oCount++;
+        } else if (text[i] != '.') {
+            error = std::string("unknown cell '") + text[i] + "'";
+            return false;
+        }
+    }
+
+    if (xCount != oCount && xCount != oCount + 1) {
+        error = "impossible mark counts (" + std::to_string(xCount) + " X, " + std::to_string(oCount) + " O)";
+        return false;
+    }
+    if (!allowFinished && board.checkWinner() != GameResult::IN_PROGRESS) {
+        error = "game is already over";
+        return false;
+    }
+    toMove = xCount > oCount ? TileState::O : TileState::X;
+    return true;
+}
+
+/**
+ * Runs the bench positions at increasing thread counts (1, 2, 4, ... maxThreads) and
+ * reports nodes per second and speedup relative to a single thread.
+ *
+ * @param networkName Empty for the hand-written evaluation, "line" or a weights file for NNUE
+ */
+int runBench(int maxThreads, int depth, int repeats, const std::string& networkName) {
+    std::shared_ptr<NnueNetwork> network;
+    if (networkName == "line") {
+        network = std::make_shared<NnueNetwork>(NnueNetwork::createLineNetwork(Board().getSize()));
+        if (!network->isLoaded()) {
+            return 1;
+        }
+    } else if (!networkName.empty()) {
+        network = std::make_shared<NnueNetwork>();
+        if (!network->load(networkName)) {
+            return 1;
+        }
+    }
+
+    auto table = std::make_shared<TranspositionTable>(16);
+
+    printf("[BENCH] depth=%d repeats=%d hardware threads=%u eval=%s\n",
+           depth, repeats, std::thread::hardware_concurrency(),
+           network ? NnueNetwork::simdName() : "classic");
+    printf("%8s %14s %12s %14s %8s %12s %9s %8s %10s\n",
+           "threads", "nodes", "time(ms)", "nps", "speedup", "cutoffs", "1st-cut%", "tt hit%", "tt coll");
+
+    // Powers of two, always finishing with exactly maxThreads
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    double baselineNps = 0.0;
+    for (int threads : threadCounts) {
+        SearchConfig config;
+        config.maxDepth = depth;
+        config.threadCount = threads;
+
+        uint64_t totalNodes = 0;
+        uint64_t cutoffs = 0;
+        uint64_t firstMoveCutoffs = 0;
+        double totalMs = 0.0;
+        TableStats tableStats;
+
+        for (int r = 0; r < repeats; r++) {
+            for (const char* position : BENCH_POSITIONS) {
+                // Clear between runs so every search starts from the same state
+                table->clear();
+                SearchEngine engine(config, table);
+                engine.setNetwork(network);
+                Board board;
+                TileState toMove = TileState::X;
+                std::string error;
+                loadPosition(position, board, toMove, error);
+
+                SearchResult result = engine.findBestMove(board, toMove);
+                totalNodes += result.nodes;
+                cutoffs += result.cutoffs;
+                firstMoveCutoffs += result.firstMoveCutoffs;
+                totalMs += result.elapsedMs;
+                tableStats += result.tableStats;
+            }
+        }
+
+        double nps = totalMs > 0.0 ? totalNodes * 1000.0 / totalMs : 0.0;
+        if (threads == 1) {
+            baselineNps = nps;
+        }
+        printf("%8d %14llu %12.2f %14.0f %7.2fx %12llu %8.1f%% %7.1f%% %10llu\n", threads,
+               static_cast<unsigned long long>(totalNodes), totalMs, nps,
+               baselineNps > 0.0 ? nps / baselineNps : 0.0,
+               static_cast<unsigned long long>(cutoffs),
+               cutoffs > 0 ? firstMoveCutoffs * 100.0 / cutoffs : 0.0,
+               tableStats.hitRate() * 100.0,
+               static_cast<unsigned long long>(tableStats.collisions));
+    }
+    return 0;
+}
+
+// Known-good perft counts from the empty 3x3 board (index = depth). Finished games end a
+// move sequence, so counts drop below 9!/(9-depth)! from depth 6 on.
+const uint64_t PERFT_START_COUNTS[] = {1, 9, 72, 504, 3024, 15120, 54720, 148176, 200448, 127872};
+
+uint64_t perftTotal(const uint64_t* divide, size_t count) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += divide[i];
+    }
+    return total;
+}
+
+/**
+ * Counts perft leaves for every engine variant (classic evaluation and NNUE accumulator,
+ * which take different make/unmake paths) at depths 1..maxDepth. Root moves are shared
+ * out between worker threads. Counts from the start position are checked against
+ * PERFT_START_COUNTS, every root move checks that unmake restored the Zobrist hash, and
+ * the NNUE variant checks its incremental accumulator against a refresh at every leaf.
+ *
+ * @param position Row-major position string, empty for the start position
+ * @return 0 if every count, hash and accumulator matched, 1 otherwise
+ */
+int runPerft(int maxDepth, int threads, const std::string& position) {
+    Board start;
+    TileState toMove = TileState::X;
+    std::string error;
+    if (!position.empty() && !loadPosition(position, start, toMove, error)) {
+        fprintf(stderr, "[PERFT] Invalid position %s: %s\n", position.c_str(), error.c_str());
+        return 1;
+    }
+    bool fromStart = position.find_first_not_of(". ") == std::string::npos;
+    int size = start.getSize();
+
+    std::vector<int> rootMoves;
+    if (start.checkWinner() == GameResult::IN_PROGRESS) {
+        for (int cell = 0; cell < size * size; cell++) {
+            if (start.getTile(cell % size, cell / size) == TileState::EMPTY) {
+                rootMoves.push_back(cell);
+            }
+        }
+    }
+
+    struct Variant {
+        const char* name;
+        std::shared_ptr<const NnueNetwork> network;
+    };
+    const Variant variants[] = {
+        {"classic", nullptr},
+        {"nnue", std::make_shared<NnueNetwork>(NnueNetwork::createLineNetwork(size))},
+    };
+
+    printf("[PERFT] position=%s side=%c threads=%d\n", position.empty() ? "start" : position.c_str(),
+           toMove == TileState::X ? 'X' : 'O', threads);
+    printf("%8s %6s %12s %12s %10s %14s %s\n", "engine", "depth", "leaves", "expected", "time(ms)", "nps", "status");
+
+    bool allPassed = true;
+    for (const Variant& variant : variants) {
+        // perft never probes the table, so the smallest one will do
+        SearchEngine engine(SearchConfig(), std::make_shared<TranspositionTable>(1));
+        engine.setNetwork(variant.network);
+
+        for (int depth = 1; depth <= maxDepth; depth++) {
+            std::vector<uint64_t> divide(rootMoves.size(), 0);
+            std::atomic<size_t> nextIndex{0};
+            std::atomic<bool> hashRestored{true};
+            std::atomic<bool> accumulatorMatches{true};
+            std::vector<std::thread> workers;
+
+            auto startTime = std::chrono::steady_clock::now();
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&]() {
+                    Board board = start;
+                    TileState opponent = toMove == TileState::X ? TileState::O : TileState::X;
+                    size_t index;
+                    while ((index = nextIndex.fetch_add(1)) < rootMoves.size()) {
+                        int cell = rootMoves[index];
+                        uint64_t hash = board.getHash();
+                        board.setTile(cell % size, cell / size, toMove);
+                        bool matches = true;
+                        divide[index] = engine.perft(board, opponent, depth - 1, matches);
+                        board.clearTile(cell % size, cell / size);
+                        if (board.getHash() != hash) {
+                            hashRestored = false;
+                        }
+                        if (!matches) {
+                            accumulatorMatches = false;
+                        }
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+            uint64_t leaves = perftTotal(divide.data(), divide.size());
+            bool known = fromStart && depth < static_cast<int>(sizeof(PERFT_START_COUNTS) / sizeof(PERFT_START_COUNTS[0]));
+            bool passed = hashRestored && accumulatorMatches && (!known || leaves == PERFT_START_COUNTS[depth]);
+            allPassed = allPassed && passed;
+
+            char expected[24] = "-";
+            if (known) {
+                snprintf(expected, sizeof(expected), "%llu", static_cast<unsigned long long>(PERFT_START_COUNTS[depth]));
+            }
+            printf("%8s %6d %12llu %12s %10.2f %14.0f %s\n", variant.name, depth,
+                   static_cast<unsigned long long>(leaves), expected, ms, ms > 0.0 ? leaves * 1000.0 / ms : 0.0,
+                   !hashRestored ? "HASH MISMATCH"
+                       : !accumulatorMatches ? "NNUE MISMATCH"
+                       : !passed ? "COUNT MISMATCH"
+                       : known ? "ok" : "unchecked");
+
+            // Per-root-move breakdown of a failing depth narrows down the bad move
+            if (!passed) {
+                for (size_t i = 0; i < rootMoves.size(); i++) {
+                    printf("%14d,%d: %llu\n", rootMoves[i] % size, rootMoves[i] / size,
+                           static_cast<unsigned long long>(divide[i]));
+                }
+            }
+        }
+    }
+
+    printf("[PERFT] %s\n", allPassed ? "all counts match" : "MISMATCH");
+    return allPassed ? 0 : 1;
+}
+
+/**
+ * Solves every position in a file (one position string per line, '#' starts a comment)
+ * with one df-pn solver per worker thread. Results are printed as soon as each position
+ * is solved, so output order follows completion, not input order.
+ */
+int runSolve(const std::string& path, int threads, size_t memoryMB, uint64_t maxNodes) {
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "[SOLVE] Cannot open %s\n", path.c_str());
+        return 1;
+    }
+
+    // Invalid lines are reported and skipped; they make the exit status 1
+    struct Position {
+        std::string text;
+        Board board;
+        TileState toMove = TileState::X;
+    };
+    std::vector<Position> positions;
+    size_t rejected = 0;
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); lineNumber++) {
+        line.erase(std::find(line.begin(), line.end(), '#'), line.end());
+        line.erase(std::remove_if(line.begin(), line.end(), ::isspace), line.end());
+        if (line.empty()) {
+            continue;
+        }
+        Position position;
+        std::string error;
+        if (!loadPosition(line, position.board, position.toMove, error)) {
+            fprintf(stderr, "[SOLVE] %s:%d: rejected \"%s\": %s\n", path.c_str(), lineNumber, line.c_str(), error.c_str());
+            rejected++;
+            continue;
+        }
+        position.text = line;
+        positions.push_back(std::move(position));
+    }
+
+    printf("[SOLVE] %zu positions (%zu rejected), %d threads, %zu MB per solver\n", positions.size(), rejected, threads,
+           memoryMB);
+
+    std::atomic<size_t> nextIndex{0};
+    std::mutex outputMutex;
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            SolverConfig config;
+            config.memoryMB = memoryMB;
+            config.maxNodes = maxNodes;
+            ProofNumberSolver solver(config);
+
+            size_t index;
+            while ((index = nextIndex.fetch_add(1)) < positions.size()) {
+                Board board = positions[index].board;
+                TileState toMove = positions[index].toMove;
+                SolveResult result = solver.solve(board, toMove);
+
+                std::lock_guard<std::mutex> lock(outputMutex);
+                printf("%zu %s %c %s", index, positions[index].text.c_str(),
+                       toMove == TileState::X ? 'X' : 'O', ProofNumberSolver::outcomeName(result.outcome));
+                if (result.bestX >= 0) {
+                    printf(" move=%d,%d", result.bestX, result.bestY);
+                }
+                printf(" nodes=%llu ms=%.3f\n", static_cast<unsigned long long>(result.nodes), result.elapsedMs);
+                fflush(stdout);
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return rejected == 0 ? 0 : 1;
+}
+
+/**
+ * Runs a bot-vs-bot tournament and prints the standings with Elo ratings.
+ *
+ * @param engineList Comma-separated engine specs, e.g. "random,d1,d2,d9"
+ * @param swissRounds 0 = round-robin, otherwise the number of Swiss rounds
+ */
+int runTournament(const std::string& outputPath, const std::string& engineList, int games, int threads, int swissRounds) {
+    TournamentConfig config;
+    config.outputPath = outputPath;
+    config.gamesPerPairing = games;
+    config.threads = threads;
+    config.format = swissRounds > 0 ? PairingFormat::SWISS : PairingFormat::ROUND_ROBIN;
+    config.swissRounds = swissRounds;
+
+    size_t begin = 0;
+    while (begin <= engineList.size()) {
+        size_t end = engineList.find(',', begin);
+        if (end == std::string::npos) {
+            end = engineList.size();
+        }
+        EngineSpec spec;
+        std::string text = engineList.substr(begin, end - begin);
+        if (!EngineSpec::parse(text, spec)) {
+            fprintf(stderr, "[TOURNAMENT] Invalid engine '%s' (use random, d<depth> or name=d<depth>)\n", text.c_str());
+            return 1;
+        }
+        config.engines.push_back(spec);
+        begin = end + 1;
+    }
+
+    printf("[TOURNAMENT] %zu engines, %s, %d games per pairing, %d threads\n", config.engines.size(),
+           swissRounds > 0 ? "swiss" : "round-robin", games, threads);
+
+    auto start = std::chrono::steady_clock::now();
+    Tournament tournament(config);
+    if (!tournament.run()) {
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<EngineStanding> standings = tournament.getStandings();
+    std::sort(standings.begin(), standings.end(),
+              [](const EngineStanding& a, const EngineStanding& b) { return a.elo > b.elo; });
+
+    int totalGames = 0;
+    printf("%-12s %7s %6s %6s %6s %7s %9s %9s\n", "engine", "games", "wins", "draws", "losses", "score", "elo", "+/-");
+    for (const EngineStanding& standing : standings) {
+        printf("%-12s %7d %6d %6d %6d %6.1f%% %9.1f %9.1f\n", standing.name.c_str(), standing.games,
+               standing.wins, standing.draws, standing.losses, standing.score() * 100.0,
+               standing.elo, standing.eloError);
+        totalGames += standing.games;
+    }
+    printf("[TOURNAMENT] %d games in %.2f s, results in %s\n", totalGames / 2, seconds, outputPath.c_str());
+    return 0;
+}
+
+/**
+ * Generates a self-play dataset and reports throughput and compression.
+ */
+int runSelfPlay(const std::string& outputPath, uint64_t games, int threads, int depth) {
+    SelfPlayConfig config;
+    config.outputPath = outputPath;
+    config.games = games;
+    config.threads = threads;
+    config.depth = depth;
+
+    printf("[SELFPLAY] %llu games, %d threads, depth %d\n",
+           static_cast<unsigned long long>(games), threads, depth);
+
+    SelfPlayGenerator generator(config);
+    SelfPlayStats stats;
+    if (!generator.run(stats)) {
+        return 1;
+    }
+
+    printf("[SELFPLAY] %llu games, %llu rows, %llu bytes (%.2f bytes/row, %zu bytes raw) in %.2f s (%.0f rows/s)\n",
+           static_cast<unsigned long long>(stats.games), static_cast<unsigned long long>(stats.rows),
+           static_cast<unsigned long long>(stats.bytes),
+           stats.rows > 0 ? static_cast<double>(stats.bytes) / stats.rows : 0.0, sizeof(TrainingSample),
+           stats.elapsedMs / 1000.0, stats.elapsedMs > 0.0 ? stats.rows * 1000.0 / stats.elapsedMs : 0.0);
+    return 0;
+}
+
+/**
+ * Reads a dataset chunk by chunk and prints row counts and the result distribution.
+ */
+int runDatasetInfo(const std::string& path) {
+    DatasetReader reader;
+    if (!reader.open(path)) {
+        fprintf(stderr, "[DATASET] Cannot open %s\n", path.c_str());
+        return 1;
+    }
+
+    std::vector<TrainingSample> samples;
+    uint64_t chunks = 0;
+    uint64_t rows = 0;
+    uint64_t results[3] = {0, 0, 0};
+    uint64_t bestMovePlayed = 0;
+    while (reader.readChunk(samples)) {
+        chunks++;
+        rows += samples.size();
+        for (const TrainingSample& sample : samples) {
+            results[sample.result + 1]++;
+            bestMovePlayed += sample.bestMove == sample.playedMove;
+        }
+    }
+
+    printf("[DATASET] %llu chunks, %llu rows: win %llu / draw %llu / loss %llu, best move played %.1f%%\n",
+           static_cast<unsigned long long>(chunks), static_cast<unsigned long long>(rows),
+           static_cast<unsigned long long>(results[2]), static_cast<unsigned long long>(results[1]),
+           static_cast<unsigned long long>(results[0]), rows > 0 ? bestMovePlayed * 100.0 / rows : 0.0);
+    return 0;
+}
+
+void printUsage(const char* program) {
+    printf("Usage: %s <command> [options]\n", program);
+    printf("  bench [maxThreads] [depth] [repeats] [network]  Lazy SMP nodes/second scaling (network: line or file)\n");
+    printf("  nnue-export <file>                              Write the built-in line network\n");
+    printf("  solve <file> [threads] [memoryMB] [maxNodes]    Exact df-pn solutions, one position per line\n");
+    printf("  tablebase <file> [threads]                      Generate the endgame tablebase\n");
+    printf("  probe <file> <position>                         Look up a position in a tablebase\n");
+    printf("  tournament <output> <engines> [games] [threads] [swissRounds]\n");
+    printf("                                                  Bot-vs-bot tournament (engines: random,d1,...,d9)\n");
+    printf("  selfplay <output> [games] [threads] [depth]     Self-play training dataset\n");
+    printf("  dataset <file>                                  Summary of a self-play dataset\n");
+    printf("  perft [depth] [threads] [position]              Leaf counts per engine, checked against known counts\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string command = argv[1];
+
+    if (command == "bench") {
+        int maxThreads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+        int depth = argc > 3 ? std::atoi(argv[3]) : 9;
+        int repeats = argc > 4 ? std::atoi(argv[4]) : 200;
+        std::string network = argc > 5 ? argv[5] : "";
+        return runBench(std::max(1, maxThreads), depth, std::max(1, repeats), network);
+    }
+
+    if (command == "nnue-export" && argc > 2) {
+        return NnueNetwork::createLineNetwork(Board().getSize()).save(argv[2]) ? 0 : 1;
+    }
+
+    if (command == "solve" && argc > 2) {
+        int threads = argc > 3 ? std::atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+        size_t memoryMB = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 64;
+        uint64_t maxNodes = argc > 5 ? std::strtoull(argv[5], nullptr, 10) : 0;
+        return runSolve(argv[2], std::max(1, threads), memoryMB, maxNodes);
+    }
+
+    if (command == "tablebase" && argc > 2) {
+        int threads = argc > 3 ? std::atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+        return Tablebase::generate(argv[2], std::max(1, threads)) ? 0 : 1;
+    }
+
+    if (command == "probe" && argc > 3) {
+        Tablebase tablebase;
+        if (!tablebase.open(argv[2])) {
+            return 1;
+        }
+
+        Board board;
+        TileState toMove = TileState::X;
+        std::string error;
+        if (!loadPosition(argv[3], board, toMove, error, true)) {
+            fprintf(stderr, "Invalid position %s: %s\n", argv[3], error.c_str());
+            return 1;
+        }
+        int x = -1;
+        int y = -1;
+        SolveOutcome outcome = SolveOutcome::UNKNOWN;
+        if (!tablebase.bestMove(board, toMove, x, y, outcome) && !tablebase.probe(board, outcome)) {
+            printf("%s not covered (illegal position)\n", argv[3]);
+            return 1;
+        }
+        printf("%s %c %s", argv[3], toMove == TileState::X ? 'X' : 'O', ProofNumberSolver::outcomeName(outcome));
+        if (x >= 0) {
+            printf(" move=%d,%d", x, y);
+        }
+        printf("\n");
+        return 0;
+    }
+
+    if (command == "tournament" && argc > 3) {
+        int games = argc > 4 ? std::atoi(argv[4]) : 100;
+        int threads = argc > 5 ? std::atoi(argv[5]) : static_cast<int>(std::thread::hardware_concurrency());
+        int swissRounds = argc > 6 ? std::atoi(argv[6]) : 0;
+        return runTournament(argv[2], argv[3], std::max(1, games), std::max(1, threads), std::max(0, swissRounds));
+    }
+
+    if (command == "selfplay" && argc > 2) {
+        uint64_t games = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10000;
+        int threads = argc > 4 ? std::atoi(argv[4]) : static_cast<int>(std::thread::hardware_concurrency());
+        int depth = argc > 5 ? std::atoi(argv[5]) : 9;
+        return runSelfPlay(argv[2], games, std::max(1, threads), std::max(1, depth));
+    }
+
+    if (command == "dataset" && argc > 2) {
+        return runDatasetInfo(argv[2]);
+    }
+
+    if (command == "perft") {
+        int depth = argc > 2 ? std::atoi(argv[2]) : 9;
+        int threads = argc > 3 ? std::atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+        std::string position = argc > 4 ? argv[4] : "";
+        return runPerft(std::max(1, depth), std::max(1, threads), position);
+    }
+
+    printUsage(argv[0]);
+    return 1;
+}
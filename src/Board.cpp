@@ -11,10 +11,47 @@
  ******************************************************************************/
 
 #include "Board.h"
+#include <algorithm>
 #include <cstdio>
 
+namespace {
+
+// Deterministic Zobrist keys: every process (server, client, analysis tools) derives
+// the same table, so hashes can be compared across machines.
+struct ZobristTable {
+    uint64_t keys[3][3][3]; // [y][x][mark]
+    uint64_t oToMove;       // Mixed into state digests when O is to move
+
+    ZobristTable() {
+        uint64_t state = 0x4D41315A6F627269ULL;
+        for (auto& row : keys) {
+            for (auto& cell : row) {
+                cell[0] = 0; // EMPTY never contributes to the hash
+                for (int mark = 1; mark < 3; mark++) {
+                    // splitmix64
+                    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+                    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                    cell[mark] = z ^ (z >> 31);
+                }
+            }
+        }
+
+        // Drawn after the tile keys so those (and every stored hash) stay unchanged
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        oToMove = z ^ (z >> 31);
+    }
+};
+
+const ZobristTable zobristTable;
+
+} // namespace
+
 Board::Board()
-    : gridThickness(10)
+    : hash(0)
+    , gridThickness(10)
     , backgroundPadding(10)
     , gridColor({0, 0, 0, 255})
     , backgroundColor({187, 173, 160, 255})
@@ -49,9 +86,26 @@ bool Board::setTile(int x, int y, TileState mark) {
     }
 
     tiles[y][x] = mark;
+    hash ^= zobristKey(x, y, mark);
     return true;
 }
 
+/**
+ * Clears the tile at the specified grid coordinates, undoing a previous setTile.
+ * Used by the search engines to unmake moves without copying the board.
+ *
+ * @param x The x-coordinate of the tile (0-2)
+ * @param y The y-coordinate of the tile (0-2)
+ */
+void Board::clearTile(int x, int y) {
+    if (!isValidPosition(x, y) || tiles[y][x] == TileState::EMPTY) {
+        return;
+    }
+
+    hash ^= zobristKey(x, y, tiles[y][x]);
+    tiles[y][x] = TileState::EMPTY;
+}
+
 /**
  * Retrieves the state of the tile at the specified grid coordinates.
  *
@@ -60,7 +114,7 @@ bool Board::setTile(int x, int y, TileState mark) {
  * @return The TileState at the given coordinates, or EMPTY if invalid position
  */
 TileState Board::getTile(int x, int y) const {
-    if (isValidPosition(x, y)) {
+    if (!isValidPosition(x, y)) {
         return TileState::EMPTY;
     }
     return tiles[y][x];
@@ -113,6 +167,30 @@ GameResult Board::checkWinner() const {
     return GameResult::IN_PROGRESS;
 }
 
+/**
+ * Returns the Zobrist key for a mark on a given tile. XOR-ing the keys of all occupied
+ * tiles yields the position hash returned by getHash().
+ *
+ * @param x The x-coordinate of the tile (0-2)
+ * @param y The y-coordinate of the tile (0-2)
+ * @param mark The TileState on the tile
+ * @return The 64-bit key, or 0 for EMPTY
+ */
+uint64_t Board::zobristKey(int x, int y, TileState mark) {
+    return zobristTable.keys[y][x][static_cast<int>(mark)];
+}
+
+/**
+ * Returns the state digest: the Zobrist hash plus the side to move. Two peers whose
+ * digests match hold the same board with the same player to move.
+ *
+ * @param toMove The player to move
+ * @return The 64-bit digest
+ */
+uint64_t Board::getDigest(TileState toMove) const {
+    return hash ^ (toMove == TileState::O ? zobristTable.oToMove : 0);
+}
+
 /**
  * Checks if the board is completely filled with marks (no empty tiles).
  *
@@ -149,6 +227,7 @@ void Board::resetBoard() {
             tiles[y][x] = TileState::EMPTY;
         }
     }
+    hash = 0;
 }
 
 /**
@@ -172,6 +251,29 @@ void Board::render(SDL_Renderer *renderer, int tileSize, int offsetX, int offset
     }
 }
 
+/**
+ * Renders the hint heatmap over the empty tiles. Call after render().
+ *
+ * @param renderer The SDL_Renderer to draw on
+ * @param hints Per-cell evaluations (cells without a valid hint are skipped)
+ * @param tileSize The size of each tile in pixels
+ * @param offsetX The x-coordinate offset for rendering the grid
+ * @param offsetY The y-coordinate offset for rendering the grid
+ */
+void Board::renderHints(SDL_Renderer *renderer, const HintGrid &hints, int tileSize, int offsetX, int offsetY) {
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+    for (int y = 0; y < SIZE; y++) {
+        for (int x = 0; x < SIZE; x++) {
+            if (tiles[y][x] == TileState::EMPTY && hints[y][x].valid) {
+                drawHint(renderer, x, y, hints[y][x], tileSize, offsetX, offsetY);
+            }
+        }
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
+
 /**
  * Converts screen coordinates (mouseX, mouseY) to grid coordinates based on the tile size and grid offset.
  * Validates if the resulting grid position is within the bounds of the board.
@@ -295,6 +397,40 @@ void Board::drawMark(SDL_Renderer *renderer, int gridX, int gridY, TileState mar
     }
 }
 
+/**
+ * Draws one heatmap cell: green for winning moves, red for losing moves, yellow for
+ * drawn/neutral ones. Heuristic scores fade between the colors; forced results are solid.
+ *
+ * @param renderer The SDL_Renderer to draw on
+ * @param gridX The x-coordinate of the grid tile (0-2)
+ * @param gridY The y-coordinate of the grid tile (0-2)
+ * @param hint The evaluation of playing this tile
+ * @param tileSize The size of each tile in pixels
+ * @param offsetX The x-coordinate offset for rendering the grid
+ * @param offsetY The y-coordinate offset for rendering the grid
+ */
+void Board::drawHint(SDL_Renderer *renderer, int gridX, int gridY, const CellHint &hint, int tileSize, int offsetX,
+    int offsetY) {
+
+    // Map the score to [-1, 1]: forced wins/losses (|score| > 1000) saturate
+    float value = std::clamp(hint.score / 100.0f, -1.0f, 1.0f);
+    if (hint.score > 1000) value = 1.0f;
+    if (hint.score < -1000) value = -1.0f;
+
+    Uint8 red = static_cast<Uint8>(value > 0 ? 230 * (1.0f - value) : 230);
+    Uint8 green = static_cast<Uint8>(value < 0 ? 200 * (1.0f + value) : 200);
+
+    int inset = gridThickness;
+    SDL_FRect rect;
+    rect.x = offsetX + gridX * tileSize + inset;
+    rect.y = offsetY + gridY * tileSize + inset;
+    rect.w = tileSize - 2 * inset;
+    rect.h = tileSize - 2 * inset;
+
+    SDL_SetRenderDrawColor(renderer, red, green, 40, 110);
+    SDL_RenderFillRect(renderer, &rect);
+}
+
 /**
  * Draws an X mark at the specified center position with the given size.
  * Uses multiple lines to create a thicker X for better visibility.
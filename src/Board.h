@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 
 #include <SDL3/SDL.h>
 
@@ -17,15 +18,24 @@ enum class GameResult {
     DRAW = 3
 };
 
+// Per-cell evaluation for the hint overlay (score from the side to move's view)
+struct CellHint {
+    bool valid = false;
+    int score = 0;
+};
+using HintGrid = std::array<std::array<CellHint, 3>, 3>;
+
 class Board {
 public:
     Board();
     ~Board();
 
     void render(SDL_Renderer* renderer, int tileSize, int offsetX, int offsetY);
+    void renderHints(SDL_Renderer* renderer, const HintGrid& hints, int tileSize, int offsetX, int offsetY);
 
     // Game logic
     bool setTile(int x, int y, TileState mark);
+    void clearTile(int x, int y);
     TileState getTile(int x, int y) const;
     GameResult checkWinner() const;
     bool isFull() const;
@@ -45,6 +55,12 @@ public:
 
     int getSize() const { return SIZE; }
 
+    // Zobrist hash of the current position (maintained incrementally by setTile/clearTile)
+    uint64_t getHash() const { return hash; }
+    static uint64_t zobristKey(int x, int y, TileState mark);
+    // Hash plus side to move, exchanged with every network state update to detect desync
+    uint64_t getDigest(TileState toMove) const;
+
     // Setters
     void setGridColor(SDL_Color color) { gridColor = color; }
     void setBackgroundColor(SDL_Color color) { backgroundColor = color; }
@@ -54,6 +70,7 @@ public:
 private:
     static const int SIZE = 3;
     std::array<std::array<TileState, 3>, 3> tiles;
+    uint64_t hash;
 
     // Rendering properties
     int gridThickness;
@@ -65,6 +82,8 @@ private:
     void drawGrid(SDL_Renderer* renderer, int tileSize, int offsetX, int offsetY);
     void drawMark(SDL_Renderer* renderer, int gridX, int gridY, TileState mark,
                   int tileSize, int offsetX, int offsetY);
+    void drawHint(SDL_Renderer* renderer, int gridX, int gridY, const CellHint& hint,
+                  int tileSize, int offsetX, int offsetY);
     void drawX(SDL_Renderer* renderer, int x, int y, int size);
     void drawO(SDL_Renderer* renderer, int x, int y, int size);
 };
@@ -0,0 +1,209 @@
+/*******************************************************************************
+ * Chat.cpp
+ *
+ * Lobby and in-room chat relayed by the server.
+ *
+ * Architecture:
+ * - Everything runs on the server's network thread; no locking
+ * - Per-connection token buckets cap how fast anyone can chat; over-budget
+ *   messages are dropped, never queued, so a flood costs nothing downstream
+ * - Lines accepted during a tick are coalesced into one CHAT_MESSAGE per room,
+ *   which the caller sends on the chat lane (lower priority than game traffic)
+ * - History is a fixed-size ring per room and the room set is fixed, so memory
+ *   stays bounded however busy the server gets
+ ******************************************************************************/
+
+#include "Chat.h"
+#include <algorithm>
+
+namespace {
+
+const char* const ROOMS[] = {"lobby", "game"};
+
+/**
+ * Length of the longest valid UTF-8 prefix of text that fits in maxBytes, cut at a
+ * character boundary; std::string::npos if text is not valid UTF-8 at all (overlong
+ * forms, surrogates and code points past U+10FFFF included).
+ */
+size_t utf8Prefix(const std::string& text, size_t maxBytes) {
+    size_t fits = 0;
+    size_t i = 0;
+    while (i < text.size()) {
+        auto byte = static_cast<unsigned char>(text[i]);
+        size_t length;
+        uint32_t codePoint;
+        if (byte < 0x80) {
+            length = 1;
+            codePoint = byte;
+        } else if ((byte & 0xE0) == 0xC0) {
+            length = 2;
+            codePoint = byte & 0x1F;
+        } else if ((byte & 0xF0) == 0xE0) {
+            length = 3;
+            codePoint = byte & 0x0F;
+        } else if ((byte & 0xF8) == 0xF0) {
+            length = 4;
+            codePoint = byte & 0x07;
+        } else {
+            return std::string::npos;
+        }
+        if (i + length > text.size()) {
+            return std::string::npos;
+        }
+        for (size_t k = 1; k < length; k++) {
+            auto continuation = static_cast<unsigned char>(text[i + k]);
+            if ((continuation & 0xC0) != 0x80) {
+                return std::string::npos;
+            }
+            codePoint = (codePoint << 6) | (continuation & 0x3F);
+        }
+        constexpr uint32_t MIN_CODE_POINT[5] = {0, 0, 0x80, 0x800, 0x10000};
+        if (codePoint < MIN_CODE_POINT[length] || codePoint > 0x10FFFF ||
+            (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            return std::string::npos;
+        }
+
+        i += length;
+        if (i <= maxBytes) {
+            fits = i;
+        }
+    }
+    return fits;
+}
+
+} // namespace
+
+/*-----------------------------------------------------------------------------
+ *                          History Ring
+ *---------------------------------------------------------------------------*/
+
+ChatHistory::ChatHistory(size_t capacity)
+    : ring(capacity) {
+}
+
+void ChatHistory::push(const ChatLine& line) {
+    ring[next] = line;
+    next = (next + 1) % ring.size();
+    count = std::min(count + 1, ring.size());
+}
+
+std::vector<ChatLine> ChatHistory::lines() const {
+    std::vector<ChatLine> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        result.push_back(ring[(next + ring.size() - count + i) % ring.size()]);
+    }
+    return result;
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Relay
+ *---------------------------------------------------------------------------*/
+
+bool ChatRelay::isValidRoom(const std::string& room) {
+    return std::find(std::begin(ROOMS), std::end(ROOMS), room) != std::end(ROOMS);
+}
+
+/**
+ * Accepts a chat line for the next flush if the sender is within its rate budget.
+ *
+ * @param sender Connection handle (or any stable id, e.g. 0 for the host)
+ * @param from Display name chosen by the server (clients cannot set their own)
+ * @param room "lobby" or "game"
+ * @param text Message text (UTF-8); truncated to MAX_TEXT_LENGTH bytes at a character boundary
+ * @param now Current time
+ * @return false if the line was dropped (empty, not UTF-8, unknown room or rate limited)
+ */
+bool ChatRelay::submit(uint32_t sender, const std::string& from, const std::string& room,
+                       const std::string& text, std::chrono::steady_clock::time_point now) {
+    size_t length = utf8Prefix(text, MAX_TEXT_LENGTH);
+    if (text.empty() || length == std::string::npos || !isValidRoom(room) || !consume(sender, now)) {
+        dropped++;
+        return false;
+    }
+
+    ChatLine line;
+    line.id = nextId++;
+    line.room = room;
+    line.from = from;
+    line.text = text.substr(0, length);
+    pending[room].push_back(line);
+    accepted++;
+    return true;
+}
+
+/**
+ * Moves the lines accepted since the last flush into the room histories and returns
+ * one coalesced packet per room that has new lines.
+ */
+std::vector<NetworkPacket> ChatRelay::flush(std::chrono::steady_clock::time_point now) {
+    std::vector<NetworkPacket> packets;
+    for (auto& [room, lines] : pending) {
+        if (lines.empty()) {
+            continue;
+        }
+        auto history = histories.try_emplace(room, HISTORY_PER_ROOM).first;
+        for (const auto& line : lines) {
+            history->second.push(line);
+        }
+        packets.push_back(makePacket(room, lines));
+        lines.clear();
+    }
+
+    // Idle senders' buckets are full again; dropping them keeps the map to active senders
+    for (auto it = buckets.begin(); it != buckets.end();) {
+        it = it->second.isFull(now) ? buckets.erase(it) : std::next(it);
+    }
+    return packets;
+}
+
+/**
+ * Builds the history of a room for a late joiner. Each request costs the sender a
+ * token like a message does, since the answer is up to HISTORY_PER_ROOM lines.
+ */
+bool ChatRelay::history(uint32_t sender, const std::string& room, std::chrono::steady_clock::time_point now,
+                        NetworkPacket& packet) {
+    if (!isValidRoom(room) || !consume(sender, now)) {
+        dropped++;
+        return false;
+    }
+    auto it = histories.find(room);
+    packet = makePacket(room, it != histories.end() ? it->second.lines() : std::vector<ChatLine>());
+    return true;
+}
+
+bool ChatRelay::consume(uint32_t sender, std::chrono::steady_clock::time_point now) {
+    auto bucket = buckets.try_emplace(sender, MESSAGES_PER_SECOND, BURST).first;
+    return bucket->second.consume(now);
+}
+
+NetworkPacket ChatRelay::makePacket(const std::string& room, const std::vector<ChatLine>& lines) {
+    NetworkPacket packet;
+    packet.type = PacketType::CHAT_MESSAGE;
+    packet.data["room"] = room;
+
+    json entries = json::array();
+    for (const auto& line : lines) {
+        entries.push_back({{"id", line.id}, {"from", line.from}, {"text", line.text}});
+    }
+    packet.data["lines"] = entries;
+    return packet;
+}
+
+std::vector<ChatLine> ChatRelay::parse(const NetworkPacket& packet) {
+    std::vector<ChatLine> lines;
+    if (!packet.data.contains("lines") || !packet.data["lines"].is_array()) {
+        return lines;
+    }
+
+    std::string room = packet.data.value("room", std::string());
+    for (const auto& entry : packet.data["lines"]) {
+        ChatLine line;
+        line.id = entry.value("id", uint64_t{0});
+        line.room = room;
+        line.from = entry.value("from", std::string());
+        line.text = entry.value("text", std::string());
+        lines.push_back(line);
+    }
+    return lines;
+}
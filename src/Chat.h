@@ -0,0 +1,73 @@
+#pragma once
+
+#include "NetworkManager.h"
+#include "TokenBucket.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ChatLine {
+    uint64_t id = 0;            // Server-assigned, increasing per relay
+    std::string room;
+    std::string from;
+    std::string text;
+};
+
+// Fixed-capacity ring of the most recent lines of one room
+class ChatHistory {
+public:
+    explicit ChatHistory(size_t capacity);
+
+    void push(const ChatLine& line);
+    std::vector<ChatLine> lines() const;    // Oldest first
+
+private:
+    std::vector<ChatLine> ring;
+    size_t next = 0;
+    size_t count = 0;
+};
+
+// Server-side chat relay (network thread only):
+//  - submit() rate-limits each sender with a token bucket and drops anything over budget,
+//    as well as text that is not valid UTF-8 (it could not be serialized as JSON)
+//  - history requests are paid for from the same bucket
+//  - accepted lines are coalesced per room and flushed once per network tick as a single
+//    CHAT_MESSAGE packet per room, to be sent on the low-priority chat lane
+//  - every room keeps a bounded history ring for late joiners
+class ChatRelay {
+public:
+    static constexpr size_t MAX_TEXT_LENGTH = 200;
+    static constexpr size_t HISTORY_PER_ROOM = 50;
+    static constexpr double MESSAGES_PER_SECOND = 1.0;
+    static constexpr double BURST = 5.0;
+
+    // Rooms are fixed, so room names from the wire can never grow the map
+    static bool isValidRoom(const std::string& room);
+
+    bool submit(uint32_t sender, const std::string& from, const std::string& room,
+                const std::string& text, std::chrono::steady_clock::time_point now);
+    std::vector<NetworkPacket> flush(std::chrono::steady_clock::time_point now);
+    // False (nothing to send) for an unknown room or a sender over budget
+    bool history(uint32_t sender, const std::string& room, std::chrono::steady_clock::time_point now,
+                 NetworkPacket& packet);
+
+    // Lines of a CHAT_MESSAGE packet (batch or history)
+    static std::vector<ChatLine> parse(const NetworkPacket& packet);
+
+    uint64_t getAccepted() const { return accepted; }
+    uint64_t getDropped() const { return dropped; }
+
+private:
+    uint64_t nextId = 1;
+    uint64_t accepted = 0;
+    uint64_t dropped = 0;
+    std::unordered_map<uint32_t, TokenBucket> buckets;
+    std::unordered_map<std::string, ChatHistory> histories;
+    std::unordered_map<std::string, std::vector<ChatLine>> pending;
+
+    bool consume(uint32_t sender, std::chrono::steady_clock::time_point now);
+    static NetworkPacket makePacket(const std::string& room, const std::vector<ChatLine>& lines);
+};
@@ -0,0 +1,310 @@
+/*******************************************************************************
+ * CooperativeSearch.cpp
+ *
+ * Anytime, time-sliced alpha-beta for the in-game bot.
+ *
+ * Architecture:
+ * - Iterative deepening negamax with the recursion unrolled into an explicit
+ *   stack of frames, so step(N) can return after any N nodes and resume later
+ * - The logic thread calls step() between draining its command queue, so moves,
+ *   resets and network commands are never delayed by more than one slice
+ * - The best move of the last completed iteration is always available (anytime);
+ *   the search ends when the wall-clock budget is spent or the max depth is done
+ * - cancel() drops all state instantly (e.g. when the position changes)
+ ******************************************************************************/
+
+#include "CooperativeSearch.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+constexpr int MATE_BOUND = SearchEngine::WIN_SCORE - 256;
+
+TileState opponentOf(TileState side) {
+    return side == TileState::X ? TileState::O : TileState::X;
+}
+
+} // namespace
+
+CooperativeSearch::CooperativeSearch(std::shared_ptr<TranspositionTable> table)
+    : table(std::move(table)) {
+    stack.reserve(MAX_MOVES + 1);
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Control
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Starts a new search. Any search in progress is discarded.
+ *
+ * @param board The position to search (copied)
+ * @param toMove The side to move
+ * @param budget Wall-clock budget for the whole search (0 = until maxDepth is done)
+ * @param maxDepth Maximum depth in plies (capped by the number of empty tiles)
+ */
+void CooperativeSearch::start(const Board& board, TileState toMove, std::chrono::milliseconds budget, int maxDepth) {
+    this->board = board;
+    rootSide = toMove;
+    this->budget = budget;
+    startTime = std::chrono::steady_clock::now();
+    nodes = 0;
+    completedDepth = 0;
+    completedMove = -1;
+    completedScore = 0;
+    stack.clear();
+
+    int emptyTiles = 0;
+    for (const auto& row : board.getGrid()) {
+        emptyTiles += static_cast<int>(std::count(row.begin(), row.end(), TileState::EMPTY));
+    }
+    this->maxDepth = std::min(maxDepth, emptyTiles);
+
+    if (this->maxDepth <= 0 || board.checkWinner() != GameResult::IN_PROGRESS) {
+        status = SearchStatus::DONE;
+        return;
+    }
+
+    if (table) {
+        table->newSearch();
+    }
+
+    status = SearchStatus::RUNNING;
+    iterationDepth = 1;
+    startIteration();
+}
+
+/**
+ * Abandons the current search. The partial result is discarded.
+ */
+void CooperativeSearch::cancel() {
+    if (status == SearchStatus::RUNNING) {
+        status = SearchStatus::CANCELLED;
+    }
+    stack.clear();
+}
+
+/**
+ * Returns the best move found so far: the last completed iteration, or the best root
+ * move of the running iteration, or any legal move if nothing was searched yet.
+ */
+SearchResult CooperativeSearch::getResult() const {
+    SearchResult result;
+    int size = board.getSize();
+    int move = completedMove;
+    result.score = completedScore;
+
+    if (move < 0 && !stack.empty()) {
+        move = stack.front().bestMove;
+    }
+    if (move < 0) {
+        for (int cell = 0; cell < size * size && move < 0; cell++) {
+            if (board.getTile(cell % size, cell / size) == TileState::EMPTY) {
+                move = cell;
+            }
+        }
+    }
+
+    if (move >= 0) {
+        result.bestX = move % size;
+        result.bestY = move / size;
+    }
+    result.depth = completedDepth;
+    result.nodes = nodes;
+    result.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
+
+bool CooperativeSearch::overBudget() const {
+    return budget.count() > 0 && std::chrono::steady_clock::now() - startTime >= budget;
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Resumable Search
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Advances the search by at most nodeBudget nodes.
+ *
+ * @param nodeBudget Maximum number of nodes to visit before returning
+ * @return RUNNING if more work remains, DONE when a result is final, CANCELLED/IDLE otherwise
+ */
+SearchStatus CooperativeSearch::step(uint32_t nodeBudget) {
+    if (status != SearchStatus::RUNNING) {
+        return status;
+    }
+
+    int size = board.getSize();
+
+    for (uint32_t processed = 0; processed < nodeBudget; ) {
+        if ((processed & 255) == 0 && overBudget()) {
+            status = SearchStatus::DONE;
+            break;
+        }
+
+        Frame& frame = stack.back();
+
+        // All moves tried (or beta cutoff): return the score to the parent frame
+        if (frame.next >= frame.moveCount || frame.alpha >= frame.beta) {
+            popFrame();
+            if (status != SearchStatus::RUNNING) {
+                break;
+            }
+            continue;
+        }
+
+        int move = frame.moves[frame.next++];
+        int x = move % size;
+        int y = move / size;
+        int ply = static_cast<int>(stack.size());
+        TileState childSide = opponentOf(frame.side);
+
+        board.setTile(x, y, frame.side);
+        nodes++;
+        processed++;
+
+        // Leaves (game over / horizon / table cutoff) are scored in place
+        bool leaf = true;
+        int childScore = 0;
+        GameResult result = board.checkWinner();
+
+        if (result == GameResult::DRAW) {
+            childScore = 0;
+        } else if (result != GameResult::IN_PROGRESS) {
+            childScore = -(SearchEngine::WIN_SCORE - ply);
+        } else if (frame.depth - 1 <= 0) {
+            childScore = SearchEngine::evaluate(board, childSide);
+        } else {
+            TTEntry entry;
+            int childAlpha = -frame.beta;
+            int childBeta = -frame.alpha;
+            bool cutoff = false;
+
+            if (table && table->probe(board.getHash(), entry) && entry.depth >= frame.depth - 1) {
+                int score = entry.score;
+                if (score > MATE_BOUND) {
+                    score -= ply;
+                } else if (score < -MATE_BOUND) {
+                    score += ply;
+                }
+                cutoff = entry.bound == TTBound::EXACT ||
+                         (entry.bound == TTBound::LOWER && score >= childBeta) ||
+                         (entry.bound == TTBound::UPPER && score <= childAlpha);
+                childScore = score;
+            }
+
+            if (!cutoff) {
+                // Note: 'frame' may be invalidated by the push
+                pushFrame(childSide, frame.depth - 1, childAlpha, childBeta);
+                leaf = false;
+            }
+        }
+
+        if (leaf) {
+            board.clearTile(x, y);
+            int score = -childScore;
+            if (score > frame.bestScore) {
+                frame.bestScore = score;
+                frame.bestMove = move;
+            }
+            frame.alpha = std::max(frame.alpha, score);
+        }
+    }
+
+    return status;
+}
+
+/**
+ * Pushes a frame for the current position (the move leading here is already made).
+ */
+void CooperativeSearch::pushFrame(TileState side, int depth, int alpha, int beta) {
+    Frame frame;
+    frame.side = side;
+    frame.depth = depth;
+    frame.alpha = alpha;
+    frame.beta = beta;
+    frame.originalAlpha = alpha;
+    frame.bestScore = -SearchEngine::INFINITE_SCORE;
+
+    int ttMove = -1;
+    TTEntry entry;
+    if (table && table->probe(board.getHash(), entry)) {
+        ttMove = entry.move;
+    }
+
+    int size = board.getSize();
+    for (int cell = 0; cell < size * size && frame.moveCount < MAX_MOVES; cell++) {
+        if (board.getTile(cell % size, cell / size) == TileState::EMPTY) {
+            frame.moves[frame.moveCount++] = cell;
+        }
+    }
+
+    // Table move first
+    auto end = frame.moves.begin() + frame.moveCount;
+    auto it = std::find(frame.moves.begin(), end, ttMove);
+    if (it != end) {
+        std::rotate(frame.moves.begin(), it, it + 1);
+    }
+
+    stack.push_back(frame);
+}
+
+/**
+ * Finishes the top frame: stores it in the table and hands its score to the parent,
+ * or completes the iteration if it was the root.
+ */
+void CooperativeSearch::popFrame() {
+    Frame done = stack.back();
+    stack.pop_back();
+    int ply = static_cast<int>(stack.size());
+
+    if (table) {
+        TTBound bound = done.bestScore <= done.originalAlpha ? TTBound::UPPER
+                      : done.bestScore >= done.beta ? TTBound::LOWER
+                      : TTBound::EXACT;
+        int score = done.bestScore;
+        if (score > MATE_BOUND) {
+            score += ply;
+        } else if (score < -MATE_BOUND) {
+            score -= ply;
+        }
+        table->store(board.getHash(), done.bestMove, score, done.depth, bound);
+    }
+
+    // Root finished: iteration complete
+    if (stack.empty()) {
+        completedDepth = iterationDepth;
+        completedMove = done.bestMove;
+        completedScore = done.bestScore;
+
+        bool mateFound = std::abs(done.bestScore) > MATE_BOUND;
+        if (iterationDepth >= maxDepth || mateFound) {
+            status = SearchStatus::DONE;
+        } else {
+            iterationDepth++;
+            startIteration();
+        }
+        return;
+    }
+
+    Frame& parent = stack.back();
+    int size = board.getSize();
+    int move = parent.moves[parent.next - 1];
+    board.clearTile(move % size, move / size);
+
+    int score = -done.bestScore;
+    if (score > parent.bestScore) {
+        parent.bestScore = score;
+        parent.bestMove = move;
+    }
+    parent.alpha = std::max(parent.alpha, score);
+}
+
+/**
+ * Pushes the root frame for the next iterative deepening iteration.
+ */
+void CooperativeSearch::startIteration() {
+    pushFrame(rootSide, iterationDepth, -SearchEngine::INFINITE_SCORE, SearchEngine::INFINITE_SCORE);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Board.h"
+#include "SearchEngine.h"
+#include "TranspositionTable.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class SearchStatus {
+    IDLE,
+    RUNNING,
+    DONE,
+    CANCELLED
+};
+
+// Anytime alpha-beta written as a resumable state machine: the recursion lives in an
+// explicit stack, so the search can stop after any node and continue on the next
+// step() call. Meant to run inside an existing loop (e.g. the logic thread) without
+// a thread of its own.
+class CooperativeSearch {
+public:
+    explicit CooperativeSearch(std::shared_ptr<TranspositionTable> table = nullptr);
+
+    void start(const Board& board, TileState toMove, std::chrono::milliseconds budget, int maxDepth = 9);
+    SearchStatus step(uint32_t nodeBudget);
+    void cancel();
+
+    SearchStatus getStatus() const { return status; }
+    bool isRunning() const { return status == SearchStatus::RUNNING; }
+    SearchResult getResult() const;
+
+private:
+    static constexpr int MAX_MOVES = 64;
+
+    struct Frame {
+        std::array<int, MAX_MOVES> moves;
+        int moveCount = 0;
+        int next = 0;
+        int alpha = 0;
+        int beta = 0;
+        int originalAlpha = 0;
+        int bestScore = 0;
+        int bestMove = -1;
+        int depth = 0;
+        TileState side = TileState::X;
+    };
+
+    std::shared_ptr<TranspositionTable> table;
+    Board board;
+    TileState rootSide = TileState::X;
+    std::vector<Frame> stack;
+
+    SearchStatus status = SearchStatus::IDLE;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::milliseconds budget{0};
+    int maxDepth = 0;
+    int iterationDepth = 0;
+    uint64_t nodes = 0;
+
+    // Best move of the last completed iteration (anytime result)
+    int completedDepth = 0;
+    int completedMove = -1;
+    int completedScore = 0;
+
+    void pushFrame(TileState side, int depth, int alpha, int beta);
+    void popFrame();
+    void startIteration();
+    bool overBudget() const;
+};
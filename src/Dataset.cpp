@@ -0,0 +1,384 @@
+/*******************************************************************************
+ * Dataset.cpp
+ *
+ * Chunked, compressed, columnar storage for self-play training data.
+ *
+ * Architecture:
+ * - Rows are buffered by the producer and encoded one chunk at a time, so memory
+ *   stays bounded by the chunk size however long generation runs
+ * - Each column is stored separately, as zigzag LEB128 varints of the values or of
+ *   their deltas, or bit-packed in the fewest bits covering its range (chosen per
+ *   column and chunk, whichever is smallest)
+ * - Chunks are self-contained (magic + row count + columns), so a truncated file
+ *   loses at most the chunk being written
+ ******************************************************************************/
+
+#include "Dataset.h"
+#include "PositionCodec.h"
+#include <algorithm>
+
+namespace {
+
+constexpr uint32_t CHUNK_MAGIC = 0x4331414D; // "MA1C" (little-endian)
+constexpr uint8_t ENCODING_VARINT = 1;
+constexpr uint8_t ENCODING_DELTA_VARINT = 2;
+constexpr uint8_t ENCODING_BIT_PACKED = 3;    // zigzag varint minimum, uint8 bit width, packed (value - minimum)
+
+enum Column : uint8_t {
+    COLUMN_POSITION,
+    COLUMN_SIDE_TO_MOVE,
+    COLUMN_SCORE,
+    COLUMN_BEST_MOVE,
+    COLUMN_PLAYED_MOVE,
+    COLUMN_RESULT,
+    COLUMN_PLY,
+    COLUMN_COUNT
+};
+
+int64_t columnValue(const TrainingSample& sample, int column) {
+    switch (column) {
+        case COLUMN_POSITION: return sample.position;
+        case COLUMN_SIDE_TO_MOVE: return sample.sideToMove;
+        case COLUMN_SCORE: return sample.score;
+        case COLUMN_BEST_MOVE: return sample.bestMove;
+        case COLUMN_PLAYED_MOVE: return sample.playedMove;
+        case COLUMN_RESULT: return sample.result;
+        default: return sample.ply;
+    }
+}
+
+// Whether a value read from a file is one its column can hold: readers index with these
+bool columnValueFits(int column, int64_t value) {
+    switch (column) {
+        case COLUMN_POSITION: return value >= 0 && value <= UINT32_MAX;
+        case COLUMN_SIDE_TO_MOVE: return value == static_cast<int>(TileState::X) || value == static_cast<int>(TileState::O);
+        case COLUMN_SCORE: return value >= INT16_MIN && value <= INT16_MAX;
+        case COLUMN_BEST_MOVE:
+        case COLUMN_PLAYED_MOVE: return value >= 0 && value < PositionCodec::INDEX_MAX_CELLS;
+        case COLUMN_RESULT: return value >= -1 && value <= 1;
+        default: return value >= 0 && value <= PositionCodec::INDEX_MAX_CELLS;
+    }
+}
+
+void setColumnValue(TrainingSample& sample, int column, int64_t value) {
+    switch (column) {
+        case COLUMN_POSITION: sample.position = static_cast<uint32_t>(value); break;
+        case COLUMN_SIDE_TO_MOVE: sample.sideToMove = static_cast<uint8_t>(value); break;
+        case COLUMN_SCORE: sample.score = static_cast<int16_t>(value); break;
+        case COLUMN_BEST_MOVE: sample.bestMove = static_cast<uint8_t>(value); break;
+        case COLUMN_PLAYED_MOVE: sample.playedMove = static_cast<uint8_t>(value); break;
+        case COLUMN_RESULT: sample.result = static_cast<int8_t>(value); break;
+        default: sample.ply = static_cast<uint8_t>(value); break;
+    }
+}
+
+void putUint32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+uint32_t getUint32(const uint8_t* data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; data < end && shift < 64; shift += 7) {
+        uint8_t byte = *data++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/**
+ * Frame-of-reference bit packing: every value is stored as (value - minimum) in the
+ * fewest bits that cover the column's range (e.g. 1 bit for the side to move).
+ */
+void putBitPacked(std::vector<uint8_t>& out, const std::vector<int64_t>& values) {
+    int64_t minimum = values.empty() ? 0 : *std::min_element(values.begin(), values.end());
+    int64_t maximum = values.empty() ? 0 : *std::max_element(values.begin(), values.end());
+    uint64_t range = static_cast<uint64_t>(maximum - minimum);
+    uint8_t bits = 0;
+    while (bits < 64 && (range >> bits) != 0) {
+        bits++;
+    }
+
+    putVarint(out, zigzag(minimum));
+    out.push_back(bits);
+
+    uint64_t buffer = 0;
+    int buffered = 0;
+    for (int64_t value : values) {
+        uint64_t offset = static_cast<uint64_t>(value - minimum);
+        for (int bit = 0; bit < bits; bit++) {
+            buffer |= ((offset >> bit) & 1) << buffered;
+            if (++buffered == 8) {
+                out.push_back(static_cast<uint8_t>(buffer));
+                buffer = 0;
+                buffered = 0;
+            }
+        }
+    }
+    if (buffered > 0) {
+        out.push_back(static_cast<uint8_t>(buffer));
+    }
+}
+
+// Whether a bit-packed column holds rowCount values (a zero-width column holds any number)
+bool fitsBitPacked(const std::vector<uint8_t>& bytes, uint32_t rowCount) {
+    const uint8_t* data = bytes.data();
+    const uint8_t* end = data + bytes.size();
+    uint64_t encodedMinimum;
+    if (!getVarint(data, end, encodedMinimum) || data >= end) {
+        return false;
+    }
+    uint8_t bits = *data++;
+    return bits <= 64 && static_cast<uint64_t>(end - data) * 8 >= static_cast<uint64_t>(bits) * rowCount;
+}
+
+bool getBitPacked(const uint8_t* data, const uint8_t* end, std::vector<int64_t>& values) {
+    uint64_t encodedMinimum;
+    if (!getVarint(data, end, encodedMinimum) || data >= end) {
+        return false;
+    }
+    int64_t minimum = unzigzag(encodedMinimum);
+    uint8_t bits = *data++;
+    if (bits > 64 || static_cast<uint64_t>(end - data) * 8 < static_cast<uint64_t>(bits) * values.size()) {
+        return false;
+    }
+
+    uint64_t position = 0;
+    for (int64_t& value : values) {
+        uint64_t offset = 0;
+        for (int bit = 0; bit < bits; bit++, position++) {
+            offset |= static_cast<uint64_t>((data[position >> 3] >> (position & 7)) & 1) << bit;
+        }
+        value = minimum + static_cast<int64_t>(offset);
+    }
+    return true;
+}
+
+} // namespace
+
+/*-----------------------------------------------------------------------------
+ *                          Writer
+ *---------------------------------------------------------------------------*/
+
+DatasetWriter::~DatasetWriter() {
+    close();
+}
+
+bool DatasetWriter::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    rowsWritten = 0;
+    bytesWritten = 0;
+    return file != nullptr;
+}
+
+void DatasetWriter::close() {
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+/**
+ * Encodes samples into one chunk. Each column is stored with whichever encoding is
+ * smallest: zigzag varints of the values, of their deltas, or bit-packed offsets.
+ *
+ * @param samples The rows of the chunk
+ * @return The encoded chunk, ready for writeChunk
+ */
+std::vector<uint8_t> DatasetWriter::encodeChunk(const std::vector<TrainingSample>& samples) {
+    std::vector<uint8_t> out;
+    out.reserve(16 + samples.size() * COLUMN_COUNT);
+    putUint32(out, CHUNK_MAGIC);
+    putUint32(out, static_cast<uint32_t>(samples.size()));
+    putUint32(out, COLUMN_COUNT);
+
+    std::vector<int64_t> values(samples.size());
+    std::vector<uint8_t> candidates[3];
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        for (size_t i = 0; i < samples.size(); i++) {
+            values[i] = columnValue(samples[i], c);
+        }
+
+        for (auto& candidate : candidates) {
+            candidate.clear();
+        }
+        int64_t previous = 0;
+        for (int64_t value : values) {
+            putVarint(candidates[0], zigzag(value));
+            putVarint(candidates[1], zigzag(value - previous));
+            previous = value;
+        }
+        putBitPacked(candidates[2], values);
+
+        // Keep whichever encoding is smallest for this column
+        int best = 0;
+        for (int e = 1; e < 3; e++) {
+            if (candidates[e].size() < candidates[best].size()) {
+                best = e;
+            }
+        }
+        const uint8_t encodings[3] = {ENCODING_VARINT, ENCODING_DELTA_VARINT, ENCODING_BIT_PACKED};
+        out.push_back(static_cast<uint8_t>(c));
+        out.push_back(encodings[best]);
+        putUint32(out, static_cast<uint32_t>(candidates[best].size()));
+        out.insert(out.end(), candidates[best].begin(), candidates[best].end());
+    }
+    return out;
+}
+
+/**
+ * Appends an encoded chunk to the file and flushes it.
+ */
+bool DatasetWriter::writeChunk(const std::vector<uint8_t>& encoded, size_t rowCount) {
+    if (!file || rowCount > MAX_CHUNK_ROWS) {
+        return false;
+    }
+    if (std::fwrite(encoded.data(), 1, encoded.size(), file) != encoded.size()) {
+        return false;
+    }
+    std::fflush(file);
+    rowsWritten += rowCount;
+    bytesWritten += encoded.size();
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Reader
+ *---------------------------------------------------------------------------*/
+
+DatasetReader::~DatasetReader() {
+    close();
+}
+
+bool DatasetReader::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    fileSize = size > 0 ? static_cast<uint64_t>(size) : 0;
+    return true;
+}
+
+uint64_t DatasetReader::remainingBytes() const {
+    long position = std::ftell(file);
+    return position >= 0 && static_cast<uint64_t>(position) < fileSize ? fileSize - position : 0;
+}
+
+void DatasetReader::close() {
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+/**
+ * Reads the next chunk. The columns are read before any row is allocated, and the
+ * header's row count must fit in them (a varint takes at least a byte, a packed value
+ * its bit width), so a corrupt count cannot make the reader allocate arbitrary memory.
+ * A value outside what its column can hold (a result other than -1/0/1, a move past the
+ * last cell...) rejects the chunk too, so callers can index with the fields.
+ */
+bool DatasetReader::readChunk(std::vector<TrainingSample>& samples) {
+    uint8_t header[12];
+    if (!file || std::fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        getUint32(header) != CHUNK_MAGIC) {
+        return false;
+    }
+
+    uint32_t rowCount = getUint32(header + 4);
+    uint32_t columnCount = getUint32(header + 8);
+    if (rowCount > MAX_CHUNK_ROWS) {
+        return false;
+    }
+
+    struct ColumnData {
+        uint8_t id;
+        uint8_t encoding;
+        std::vector<uint8_t> bytes;
+    };
+    std::vector<ColumnData> columns;
+    for (uint32_t c = 0; c < columnCount; c++) {
+        uint8_t columnHeader[6];
+        if (std::fread(columnHeader, 1, sizeof(columnHeader), file) != sizeof(columnHeader)) {
+            return false;
+        }
+        uint32_t byteCount = getUint32(columnHeader + 2);
+        if (byteCount > remainingBytes()) {
+            return false;
+        }
+        std::vector<uint8_t> bytes(byteCount);
+        if (std::fread(bytes.data(), 1, bytes.size(), file) != bytes.size()) {
+            return false;
+        }
+
+        // Unknown columns or encodings are skipped
+        uint8_t encoding = columnHeader[1];
+        if (columnHeader[0] >= COLUMN_COUNT || encoding < ENCODING_VARINT || encoding > ENCODING_BIT_PACKED) {
+            continue;
+        }
+        if (encoding == ENCODING_BIT_PACKED ? !fitsBitPacked(bytes, rowCount) : bytes.size() < rowCount) {
+            return false;
+        }
+        columns.push_back({columnHeader[0], encoding, std::move(bytes)});
+    }
+
+    samples.assign(rowCount, TrainingSample());
+    std::vector<int64_t> values(rowCount);
+    for (const ColumnData& column : columns) {
+        uint8_t encoding = column.encoding;
+        const uint8_t* data = column.bytes.data();
+        const uint8_t* end = data + column.bytes.size();
+        if (encoding == ENCODING_BIT_PACKED) {
+            if (!getBitPacked(data, end, values)) {
+                return false;
+            }
+        } else {
+            int64_t previous = 0;
+            for (int64_t& value : values) {
+                uint64_t encoded;
+                if (!getVarint(data, end, encoded)) {
+                    return false;
+                }
+                value = unzigzag(encoded) + (encoding == ENCODING_DELTA_VARINT ? previous : 0);
+                previous = value;
+            }
+        }
+
+        for (uint32_t row = 0; row < rowCount; row++) {
+            if (!columnValueFits(column.id, values[row])) {
+                return false;
+            }
+            setColumnValue(samples[row], column.id, values[row]);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// One training position: the search's view of a position reached in self-play
+struct TrainingSample {
+    uint32_t position = 0;      // Base-3 index (PositionCodec::encode)
+    uint8_t sideToMove = 1;     // TileState value (X = 1, O = 2)
+    int16_t score = 0;          // Search score for the side to move
+    uint8_t bestMove = 0;       // Search's best move (cell y * size + x)
+    uint8_t playedMove = 0;     // Move actually played (may be an exploration move)
+    int8_t result = 0;          // Final game result for the side to move: 1 / 0 / -1
+    uint8_t ply = 0;
+};
+
+// Columnar training dataset, written as a stream of self-contained chunks:
+//
+//   Chunk:  uint32 magic "MA1C", uint32 rowCount (<= MAX_CHUNK_ROWS), uint32 columnCount,
+//           columnCount x { uint8 column, uint8 encoding, uint32 byteCount, bytes }
+//
+// Every column of a chunk is encoded on its own (varints, delta varints or bit packing),
+// so the writer only ever holds one chunk and readers can skip columns they do not need.
+constexpr uint32_t MAX_CHUNK_ROWS = 1u << 20;     // Readers reject larger chunks
+
+class DatasetWriter {
+public:
+    DatasetWriter() = default;
+    ~DatasetWriter();
+
+    DatasetWriter(const DatasetWriter&) = delete;
+    DatasetWriter& operator=(const DatasetWriter&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // Encodes a chunk (thread-safe to call concurrently with encodeChunk, not with writeChunk)
+    static std::vector<uint8_t> encodeChunk(const std::vector<TrainingSample>& samples);
+    bool writeChunk(const std::vector<uint8_t>& encoded, size_t rowCount);
+
+    uint64_t getRowsWritten() const { return rowsWritten; }
+    uint64_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    FILE* file = nullptr;
+    uint64_t rowsWritten = 0;
+    uint64_t bytesWritten = 0;
+};
+
+class DatasetReader {
+public:
+    DatasetReader() = default;
+    ~DatasetReader();
+
+    DatasetReader(const DatasetReader&) = delete;
+    DatasetReader& operator=(const DatasetReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // Reads the next chunk; returns false at the end of the file or on a corrupt chunk
+    bool readChunk(std::vector<TrainingSample>& samples);
+
+private:
+    FILE* file = nullptr;
+    uint64_t fileSize = 0;
+
+    uint64_t remainingBytes() const;
+};
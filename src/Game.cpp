@@ -12,9 +12,11 @@
 ******************************************************************************/
 
 #include "Game.h"
+#include "PositionCodec.h"
 #include <iostream>
 #include <imgui_impl_sdl3.h>
 #include <imgui_impl_sdlrenderer3.h>
+#include <cstdlib>
 #include <ctime>
 
 /*-----------------------------------------------------------------------------
@@ -90,6 +92,24 @@ SDL_AppResult Game::AppIterate(void* appstate) {
         return SDL_APP_CONTINUE;
     }
 
+    // The network thread gave up on the server; threads are joined here, never from themselves
+    if (game->returnToMenu.exchange(false) && game->gameState == GameState::IN_GAME) {
+        game->stopGame();
+    }
+
+    // The room moved to another server process: the host follows it there as a client
+    uint16_t movedTo = game->migratedPort.exchange(0);
+    if (movedTo != 0 && game->gameState == GameState::IN_GAME) {
+        game->stopGame();
+        game->resumeToken = game->migrationToken;
+        game->resumeServer = "127.0.0.1:" + std::to_string(movedTo);
+        if (game->startGame(false, "127.0.0.1", movedTo)) {
+            game->addMessage("Room moved to port " + std::to_string(movedTo), MessageType::SUCCESS);
+        } else {
+            std::cerr << "[GAME] Failed to follow the room to port " << movedTo << std::endl;
+        }
+    }
+
     // Process menu choices
     if (game->gameState == GameState::MAIN_MENU && game->mainMenu) {
         MenuChoice choice = game->mainMenu->getChoice();
@@ -105,6 +125,11 @@ SDL_AppResult Game::AppIterate(void* appstate) {
                                  game->mainMenu->getServerPort())) {
                 std::cerr << "[MAIN MENU] Failed to join server." << std::endl;
             }
+        } else if (choice == MenuChoice::PLAY_BOT) {
+            game->mainMenu->resetChoice();
+            if (!game->startGame(true, "", 0, true)) {
+                std::cerr << "[MAIN MENU] Failed to start bot game." << std::endl;
+            }
         } else if (choice == MenuChoice::QUIT) {
             return SDL_APP_SUCCESS;
         }
@@ -115,10 +140,40 @@ SDL_AppResult Game::AppIterate(void* appstate) {
         GameStateSnapshot newState;
 
         // Read latest state from queue
+        bool stateChanged = false;
         while (game->gameStateQueue.try_dequeue(newState)) {
             game->currentRenderState = newState;
+            stateChanged = true;
+        }
+        // The logic thread keeps changing its board; the render thread draws its own copy
+        if (stateChanged && game->renderBoard) {
+            PositionCodec::decode(game->currentRenderState.position, *game->renderBoard);
+        }
+
+        // Re-analyze for the hint overlay (cancels the analysis of the previous state)
+        if (stateChanged && game->showHints && game->hintAnalyzer) {
+            game->hintAnalyzer->submit(newState.position, newState.currentPlayer);
         }
 
+        // Chat lines relayed by the network thread
+        ChatLine line;
+        while (game->incomingChat.try_dequeue(line)) {
+            game->chatLog.push_back(line);
+            if (game->chatLog.size() > CHAT_LOG_LINES) {
+                game->chatLog.pop_front();
+            }
+        }
+
+        // Presence: keep the newest member list, and publish our own status
+        std::vector<PresenceMember> members;
+        while (game->presenceUpdates.try_dequeue(members)) {
+            game->presenceMembers = std::move(members);
+        }
+        bool focused = (SDL_GetWindowFlags(game->window) & SDL_WINDOW_INPUT_FOCUS) != 0;
+        game->localStatus = !focused ? PresenceStatus::AWAY
+                          : game->currentRenderState.result == GameResult::IN_PROGRESS ? PresenceStatus::PLAYING
+                          : PresenceStatus::ONLINE;
+
         game->updateMessages();
     }
 
@@ -284,29 +339,62 @@ bool Game::initialize() {
  * @param asServer true to start as server, false to start as client
  * @param serverAddr the server address to connect to (ignored if asServer is true)
  * @param port the port number for server or client connection
+ * @param againstBot true for a local game against the bot (no networking, player is X)
  * @return true if the game started successfully, false otherwise
  */
-bool Game::startGame(bool asServer, const std::string &serverAddr, uint16_t port) {
-    std::cout << "[GAME] Starting game as " << (asServer ? "SERVER" : "CLIENT") << std::endl;
+bool Game::startGame(bool asServer, const std::string &serverAddr, uint16_t port, bool againstBot) {
+    std::cout << "[GAME] Starting game as " << (againstBot ? "LOCAL vs BOT" : asServer ? "SERVER" : "CLIENT") << std::endl;
 
     // Set game mode and network parameters
-    isServer = asServer;
+    isServer = asServer || againstBot;
     serverAddress = serverAddr;
     this->port = port;
-    myMark = isServer ? TileState::X : TileState::O;
+    // A client watches until the server's handshake tells it its seat
+    myMark = isServer ? TileState::X : TileState::EMPTY;
+    vsBot = againstBot;
+    botMark = TileState::O;
+    botMovePending = false;
+    botSearch = vsBot ? std::make_unique<CooperativeSearch>(std::make_shared<TranspositionTable>(4)) : nullptr;
+    moveSequence = 0;
+    resetSequence = 0;
+    moveLog.clear();
+    confirmedBoard.resetBoard();
+    confirmedPlayer = TileState::X;
+    confirmedResult = GameResult::IN_PROGRESS;
+    pendingMoves.clear();
+    hintAnalyzer = std::make_unique<HintAnalyzer>();
+    chatRelay = (isServer && !vsBot) ? std::make_unique<ChatRelay>() : nullptr;
+    chatLog.clear();
+    presenceService = (isServer && !vsBot) ? std::make_unique<PresenceService>() : nullptr;
+    if (presenceService) {
+        presenceService->join(k_HSteamNetConnection_Invalid, "Host", PresenceStatus::PLAYING);
+    }
+    presenceView.clear();
+    presenceMembers.clear();
+    std::vector<PresenceMember> staleMembers;
+    while (presenceUpdates.try_dequeue(staleMembers)) {}
+    nextPresenceTick = std::chrono::steady_clock::now();
+    showHints = false;
+    roomFrozen = false;
+    migratedPort = 0;
+    std::pair<uint16_t, RoomCheckpoint> staleRoom;
+    while (outgoingRooms.try_dequeue(staleRoom)) {}
 
     // Reset connection state
     connectionState.isConnected = false;
     connectionState.isReconnecting = false;
     connectionState.reconnectAttempts = 0;
     clientDisconnected = false;
+    returnToMenu = false;
+    NetworkTimeouts timeouts = NetworkTimeouts::fromEnvironment();
 
-    // Create board
+    // Create boards: the logic thread plays on one, the render thread draws the other
     board = std::make_unique<Board>();
-    board->setGridThickness(6);
-    board->setGridColor({30, 30, 30, 255});
-    board->setBackgroundColor({245, 245, 220, 255});
-    board->setBackgroundPadding(15);
+    renderBoard = std::make_unique<Board>();
+    renderBoard->setGridThickness(6);
+    renderBoard->setGridColor({30, 30, 30, 255});
+    renderBoard->setBackgroundColor({245, 245, 220, 255});
+    renderBoard->setBackgroundPadding(15);
 
     // Initialize render state
     currentRenderState.currentPlayer = TileState::X;
@@ -314,17 +402,27 @@ bool Game::startGame(bool asServer, const std::string &serverAddr, uint16_t port
     currentRenderState.isMyTurn = isServer;  // Server goes first
 
     // Start network
-    if (isServer) {
-        gameServer = std::make_unique<GameServer>(port);
+    if (vsBot) {
+        connectionState.isConnected = true;
+        addMessage("Local game against the bot. You play X.", MessageType::SUCCESS);
+    } else if (isServer) {
+        gameServer = std::make_unique<GameServer>(port, timeouts);
         if (!gameServer->startServer(port)) {
             std::cerr << "[GAME] Failed to start server!" << std::endl;
             addMessage("Failed to start server!", MessageType::ERROR);
             return false;
         }
+        // The host plays X; the first player to join gets O, later ones watch
+        gameServer->setOpenSeats({static_cast<int>(TileState::O)});
         connectionState.isConnected = true;
         addMessage("Server started successfully!", MessageType::SUCCESS);
+        // Until someone joins, another server on this machine may hand its room over to this one
+        migrationListener = MigrationListener::create(port);
     } else {
-        gameClient = std::make_unique<GameClient>();
+        gameClient = std::make_unique<GameClient>(timeouts);
+        if (resumeServer == serverAddress + ":" + std::to_string(port)) {
+            gameClient->setResumeToken(resumeToken);
+        }
         if (!gameClient->connectToServer(serverAddress, port)) {
             std::cerr << "[GAME] Failed to connect to server!" << std::endl;
             addMessage("Failed to connect to server!", MessageType::ERROR);
@@ -369,15 +467,25 @@ void Game::stopGame() {
     }
 
     // Clean up network
+    migrationListener.reset();
+    outgoingTransfer.reset();
+    migrationFlushPort = 0;
     if (gameServer) {
         gameServer.reset();
     }
     if (gameClient) {
+        resumeToken = gameClient->getResumeToken();
+        // The address as entered, so rejoining through a router presents the token too
+        resumeServer = serverAddress + ":" + std::to_string(port);
         gameClient.reset();
     }
-    if (board) {
-        board.reset();
-    }
+    board.reset();
+    renderBoard.reset();
+    botSearch.reset();
+    vsBot = false;
+    hintAnalyzer.reset();
+    showHints = false;
+    presenceService.reset();
 
     // Clear messages
     activeMessages.clear();
@@ -520,34 +628,58 @@ void Game::renderMessages() {
 
 /**
  * Handles disconnection events by updating connection state and providing user feedback.
- *  - If running as server, marks client as disconnected and shows a warning message
- *  - If running as client, initiates reconnection attempts and shows error messages
- *  - Implements an auto-disconnect after a timeout if reconnection fails to prevent hanging
+ *  - If running as server, marks client as disconnected; its seat stays held for the resume window
+ *  - If running as client, starts reconnecting (see updateReconnect)
  */
 void Game::handleDisconnection() {
     if (isServer) {
         // Server detected client disconnect
         clientDisconnected = true;
-        addMessage("Client disconnected. Waiting for reconnection...", MessageType::WARNING);
+        addMessage("Client disconnected. Holding the seat for " +
+                   std::to_string(AdmissionControl::RESUME_WINDOW_MS / 1000) + " s...", MessageType::WARNING);
     } else {
         // Client detected server disconnect
         if (!connectionState.isReconnecting) {
             connectionState.isConnected = false;
             connectionState.isReconnecting = true;
-            addMessage("Lost connection to server...", MessageType::ERROR);
+            connectionState.reconnectAttempts = 0;
+            connectionState.lastReconnectAttempt = std::chrono::steady_clock::now();
+            if (gameClient && gameClient->wasRedirected()) {
+                addMessage("Following the room to another server...", MessageType::INFO);
+            } else {
+                addMessage("Lost connection to server...", MessageType::ERROR);
+            }
+        }
+    }
+}
 
-            // Auto-disconnect after timeout
-            std::thread([this]() {
-                std::this_thread::sleep_for(std::chrono::seconds(10));
+/**
+ * Client: starts the next reconnection attempt once the previous one has failed and the
+ * delay has passed. The resume token of the lost session goes with every attempt, so the
+ * seat is reclaimed. Gives up after maxReconnectAttempts and returns to the menu.
+ */
+void Game::updateReconnect() {
+    if (!connectionState.isReconnecting || !gameClient || gameClient->isConnecting() || gameClient->isConnected()) {
+        return;
+    }
 
-                if (!connectionState.isConnected && running) {
-                    addMessage("Could not reconnect. Returning to menu...", MessageType::ERROR);
-                    std::this_thread::sleep_for(std::chrono::seconds(2));
-                    stopGame();
-                }
-            }).detach();
-        }
+    auto now = std::chrono::steady_clock::now();
+    if (now - connectionState.lastReconnectAttempt < connectionState.reconnectDelay) {
+        return;
     }
+
+    if (connectionState.reconnectAttempts >= connectionState.maxReconnectAttempts) {
+        connectionState.isReconnecting = false;
+        addMessage("Could not reconnect. Returning to menu...", MessageType::ERROR);
+        returnToMenu = true;
+        return;
+    }
+
+    connectionState.reconnectAttempts++;
+    connectionState.lastReconnectAttempt = now;
+    printf("[NETWORK] Reconnect attempt %d/%d\n", connectionState.reconnectAttempts,
+           connectionState.maxReconnectAttempts);
+    gameClient->reconnect();
 }
 
 /*-----------------------------------------------------------------------------
@@ -596,7 +728,11 @@ void Game::handleMouseClick(int mouseX, int mouseY) {
     }
 
     // Convert screen coordinates to grid position
-    auto pos = board->screenToGrid(mouseX, mouseY, CELL_SIZE, GRID_OFFSET_X, GRID_OFFSET_Y);
+    if (!renderBoard) {
+        std::cerr << "[RENDER] Board is null!" << std::endl;
+        return;
+    }
+    auto pos = renderBoard->screenToGrid(mouseX, mouseY, CELL_SIZE, GRID_OFFSET_X, GRID_OFFSET_Y);
 
     printf("[RENDER] Grid pos: (%d, %d) valid=%d\n", pos.x, pos.y, pos.valid);
 
@@ -607,12 +743,7 @@ void Game::handleMouseClick(int mouseX, int mouseY) {
     }
 
     // Check if cell is empty
-    if (!board) {
-        std::cerr << "[RENDER] Board is null!" << std::endl;
-        return;
-    }
-
-    TileState cellState = board->getTile(pos.x, pos.y);
+    TileState cellState = renderBoard->getTile(pos.x, pos.y);
     printf("[RENDER] Cell (%d, %d) state: %d\n", pos.x, pos.y, static_cast<int>(cellState));
 
     if (cellState != TileState::EMPTY) {
@@ -643,6 +774,26 @@ void Game::handleKeyPress(SDL_Keycode key) {
         Command cmd;
         cmd.type = CommandType::RESET_GAME;
         commandInputQueue.enqueue(cmd);
+    } else if (key == SDLK_H) {
+        setShowHints(!showHints);
+    }
+}
+
+/**
+ * Toggles the hint overlay. Enabling it starts an analysis of the current state.
+ *
+ * @param enabled true to show the per-cell evaluation heatmap
+ */
+void Game::setShowHints(bool enabled) {
+    showHints = enabled;
+    if (!hintAnalyzer) {
+        return;
+    }
+
+    if (showHints) {
+        hintAnalyzer->submit(currentRenderState.position, currentRenderState.currentPlayer);
+    } else {
+        hintAnalyzer->clear();
     }
 }
 
@@ -702,8 +853,12 @@ void Game::renderMenu() {
  */
 void Game::renderGame() {
     // Draw game board
-    if (board) {
-        board->render(renderer, CELL_SIZE, GRID_OFFSET_X, GRID_OFFSET_Y);
+    if (renderBoard) {
+        renderBoard->render(renderer, CELL_SIZE, GRID_OFFSET_X, GRID_OFFSET_Y);
+
+        if (showHints && hintAnalyzer && currentRenderState.result == GameResult::IN_PROGRESS) {
+            renderBoard->renderHints(renderer, hintAnalyzer->getHints(), CELL_SIZE, GRID_OFFSET_X, GRID_OFFSET_Y);
+        }
     }
 
     // Draw UI overlay
@@ -741,7 +896,7 @@ void Game::renderImGui() {
             ImGui::PopStyleColor();
         } else {
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.8f, 0.8f, 0.8f, 1.0f));
-            ImGui::TextWrapped("Opponent's turn...");
+            ImGui::TextWrapped("%s", myMark == TileState::EMPTY ? "Spectating" : "Opponent's turn...");
             ImGui::PopStyleColor();
         }
     }
@@ -753,12 +908,16 @@ void Game::renderImGui() {
     ImGui::SameLine();
 
     std::string netStatus;
-    if (isServer) {
-        int clientCount = gameServer ? gameServer->getClientCount() : 0;
+    if (vsBot) {
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.2f, 0.8f, 0.2f, 1.0f));
+        ImGui::Text("Local (vs Bot)");
+        ImGui::PopStyleColor();
+    } else if (isServer) {
+        int clientCount = presenceMembers.empty() ? 0 : static_cast<int>(presenceMembers.size()) - 1;
 
         if (clientDisconnected) {
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.9f, 0.7f, 0.2f, 1.0f));
-            ImGui::Text("Client disconnected");
+            ImGui::Text("Client disconnected (seat held)");
             ImGui::PopStyleColor();
         } else if (clientCount == 0) {
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.7f, 0.7f, 0.7f, 1.0f));
@@ -772,11 +931,18 @@ void Game::renderImGui() {
     } else {
         if (connectionState.isReconnecting) {
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.9f, 0.7f, 0.2f, 1.0f));
-            ImGui::Text("Reconnecting...");
+            ImGui::Text("Reconnecting... (%d/%d)", connectionState.reconnectAttempts,
+                        connectionState.maxReconnectAttempts);
             ImGui::PopStyleColor();
         } else if (gameClient && gameClient->isConnected()) {
             ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.2f, 0.8f, 0.2f, 1.0f));
-            ImGui::Text("Connected");
+            int rttMs = gameClient->getRttMs();
+            const char* transport = gameClient->isLocal() ? ", shared memory" : "";
+            if (rttMs >= 0) {
+                ImGui::Text("Connected (%d ms%s)", rttMs, transport);
+            } else {
+                ImGui::Text("Connected%s", transport);
+            }
             ImGui::PopStyleColor();
             connectionState.isConnected = true;
         } else {
@@ -786,6 +952,19 @@ void Game::renderImGui() {
         }
     }
 
+    // Lobby members, as last reported by presence
+    if (!presenceMembers.empty()) {
+        ImGui::Text("Players:");
+        for (const auto& member : presenceMembers) {
+            int rttMs = (isServer && gameServer) ? gameServer->getRttMs(member.id) : -1;
+            if (rttMs >= 0) {
+                ImGui::BulletText("%s (%s, %d ms)", member.name.c_str(), presenceStatusName(member.status), rttMs);
+            } else {
+                ImGui::BulletText("%s (%s)", member.name.c_str(), presenceStatusName(member.status));
+            }
+        }
+    }
+
     ImGui::Separator();
 
     // Control buttons
@@ -797,16 +976,99 @@ void Game::renderImGui() {
 
     ImGui::SameLine();
 
+    bool hintsEnabled = showHints;
+    if (ImGui::Checkbox("Hints (H)", &hintsEnabled)) {
+        setShowHints(hintsEnabled);
+    }
+    if (showHints && hintAnalyzer && hintAnalyzer->isBusy()) {
+        ImGui::SameLine();
+        ImGui::Text("(analyzing...)");
+    }
+
+    ImGui::SameLine();
+
     if (ImGui::Button("Disconnect")) {
         stopGame();
     }
 
+    // Room migration: hand the room to another (idle) server on this machine
+    if (isServer && !vsBot && RoomMigration::isSupported()) {
+        ImGui::InputText("Target port", migrationPortBuffer, sizeof(migrationPortBuffer));
+        ImGui::SameLine();
+        if (ImGui::Button(roomFrozen ? "Migrating..." : "Migrate room") && !roomFrozen) {
+            int targetPort = std::atoi(migrationPortBuffer);
+            if (targetPort <= 0 || targetPort > 65535 || targetPort == port) {
+                addMessage("Enter the port of another server on this machine", MessageType::WARNING);
+            } else {
+                Command cmd{};
+                cmd.type = CommandType::MIGRATE_ROOM;
+                cmd.port = static_cast<uint16_t>(targetPort);
+                commandInputQueue.enqueue(cmd);
+            }
+        }
+    }
+
+    // Analysis panel: statistics of the hint search for the current position
+    if (showHints && hintAnalyzer) {
+        SearchResult stats = hintAnalyzer->getStats();
+        ImGui::Separator();
+        ImGui::Text("Analysis:");
+        ImGui::Text("  Nodes: %llu (%.2f ms, depth %d)",
+                    static_cast<unsigned long long>(stats.nodes), stats.elapsedMs, stats.depth);
+        ImGui::Text("  Cutoffs: %llu (first move %.1f%%)",
+                    static_cast<unsigned long long>(stats.cutoffs), stats.firstMoveCutoffRate() * 100.0);
+        ImGui::Text("  TT hit rate: %.1f%%", stats.tableStats.hitRate() * 100.0);
+    }
+
     // Render timestamped messages
     renderMessages();
 
+    if (!vsBot) {
+        renderChat();
+    }
+
     ImGui::End();
 }
 
+/**
+ * Renders the chat panel: the recent lines of the selected room and an input line.
+ * Sent lines appear once the server relays them back.
+ */
+void Game::renderChat() {
+    ImGui::Separator();
+    ImGui::Text("Chat:");
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Game", !chatInLobby)) {
+        chatInLobby = false;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Lobby", chatInLobby)) {
+        chatInLobby = true;
+    }
+
+    const char* room = chatInLobby ? "lobby" : "game";
+    ImGui::BeginChild("ChatLog", ImVec2(0, 120), true);
+    for (const auto& line : chatLog) {
+        if (line.room == room) {
+            ImGui::TextWrapped("%s: %s", line.from.c_str(), line.text.c_str());
+        }
+    }
+    if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+        ImGui::SetScrollHereY(1.0f);
+    }
+    ImGui::EndChild();
+
+    if (ImGui::InputText("##chat", chatInput, sizeof(chatInput), ImGuiInputTextFlags_EnterReturnsTrue) &&
+        chatInput[0] != '\0') {
+        ChatLine line;
+        line.room = room;
+        line.text = chatInput;
+        outgoingChat.enqueue(line);
+        chatInput[0] = '\0';
+        ImGui::SetKeyboardFocusHere(-1);
+    }
+}
+
 /*-----------------------------------------------------------------------------
  *                      LOGIC THREAD - Game Rules
 *---------------------------------------------------------------------------*/
@@ -817,7 +1079,7 @@ void Game::renderImGui() {
  *  - Maintains a local copy of the current player and game result for processing
  *  - Processes commands from the commandInputQueue to handle player moves and network updates
  *  - Validates moves, updates the board, checks for winners, and switches turns as needed
- *  - Updates the currentRenderState and enqueues it for the render thread to display changes immediately
+ *  - Enqueues a GameStateSnapshot for the render thread, which draws from it alone
  */
 void Game::logicThreadFunc() {
     std::cout << "[LOGIC] Thread started (ID: " << std::this_thread::get_id() << ")" << std::endl;
@@ -835,229 +1097,646 @@ void Game::logicThreadFunc() {
                    static_cast<int>(cmd.type), cmd.x, cmd.y,
                    cmd.mark == TileState::X ? 'X' : 'O');
 
+            // Any state change invalidates the bot's search
+            if (botSearch && cmd.type != CommandType::SYNC_STATE_REQUEST) {
+                botSearch->cancel();
+                botMovePending = false;
+            }
+
             // PLACE_MARK: Player makes a move (local)
             if (cmd.type == CommandType::PLACE_MARK) {
-                // Validate move
-                if (localResult == GameResult::IN_PROGRESS &&
-                    cmd.mark == localCurrentPlayer &&
-                    board->setTile(cmd.x, cmd.y, cmd.mark)) {
-
-                    printf("[LOGIC] Placed %c at (%d, %d)\n",
-                           cmd.mark == TileState::X ? 'X' : 'O', cmd.x, cmd.y);
-                    addMessage("Move placed!", MessageType::SUCCESS);
-
-                    // Send move to opponent via network
-                    NetworkPacket packet;
-                    packet.type = PacketType::PLAYER_MOVE;
-                    packet.data["x"] = cmd.x;
-                    packet.data["y"] = cmd.y;
-                    packet.data["mark"] = static_cast<int>(cmd.mark);
-
-                    if (isServer && gameServer) {
-                        printf("[LOGIC] Server broadcasting move to client\n");
-                        gameServer->broadcastPacket(packet);
-                    } else if (!isServer && gameClient) {
-                        printf("[LOGIC] Client sending move to server\n");
+                if (isServer) {
+                    // The server applies its own moves directly and fans them out
+                    if (!roomFrozen && applyMove(cmd.x, cmd.y, cmd.mark, localCurrentPlayer, localResult)) {
+                        broadcastMove(cmd.x, cmd.y, cmd.mark, localCurrentPlayer);
+                    } else {
+                        printf("[LOGIC] Invalid move\n");
+                    }
+                } else if (gameClient) {
+                    // Predict: show the move at once and keep it pending until the server's
+                    // fan-out confirms it (the request carries the sequence number it expects)
+                    uint32_t sequence = moveSequence + static_cast<uint32_t>(pendingMoves.size()) + 1;
+                    if (applyMove(cmd.x, cmd.y, cmd.mark, localCurrentPlayer, localResult)) {
+                        pendingMoves.push_back({sequence, cmd.x, cmd.y, cmd.mark});
+
+                        NetworkPacket packet;
+                        packet.type = PacketType::PLAYER_MOVE;
+                        packet.data["x"] = cmd.x;
+                        packet.data["y"] = cmd.y;
+                        packet.data["mark"] = static_cast<int>(cmd.mark);
+                        packet.data["sequence"] = sequence;
+
+                        printf("[LOGIC] Client predicted move #%u\n", sequence);
                         gameClient->sendPacketToServer(packet);
+                    } else {
+                        printf("[LOGIC] Invalid move\n");
                     }
+                }
 
-                    // Check for winner
-                    localResult = board->checkWinner();
-
-                    // Display win/draw messages
-                    if (localResult == GameResult::X_WINS) {
-                        if (myMark == TileState::X) {
-                            addMessage("🎉 You win!", MessageType::SUCCESS);
-                        } else {
-                            addMessage("X wins - You lose!", MessageType::ERROR);
-                        }
-                    } else if (localResult == GameResult::O_WINS) {
-                        if (myMark == TileState::O) {
-                            addMessage("🎉 You win!", MessageType::SUCCESS);
-                        } else {
-                            addMessage("O wins - You lose!", MessageType::ERROR);
+            // NETWORK_MOVE: Server: a client's move request / Client: a move fanned out by the server
+            } else if (cmd.type == CommandType::NETWORK_MOVE) {
+                if (isServer) {
+                    if (cmd.sequence <= moveSequence) {
+                        // Retransmission, or raced by a move that was accepted first
+                        printf("[LOGIC] Ignoring stale move request #%u (at #%u)\n", cmd.sequence, moveSequence);
+                    } else if (!roomFrozen && cmd.sequence == moveSequence + 1 &&
+                               applyMove(cmd.x, cmd.y, cmd.mark, localCurrentPlayer, localResult)) {
+                        // The fan-out doubles as the requesting client's acknowledgement
+                        broadcastMove(cmd.x, cmd.y, cmd.mark, localCurrentPlayer);
+                    } else {
+                        printf("[LOGIC] Rejected move request #%u from client %u\n", cmd.sequence, cmd.connection);
+                        if (gameServer) {
+                            NetworkPacket rejection;
+                            rejection.type = PacketType::MOVE_REJECTED;
+                            rejection.data["sequence"] = cmd.sequence;
+                            rejection.data["x"] = cmd.x;
+                            rejection.data["y"] = cmd.y;
+                            gameServer->sendPacketToClient(cmd.connection, rejection);
                         }
-                    } else if (localResult == GameResult::DRAW) {
-                        addMessage("It's a draw!", MessageType::INFO);
+                        sendState(cmd.connection, FULL_STATE, localCurrentPlayer, localResult);
                     }
 
-                    // Switch turn (if game continues)
-                    if (localResult == GameResult::IN_PROGRESS) {
-                        localCurrentPlayer = (localCurrentPlayer == TileState::X) ?
-                                            TileState::O : TileState::X;
-                        printf("[LOGIC] Turn switched to %c\n",
-                               localCurrentPlayer == TileState::X ? 'X' : 'O');
-                    }
+                } else if (cmd.sequence <= moveSequence) {
+                    printf("[LOGIC] Ignoring duplicate move #%u\n", cmd.sequence);
 
-                    // Update render state immediately
-                    GameStateSnapshot snapshot;
-                    snapshot.boardState = board->getGrid();
-                    snapshot.currentPlayer = localCurrentPlayer;
-                    snapshot.result = localResult;
-                    snapshot.isMyTurn = (localCurrentPlayer == myMark);
-
-                    currentRenderState = snapshot;
-                    gameStateQueue.enqueue(snapshot);
+                } else if (cmd.sequence > moveSequence + 1) {
+                    // Missed a move: ask for the moves after the last one applied
+                    printf("[LOGIC] Sequence gap (#%u after #%u), requesting missed moves\n",
+                           cmd.sequence, moveSequence);
+                    NetworkPacket request;
+                    request.type = PacketType::RESYNC_REQUEST;
+                    request.data["sequence"] = moveSequence;
+                    gameClient->sendPacketToServer(request);
 
                 } else {
-                    printf("[LOGIC] Invalid move\n");
-                }
-
-            // NETWORK_MOVE: Opponent made a move (received from network)
-            } else if (cmd.type == CommandType::NETWORK_MOVE) {
-                if (board->setTile(cmd.x, cmd.y, cmd.mark)) {
-                    std::cout << "[LOGIC] Applied network move: "
-                              << (cmd.mark == TileState::X ? "X" : "O")
-                              << " at (" << cmd.x << ", " << cmd.y << ")" << std::endl;
-
-                    addMessage("Opponent moved!", MessageType::INFO);
-
-                    // Check winner
-                    localResult = board->checkWinner();
-
-                    if (localResult == GameResult::X_WINS) {
-                        if (myMark == TileState::X) {
-                            addMessage("🎉 You win!", MessageType::SUCCESS);
-                        } else {
-                            addMessage("X wins - You lose!", MessageType::ERROR);
+                    // Advance the confirmed state first, then reconcile the prediction with it
+                    bool applied = confirmedResult == GameResult::IN_PROGRESS &&
+                                   cmd.mark == confirmedPlayer &&
+                                   confirmedBoard.setTile(cmd.x, cmd.y, cmd.mark);
+                    if (applied) {
+                        confirmedResult = confirmedBoard.checkWinner();
+                        if (confirmedResult == GameResult::IN_PROGRESS) {
+                            confirmedPlayer = (confirmedPlayer == TileState::X) ? TileState::O : TileState::X;
                         }
-                    } else if (localResult == GameResult::O_WINS) {
-                        if (myMark == TileState::O) {
-                            addMessage("🎉 You win!", MessageType::SUCCESS);
-                        } else {
-                            addMessage("O wins - You lose!", MessageType::ERROR);
-                        }
-                    } else if (localResult == GameResult::DRAW) {
-                        addMessage("It's a draw!", MessageType::INFO);
+                    }
+                    moveSequence = cmd.sequence;
+
+                    if (!pendingMoves.empty() && pendingMoves.front().sequence == cmd.sequence &&
+                        pendingMoves.front().x == cmd.x && pendingMoves.front().y == cmd.y &&
+                        pendingMoves.front().mark == cmd.mark) {
+                        // Acknowledged: the board already shows this move
+                        pendingMoves.pop_front();
+                    } else if (!pendingMoves.empty()) {
+                        // Another move got this sequence number first: the prediction is void
+                        printf("[LOGIC] Prediction #%u lost to move #%u, rolling back\n",
+                               pendingMoves.front().sequence, cmd.sequence);
+                        pendingMoves.clear();
+                        rebuildPrediction(localCurrentPlayer, localResult);
+                        addMessage("Move rejected by server", MessageType::WARNING);
+                    } else if (!applyMove(cmd.x, cmd.y, cmd.mark, localCurrentPlayer, localResult)) {
+                        rebuildPrediction(localCurrentPlayer, localResult);
                     }
 
-                    // Switch turn
-                    if (localResult == GameResult::IN_PROGRESS) {
-                        localCurrentPlayer = (localCurrentPlayer == TileState::X) ?
-                                            TileState::O : TileState::X;
+                    // Both sides applied the move to their own board: equal digests mean they still agree
+                    uint64_t localDigest = confirmedBoard.getDigest(confirmedPlayer);
+                    if (!applied || (cmd.digest != 0 && cmd.digest != localDigest)) {
+                        printf("[LOGIC] State digest mismatch (server %016llx, local %016llx), resyncing\n",
+                               static_cast<unsigned long long>(cmd.digest),
+                               static_cast<unsigned long long>(localDigest));
+                        NetworkPacket request;
+                        request.type = PacketType::RESYNC_REQUEST;
+                        gameClient->sendPacketToServer(request);
                     }
+                }
 
-                    // Update render state immediately
-                    GameStateSnapshot snapshot;
-                    snapshot.boardState = board->getGrid();
-                    snapshot.currentPlayer = localCurrentPlayer;
-                    snapshot.result = localResult;
-                    snapshot.isMyTurn = (localCurrentPlayer == myMark);
+            // A room being handed over stays as it was checkpointed
+            } else if (isServer && roomFrozen &&
+                       (cmd.type == CommandType::RESET_GAME || cmd.type == CommandType::NETWORK_RESET)) {
+                printf("[LOGIC] Ignoring reset while the room moves\n");
 
-                    currentRenderState = snapshot;
-                    gameStateQueue.enqueue(snapshot);
+            // RESET_GAME / NETWORK_RESET on the server: resets are sequenced like moves
+            } else if (isServer && (cmd.type == CommandType::RESET_GAME || cmd.type == CommandType::NETWORK_RESET)) {
+                resetState(localCurrentPlayer, localResult);
+                moveSequence++;
+                resetSequence = moveSequence;
+                moveLog.clear();
 
-                } else {
-                    printf("[LOGIC] Failed to apply network move\n");
+                if (gameServer) {
+                    NetworkPacket packet;
+                    packet.type = PacketType::GAME_RESET;
+                    packet.data["sequence"] = moveSequence;
+                    gameServer->broadcastPacket(packet);
                 }
 
-            // RESET_GAME: Player pressed Reset (local)
-            } else if (cmd.type == CommandType::RESET_GAME) {
-                printf("[LOGIC] Local reset, sending to network...\n");
-                board->resetBoard();
-                localCurrentPlayer = TileState::X;
-                localResult = GameResult::IN_PROGRESS;
-
-                addMessage("Game reset!", MessageType::INFO);
+                addMessage(cmd.type == CommandType::RESET_GAME ? "Game reset!" : "Game reset by opponent!",
+                           MessageType::INFO);
+                printf("[LOGIC] Game reset (#%u)\n", moveSequence);
 
-                // Send reset to network (if not already from network)
+            // RESET_GAME on a client: local requests go to the server, the server's reset is applied
+            } else if (cmd.type == CommandType::RESET_GAME) {
                 if (!cmd.fromNetwork) {
+                    printf("[LOGIC] Requesting reset from server...\n");
                     NetworkPacket packet;
                     packet.type = PacketType::GAME_RESET;
-                    if (isServer && gameServer) {
-                        gameServer->broadcastPacket(packet);
-                    } else if (!isServer && gameClient) {
+                    if (gameClient) {
                         gameClient->sendPacketToServer(packet);
                     }
+                } else if (cmd.sequence > moveSequence) {
+                    confirmedBoard.resetBoard();
+                    confirmedPlayer = TileState::X;
+                    confirmedResult = GameResult::IN_PROGRESS;
+                    pendingMoves.clear();
+                    resetState(localCurrentPlayer, localResult);
+                    moveSequence = cmd.sequence;
+                    addMessage("Game reset!", MessageType::INFO);
+                    printf("[LOGIC] Game reset (#%u)\n", moveSequence);
                 }
 
-                // Update render state immediately
-                GameStateSnapshot resetSnapshot;
-                resetSnapshot.boardState = board->getGrid();
-                resetSnapshot.currentPlayer = TileState::X;
-                resetSnapshot.result = GameResult::IN_PROGRESS;
-                resetSnapshot.isMyTurn = (TileState::X == myMark);
+            // SYNC_STATE_REQUEST: Server sends state to a new or diverged client
+            } else if (cmd.type == CommandType::SYNC_STATE_REQUEST) {
+                printf("[LOGIC] Syncing state to clients...\n");
+                sendState(cmd.connection, cmd.sequence, localCurrentPlayer, localResult);
 
-                currentRenderState = resetSnapshot;
-                gameStateQueue.enqueue(resetSnapshot);
+            // SYNC_STATE_RECEIVED: Client received full state from server
+            } else if (cmd.type == CommandType::SYNC_STATE_RECEIVED) {
+                printf("[LOGIC] Received sync from network thread\n");
 
-                printf("[LOGIC] Game reset\n");
+                // The server's state replaces both the confirmed state and any prediction
+                if (PositionCodec::decode(cmd.position, confirmedBoard)) {
+                    confirmedPlayer = cmd.mark;  // Passed via mark field
+                    confirmedResult = confirmedBoard.checkWinner();
+                    moveSequence = cmd.sequence;
+                    pendingMoves.clear();
+                    rebuildPrediction(localCurrentPlayer, localResult);
 
-            // NETWORK_RESET: Opponent reset the game
-            } else if (cmd.type == CommandType::NETWORK_RESET) {
-                printf("[LOGIC] Received network reset\n");
-                board->resetBoard();
-                localCurrentPlayer = TileState::X;
-                localResult = GameResult::IN_PROGRESS;
+                    if (cmd.digest != 0 && cmd.digest != confirmedBoard.getDigest(confirmedPlayer)) {
+                        printf("[LOGIC] Warning: synced state does not match its digest\n");
+                    }
+                    printf("[LOGIC] Updated local state: currentPlayer=%c, sequence=#%u\n",
+                           localCurrentPlayer == TileState::X ? 'X' : 'O', moveSequence);
+                    addMessage("Board and turn synchronized!", MessageType::SUCCESS);
+                }
 
-                addMessage("Game reset by opponent!", MessageType::INFO);
+            // MOVE_REJECTED: The server refused a predicted move; it and every later prediction are void
+            } else if (cmd.type == CommandType::MOVE_REJECTED) {
+                while (!pendingMoves.empty() && pendingMoves.back().sequence >= cmd.sequence) {
+                    pendingMoves.pop_back();
+                }
+                rebuildPrediction(localCurrentPlayer, localResult);
+                addMessage("Move rejected by server", MessageType::WARNING);
+
+            // MIGRATE_ROOM: Freeze the room; the network thread hands the checkpoint over
+            } else if (cmd.type == CommandType::MIGRATE_ROOM) {
+                if (isServer && gameServer && !roomFrozen) {
+                    roomFrozen = true;
+                    RoomCheckpoint checkpoint;
+                    checkpoint.position = PositionCodec::encode(*board);
+                    checkpoint.currentPlayer = localCurrentPlayer;
+                    checkpoint.sequence = moveSequence;
+                    outgoingRooms.enqueue({cmd.port, checkpoint});
+                    addMessage("Moving the room to port " + std::to_string(cmd.port) + "...", MessageType::INFO);
+                }
 
-                // Update render state immediately
-                GameStateSnapshot resetSnapshot;
-                resetSnapshot.boardState = board->getGrid();
-                resetSnapshot.currentPlayer = TileState::X;
-                resetSnapshot.result = GameResult::IN_PROGRESS;
-                resetSnapshot.isMyTurn = (TileState::X == myMark);
+            // ADOPT_ROOM: Another server handed its room to this one. Both seats belong to the
+            // players following the room, so the host watches; the sequence carries on, so
+            // the clients' resyncs line up with where they were
+            } else if (cmd.type == CommandType::ADOPT_ROOM) {
+                if (isServer && PositionCodec::decode(cmd.position, *board)) {
+                    localCurrentPlayer = cmd.mark;
+                    localResult = board->checkWinner();
+                    moveSequence = cmd.sequence;
+                    resetSequence = moveSequence;
+                    moveLog.clear();
+                    myMark = TileState::EMPTY;
+                    publishState(localCurrentPlayer, localResult);
+                    printf("[LOGIC] Adopted room at #%u\n", moveSequence);
+                }
 
-                currentRenderState = resetSnapshot;
-                gameStateQueue.enqueue(resetSnapshot);
+            // SEAT_ASSIGNED: The server's handshake says which mark this client plays. Moves
+            // predicted under another mark would only be rejected, so they are dropped
+            } else if (cmd.type == CommandType::SEAT_ASSIGNED) {
+                if (!isServer && cmd.mark != myMark) {
+                    myMark = cmd.mark;
+                    pendingMoves.clear();
+                    rebuildPrediction(localCurrentPlayer, localResult);
+                    addMessage(myMark == TileState::EMPTY ? std::string("Spectating: both seats are taken")
+                                                          : std::string("You play ") + (myMark == TileState::X ? "X" : "O"),
+                               MessageType::INFO);
+                }
+            }
+        }
 
-            // SYNC_STATE_REQUEST: Server needs to send full state to new client
-            } else if (cmd.type == CommandType::SYNC_STATE_REQUEST) {
-                printf("[LOGIC] Syncing full state to clients...\n");
-
-                if (isServer && gameServer && board) {
-                    NetworkPacket syncPacket;
-                    syncPacket.type = PacketType::GAME_STATE;
-
-                    // Serialize board state
-                    auto cells = board->getGrid();
-                    std::vector<int> boardData;
-                    for (int y = 0; y < 3; y++) {
-                        for (int x = 0; x < 3; x++) {
-                            boardData.push_back(static_cast<int>(cells[y][x]));
-                        }
-                    }
+        // Bot thinks in slices between command batches
+        bool botThinking = vsBot && botSearch && updateBot(localCurrentPlayer, localResult);
 
-                    syncPacket.data["board"] = boardData;
-                    syncPacket.data["currentPlayer"] = static_cast<int>(localCurrentPlayer);
-                    syncPacket.data["result"] = static_cast<int>(localResult);
+        // Small sleep to prevent busy-waiting (just yield while the bot is thinking)
+        if (botThinking) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
 
-                    gameServer->broadcastPacket(syncPacket);
-                    printf("[LOGIC] State sync packet sent!\n");
-                }
+    printf("[LOGIC] Thread exiting...\n");
+}
 
-            // SYNC_STATE_RECEIVED: Client received full state from server
-            } else if (cmd.type == CommandType::SYNC_STATE_RECEIVED) {
-                printf("[LOGIC] Received sync from network thread\n");
+/**
+ * Validates and applies a move, then updates the turn, result, messages and render state
+ * (logic thread only).
+ *
+ * @param currentPlayer the player to move (switched if the game continues)
+ * @param result the current game result (updated)
+ * @return true if the move was legal and applied
+ */
+bool Game::applyMove(int x, int y, TileState mark, TileState& currentPlayer, GameResult& result) {
+    if (result != GameResult::IN_PROGRESS || mark != currentPlayer || !board->setTile(x, y, mark)) {
+        return false;
+    }
 
-                // Update local state from sync
-                localCurrentPlayer = cmd.mark;  // Passed via mark field
-                localResult = board->checkWinner();
+    printf("[LOGIC] Placed %c at (%d, %d)\n", mark == TileState::X ? 'X' : 'O', x, y);
+    if (mark == myMark) {
+        addMessage("Move placed!", MessageType::SUCCESS);
+    } else {
+        addMessage("Opponent moved!", MessageType::INFO);
+    }
 
-                printf("[LOGIC] Updated local state: currentPlayer=%c\n",
-                       localCurrentPlayer == TileState::X ? 'X' : 'O');
+    // Check for winner and display win/draw messages
+    result = board->checkWinner();
+    if (result == GameResult::X_WINS) {
+        if (myMark == TileState::X) {
+            addMessage("🎉 You win!", MessageType::SUCCESS);
+        } else {
+            addMessage("X wins - You lose!", MessageType::ERROR);
+        }
+    } else if (result == GameResult::O_WINS) {
+        if (myMark == TileState::O) {
+            addMessage("🎉 You win!", MessageType::SUCCESS);
+        } else {
+            addMessage("O wins - You lose!", MessageType::ERROR);
+        }
+    } else if (result == GameResult::DRAW) {
+        addMessage("It's a draw!", MessageType::INFO);
+    }
 
-                // Update render state immediately
-                GameStateSnapshot snapshot;
-                snapshot.boardState = board->getGrid();
-                snapshot.currentPlayer = localCurrentPlayer;
-                snapshot.result = localResult;
-                snapshot.isMyTurn = (localCurrentPlayer == myMark);
+    // Switch turn (if game continues)
+    if (result == GameResult::IN_PROGRESS) {
+        currentPlayer = (currentPlayer == TileState::X) ? TileState::O : TileState::X;
+    }
 
-                currentRenderState = snapshot;
-                gameStateQueue.enqueue(snapshot);
+    publishState(currentPlayer, result);
+    return true;
+}
 
-                printf("[LOGIC] Sent updated state: isMyTurn=%s\n",
-                       snapshot.isMyTurn ? "YES" : "NO");
+/**
+ * Server: assigns the next sequence number to an applied move, logs it for delta
+ * resyncs and fans it out to every client (logic thread only).
+ *
+ * @param currentPlayer the player to move after the move
+ */
+void Game::broadcastMove(int x, int y, TileState mark, TileState currentPlayer) {
+    NetworkPacket packet;
+    packet.type = PacketType::PLAYER_MOVE;
+    packet.data["x"] = x;
+    packet.data["y"] = y;
+    packet.data["mark"] = static_cast<int>(mark);
+    packet.data["sequence"] = ++moveSequence;
+    packet.data["digest"] = board->getDigest(currentPlayer);
+    moveLog.push_back(packet);
+
+    if (gameServer) {
+        printf("[LOGIC] Server broadcasting move #%u\n", moveSequence);
+        gameServer->broadcastPacket(packet);
+    }
+}
+
+/**
+ * Server: brings a client up to date (logic thread only). A client that only missed
+ * moves since the last reset gets those moves replayed; anyone else (new clients,
+ * diverged clients) gets the full state.
+ *
+ * @param connection the client, or k_HSteamNetConnection_Invalid for all clients
+ * @param sinceSequence the last sequence number the client applied, or FULL_STATE
+ */
+void Game::sendState(HSteamNetConnection connection, uint32_t sinceSequence, TileState currentPlayer, GameResult result) {
+    if (!gameServer || !board) {
+        return;
+    }
+
+    if (connection != k_HSteamNetConnection_Invalid && sinceSequence >= resetSequence && sinceSequence <= moveSequence) {
+        for (const auto& packet : moveLog) {
+            if (packet.data["sequence"].get<uint32_t>() > sinceSequence) {
+                gameServer->sendPacketToClient(connection, packet);
             }
         }
+        printf("[LOGIC] Replayed moves #%u..#%u to client %u\n", sinceSequence + 1, moveSequence, connection);
+        return;
+    }
+
+    NetworkPacket syncPacket;
+    syncPacket.type = PacketType::GAME_STATE;
 
-        // Small sleep to prevent busy-waiting
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    // Board as one base-3 index instead of an array of nine ints
+    syncPacket.data["position"] = PositionCodec::encode(*board);
+    syncPacket.data["currentPlayer"] = static_cast<int>(currentPlayer);
+    syncPacket.data["result"] = static_cast<int>(result);
+    syncPacket.data["digest"] = board->getDigest(currentPlayer);
+    syncPacket.data["sequence"] = moveSequence;
+
+    // Targeted resync goes to the diverged client only, a join sync to everyone
+    if (connection != k_HSteamNetConnection_Invalid) {
+        gameServer->sendPacketToClient(connection, syncPacket);
+    } else {
+        gameServer->broadcastPacket(syncPacket);
     }
+    printf("[LOGIC] State sync packet sent (#%u)\n", moveSequence);
+}
 
-    printf("[LOGIC] Thread exiting...\n");
+/**
+ * Clears the board for a new game and publishes the empty state (logic thread only).
+ */
+void Game::resetState(TileState& currentPlayer, GameResult& result) {
+    board->resetBoard();
+    currentPlayer = TileState::X;
+    result = GameResult::IN_PROGRESS;
+    publishState(currentPlayer, result);
+}
+
+/**
+ * Client: rebuilds the displayed board from the confirmed state plus the moves still
+ * pending, e.g. after a prediction was rejected (logic thread only).
+ *
+ * @param currentPlayer receives the predicted player to move
+ * @param result receives the predicted game result
+ */
+void Game::rebuildPrediction(TileState& currentPlayer, GameResult& result) {
+    PositionCodec::decode(PositionCodec::encode(confirmedBoard), *board);
+    currentPlayer = confirmedPlayer;
+    result = confirmedResult;
+
+    for (const auto& move : pendingMoves) {
+        board->setTile(move.x, move.y, move.mark);
+        result = board->checkWinner();
+        if (result == GameResult::IN_PROGRESS) {
+            currentPlayer = (move.mark == TileState::X) ? TileState::O : TileState::X;
+        }
+    }
+    publishState(currentPlayer, result);
+}
+
+/**
+ * Hands the current board to the render thread.
+ */
+void Game::publishState(TileState currentPlayer, GameResult result) {
+    GameStateSnapshot snapshot;
+    snapshot.position = PositionCodec::encode(*board);
+    snapshot.currentPlayer = currentPlayer;
+    snapshot.result = result;
+    snapshot.isMyTurn = (currentPlayer == myMark);
+    gameStateQueue.enqueue(snapshot);
+}
+
+/**
+ * Moves chat between the render thread and the network (network thread only).
+ *  - Server: the host's lines go through the relay like everyone else's; the relay's
+ *    coalesced per-room batches are broadcast on the chat lane and shown locally
+ *  - Client: lines typed this tick are coalesced into one packet per room
+ */
+void Game::updateChat() {
+    auto now = std::chrono::steady_clock::now();
+    ChatLine line;
+
+    if (isServer && gameServer && chatRelay) {
+        while (outgoingChat.try_dequeue(line)) {
+            if (!chatRelay->submit(k_HSteamNetConnection_Invalid, "Host", line.room, line.text, now)) {
+                addMessage("Chat: slow down!", MessageType::WARNING);
+            }
+        }
+        for (const auto& packet : chatRelay->flush(now)) {
+            gameServer->broadcastPacket(packet, Lane::CHAT);
+            for (const auto& relayed : ChatRelay::parse(packet)) {
+                incomingChat.enqueue(relayed);
+            }
+        }
+
+    } else if (!isServer && gameClient && gameClient->isConnected()) {
+        std::unordered_map<std::string, json> batches;
+        while (outgoingChat.try_dequeue(line)) {
+            json& lines = batches[line.room];
+            if (lines.is_null()) {
+                lines = json::array();
+            }
+            lines.push_back({{"text", line.text}});
+        }
+        for (auto& [room, lines] : batches) {
+            NetworkPacket packet;
+            packet.type = PacketType::CHAT_MESSAGE;
+            packet.data["room"] = room;
+            packet.data["lines"] = lines;
+            gameClient->sendPacketToServer(packet, Lane::CHAT);
+        }
+    }
+}
+
+/**
+ * Handles a PLAYER_JOINED packet (network thread only).
+ *  - Server: a client reporting its own status, or asking for a snapshot
+ *  - Client: a snapshot or delta for the local member list; a gap in the deltas
+ *    is answered with a snapshot request
+ */
+void Game::handlePresencePacket(const NetworkPacket& packet) {
+    if (isServer) {
+        if (!presenceService) {
+            return;
+        }
+        if (packet.data.contains("status")) {
+            presenceService->setStatus(packet.connection, toPresenceStatus(packet.data.value("status", 0)));
+        }
+        if (packet.data.value("snapshot", false)) {
+            gameServer->sendPacketToClient(packet.connection, presenceService->snapshot(), Lane::CHAT);
+        }
+        return;
+    }
+
+    std::vector<std::string> joinedNames;
+    switch (presenceView.apply(packet, &joinedNames)) {
+        case PresenceView::ApplyResult::APPLIED:
+            presenceUpdates.enqueue(presenceView.getMembers());
+            for (const auto& name : joinedNames) {
+                addMessage(name + " joined", MessageType::INFO);
+            }
+            break;
+
+        case PresenceView::ApplyResult::NEEDS_SNAPSHOT: {
+            printf("[NETWORK] Missed a presence delta, requesting a snapshot\n");
+            NetworkPacket request;
+            request.type = PacketType::PLAYER_JOINED;
+            request.data["snapshot"] = true;
+            gameClient->sendPacketToServer(request, Lane::CHAT);
+            break;
+        }
+
+        case PresenceView::ApplyResult::IGNORED:
+            break;
+    }
+}
+
+/**
+ * Publishes presence once per PRESENCE_TICK_MS (network thread only).
+ *  - Server: records the host's status, then broadcasts the tick's coalesced delta
+ *    (nothing at all if the lobby is idle) on the chat lane
+ *  - Client: reports the local status when it has changed
+ */
+void Game::updatePresence() {
+    auto now = std::chrono::steady_clock::now();
+    if (now < nextPresenceTick) {
+        return;
+    }
+    nextPresenceTick = now + std::chrono::milliseconds(PRESENCE_TICK_MS);
+
+    if (isServer && gameServer && presenceService) {
+        presenceService->setStatus(k_HSteamNetConnection_Invalid, localStatus);
+        NetworkPacket delta;
+        if (presenceService->flushDelta(delta)) {
+            gameServer->broadcastPacket(delta, Lane::CHAT);
+            presenceUpdates.enqueue(presenceService->getMembers());
+        }
+
+    } else if (!isServer && gameClient && gameClient->isConnected()) {
+        PresenceStatus status = localStatus;
+        if (status != sentStatus) {
+            NetworkPacket update;
+            update.type = PacketType::PLAYER_JOINED;
+            update.data["status"] = static_cast<int>(status);
+            gameClient->sendPacketToServer(update, Lane::CHAT);
+            sentStatus = status;
+        }
+    }
+}
+
+/**
+ * Moves rooms between server processes on this machine (network thread only, and
+ * without blocking it: each handover is polled once per update).
+ *  - Outgoing: hands the checkpoint the logic thread queued to the server on its port,
+ *    with the seats (tokens and marks) and a new token for the host. On success the clients
+ *    are sent on, and once the redirects are out the render thread rejoins the room
+ *    there; on failure the room thaws and play goes on here
+ *  - Incoming: a server nobody has joined takes over one room, holding its seats
+ */
+void Game::updateMigration() {
+    // Stopping the server kills lingering connections, so the redirects get time to go out
+    // while this thread carries on as usual; then the render thread follows the room
+    if (migrationFlushPort != 0) {
+        if (std::chrono::steady_clock::now() >= migrationFlushUntil) {
+            migrationToken = outgoingHostToken;
+            migratedPort = migrationFlushPort;
+            migrationFlushPort = 0;
+        }
+        return;
+    }
+
+    std::pair<uint16_t, RoomCheckpoint> outgoing;
+    std::string error;
+    if (!outgoingTransfer && outgoingRooms.try_dequeue(outgoing)) {
+        auto& [targetPort, checkpoint] = outgoing;
+        outgoingHostToken = gameServer->issueResumeToken();
+        checkpoint.room = gameServer->getRoom();
+        for (const auto& [token, mark] : gameServer->getSeats()) {
+            checkpoint.seats.push_back({token, static_cast<TileState>(mark)});
+        }
+        // The host rejoins with its own mark
+        checkpoint.seats.push_back({outgoingHostToken, myMark});
+
+        outgoingTransfer = MigrationTransfer::start(targetPort, checkpoint, error);
+        if (!outgoingTransfer) {
+            addMessage("Room migration failed: " + error, MessageType::ERROR);
+            roomFrozen = false;
+        }
+    }
+
+    if (outgoingTransfer) {
+        MigrationTransfer::Status status = outgoingTransfer->poll(error);
+        uint16_t targetPort = outgoingTransfer->getTargetPort();
+        if (status != MigrationTransfer::Status::PENDING) {
+            outgoingTransfer.reset();
+        }
+        if (status == MigrationTransfer::Status::ACCEPTED) {
+            printf("[NETWORK] Room handed to port %u\n", targetPort);
+            gameServer->redirectClients(targetPort);
+            migrationFlushUntil = std::chrono::steady_clock::now() + std::chrono::milliseconds(MIGRATION_FLUSH_MS);
+            migrationFlushPort = targetPort;
+        } else if (status == MigrationTransfer::Status::FAILED) {
+            addMessage("Room migration failed: " + error, MessageType::ERROR);
+            roomFrozen = false;
+        }
+    }
+
+    if (!migrationListener) {
+        return;
+    }
+    std::optional<RoomCheckpoint> room = migrationListener->poll();
+    if (!room) {
+        return;
+    }
+    if (gameServer->getClientCount() > 0 || clientDisconnected || roomFrozen) {
+        migrationListener->reply(false, "Server on port " + std::to_string(port) + " is in use");
+        return;
+    }
+
+    // The room's players hold every seat; this server's own host only watches
+    std::vector<std::pair<std::string, int>> seats;
+    for (const auto& seat : room->seats) {
+        seats.emplace_back(seat.token, static_cast<int>(seat.mark));
+    }
+    gameServer->setOpenSeats({static_cast<int>(TileState::X), static_cast<int>(TileState::O)});
+    gameServer->holdSeats(seats);
+    gameServer->setRoom(room->room);
+    Command cmd{};
+    cmd.type = CommandType::ADOPT_ROOM;
+    cmd.position = room->position;
+    cmd.mark = room->currentPlayer;
+    cmd.sequence = room->sequence;
+    commandInputQueue.enqueue(cmd);
+    migrationListener->reply(true);
+    migrationListener.reset();   // One room per server
+    addMessage("Took over a room from another server, waiting for its players...", MessageType::SUCCESS);
+}
+
+/**
+ * Advances the bot's search by one slice when it is the bot's turn (logic thread only).
+ *  - Starts a new search on the bot's turn and steps it by BOT_NODES_PER_SLICE nodes
+ *  - When the search is done, queues the best move as a regular PLACE_MARK command
+ *
+ * @param currentPlayer the player to move
+ * @param result the current game result
+ * @return true if the search still has work to do
+ */
+bool Game::updateBot(TileState currentPlayer, GameResult result) {
+    if (result != GameResult::IN_PROGRESS || currentPlayer != botMark || botMovePending) {
+        return false;
+    }
+
+    if (!botSearch->isRunning()) {
+        botSearch->start(*board, botMark, std::chrono::milliseconds(BOT_TIME_BUDGET_MS));
+    }
+
+    if (botSearch->step(BOT_NODES_PER_SLICE) == SearchStatus::RUNNING) {
+        return true;
+    }
+
+    SearchResult move = botSearch->getResult();
+    if (move.hasMove()) {
+        printf("[LOGIC] Bot plays (%d, %d) after %llu nodes (depth %d)\n",
+               move.bestX, move.bestY, static_cast<unsigned long long>(move.nodes), move.depth);
+
+        Command cmd;
+        cmd.type = CommandType::PLACE_MARK;
+        cmd.x = move.bestX;
+        cmd.y = move.bestY;
+        cmd.mark = botMark;
+        commandInputQueue.enqueue(cmd);
+        botMovePending = true;
+    }
+    return false;
 }
 
 /*-----------------------------------------------------------------------------
@@ -1074,7 +1753,6 @@ void Game::networkThreadFunc() {
     std::cout << "[NETWORK] Thread started (ID: " << std::this_thread::get_id() << ")" << std::endl;
     std::cout << "[NETWORK] Mode: " << (isServer ? "SERVER" : "CLIENT") << std::endl;
 
-    int previousClientCount = 0;
     bool wasConnected = false;
     bool hasShownDisconnect = false;
 
@@ -1083,14 +1761,20 @@ void Game::networkThreadFunc() {
         if (isServer && gameServer) {
             gameServer->updateServer();
 
-            // Track client connections
-            int currentClientCount = gameServer->getClientCount();
-            if (currentClientCount != previousClientCount) {
-                if (currentClientCount > previousClientCount) {
+            // Joins and leaves, as the server reports them
+            ConnectionEvent event;
+            while (gameServer->connectionEvents.try_dequeue(event)) {
+                if (event.connected) {
                     addMessage("Player connected!", MessageType::SUCCESS);
                     clientDisconnected = false;
                     hasShownDisconnect = false;
 
+                    // The newcomer gets the member list once; everyone hears of the join with the next delta
+                    if (presenceService) {
+                        presenceService->join(event.connection, "Player " + std::to_string(event.connection));
+                        gameServer->sendPacketToClient(event.connection, presenceService->snapshot(), Lane::CHAT);
+                    }
+
                     // Request state sync after short delay (let connection stabilize)
                     std::thread([this]() {
                         std::this_thread::sleep_for(std::chrono::milliseconds(500));
@@ -1101,174 +1785,252 @@ void Game::networkThreadFunc() {
                         printf("[NETWORK] Requested state sync (delayed)\n");
                     }).detach();
 
-                } else if (previousClientCount > 0 && currentClientCount == 0) {
-                    if (!hasShownDisconnect) {
-                        addMessage("Player disconnected!", MessageType::WARNING);
-                        clientDisconnected = true;
+                } else {
+                    if (presenceService) {
+                        presenceService->leave(event.connection);
+                    }
+                    if (gameServer->getClientCount() == 0 && !hasShownDisconnect) {
+                        handleDisconnection();
                         hasShownDisconnect = true;
                     }
                 }
-
-                previousClientCount = currentClientCount;
             }
 
             // Process incoming packets from clients
             NetworkPacket packet;
             while (gameServer->incomingPackets.try_dequeue(packet)) {
-                printf("[NETWORK] Server received packet type %d\n", static_cast<int>(packet.type));
-
-                if (packet.type == PacketType::PLAYER_MOVE) {
-                    int x = static_cast<int>(packet.data["x"]);
-                    int y = static_cast<int>(packet.data["y"]);
-                    auto mark = static_cast<TileState>(packet.data["mark"].get<int>());
-
-                    printf("[NETWORK] Server processing client move: %c at (%d, %d)\n",
-                           mark == TileState::X ? 'X' : 'O', x, y);
-
-                    // Forward to logic thread
-                    Command cmd{};
-                    cmd.type = CommandType::NETWORK_MOVE;
-                    cmd.x = x;
-                    cmd.y = y;
-                    cmd.mark = mark;
-                    commandInputQueue.enqueue(cmd);
-
-                } else if (packet.type == PacketType::GAME_RESET) {
-                    printf("[NETWORK] Server received reset (not echoing)\n");
-                    Command cmd;
-                    cmd.type = CommandType::NETWORK_RESET;
-                    commandInputQueue.enqueue(cmd);
+                try {
+                    handleServerPacket(packet);
+                } catch (const json::exception& e) {
+                    printf("[NETWORK] Dropped malformed packet type %d from client %u: %s\n",
+                           static_cast<int>(packet.type), packet.connection, e.what());
                 }
             }
 
+            updateMigration();
+
         // CLIENT: Handle server connection and messages
         } else if (!isServer && gameClient) {
             gameClient->updateClient();
 
+            // Seated (again) by a handshake: the logic thread switches marks
+            if (std::optional<int> seat = gameClient->takeSeat()) {
+                Command cmd{};
+                cmd.type = CommandType::SEAT_ASSIGNED;
+                cmd.mark = *seat == static_cast<int>(TileState::X) || *seat == static_cast<int>(TileState::O)
+                               ? static_cast<TileState>(*seat)
+                               : TileState::EMPTY;
+                commandInputQueue.enqueue(cmd);
+            }
+
             bool currentlyConnected = gameClient->isConnected();
 
             // Track connection state changes
             if (currentlyConnected && !wasConnected) {
                 addMessage("Connected to server!", MessageType::SUCCESS);
+
+                // Catch up on what was said before we joined
+                for (const char* room : {"lobby", "game"}) {
+                    NetworkPacket request;
+                    request.type = PacketType::CHAT_MESSAGE;
+                    request.data["room"] = room;
+                    request.data["history"] = true;
+                    gameClient->sendPacketToServer(request, Lane::CHAT);
+                }
+                // The server sends a presence snapshot to every new connection
+                presenceView.clear();
+                sentStatus = PresenceStatus::ONLINE;
+
                 connectionState.isConnected = true;
                 connectionState.isReconnecting = false;
                 hasShownDisconnect = false;
 
             } else if (!currentlyConnected && wasConnected) {
                 if (!hasShownDisconnect) {
-                    addMessage("Lost connection!", MessageType::ERROR);
-                    addMessage("Returning to menu...", MessageType::WARNING);
+                    handleDisconnection();
                     hasShownDisconnect = true;
-
-                    // Auto-disconnect after timeout
-                    std::thread([this]() {
-                        std::this_thread::sleep_for(std::chrono::seconds(5));
-                        if (running) {
-                            stopGame();
-                        }
-                    }).detach();
                 }
             }
 
+            // The first attempt never got as far as connecting (e.g. the name did not resolve)
+            if (!gameClient->getLastError().empty() && !wasConnected && !connectionState.isReconnecting &&
+                !hasShownDisconnect) {
+                addMessage(gameClient->getLastError(), MessageType::ERROR);
+                hasShownDisconnect = true;
+                returnToMenu = true;
+            }
+
             wasConnected = currentlyConnected;
+            updateReconnect();
 
             // Process incoming packets from server
             NetworkPacket packet;
             while (gameClient->incomingPackets.try_dequeue(packet)) {
-                printf("[NETWORK] Client received packet type %d\n", static_cast<int>(packet.type));
-
-                // GAME_STATE: Full board sync (for late joiners)
-                if (packet.type == PacketType::GAME_STATE) {
-                    printf("[NETWORK] RECEIVED GAME STATE SYNC\n");
-
-                    if (packet.data.contains("board") && board) {
-                        auto boardData = packet.data["board"].get<std::vector<int>>();
-
-                        // Apply board state
-                        board->resetBoard();
-                        int idx = 0;
-                        for (int y = 0; y < 3; y++) {
-                            for (int x = 0; x < 3; x++) {
-                                if (idx < boardData.size()) {
-                                    TileState state = static_cast<TileState>(boardData[idx]);
-                                    if (state != TileState::EMPTY) {
-                                        board->setTile(x, y, state);
-                                    }
-                                }
-                                idx++;
-                            }
-                        }
-
-                        // Create snapshot for render thread
-                        if (packet.data.contains("currentPlayer")) {
-                            GameStateSnapshot snapshot;
-                            snapshot.boardState = board->getGrid();
-                            snapshot.currentPlayer = static_cast<TileState>(
-                                packet.data["currentPlayer"].get<int>());
-                            snapshot.result = packet.data.contains("result") ?
-                                static_cast<GameResult>(packet.data["result"].get<int>()) :
-                                GameResult::IN_PROGRESS;
-                            snapshot.isMyTurn = (snapshot.currentPlayer == myMark);
-
-                            printf("[NETWORK] Synced state:\n");
-                            printf("[NETWORK]   currentPlayer: %c\n",
-                                   snapshot.currentPlayer == TileState::X ? 'X' : 'O');
-                            printf("[NETWORK]   myMark: %c\n",
-                                   myMark == TileState::X ? 'X' : 'O');
-                            printf("[NETWORK]   isMyTurn: %s\n",
-                                   snapshot.isMyTurn ? "YES" : "NO");
-
-                            // Update render state immediately (no queue delay)
-                            currentRenderState = snapshot;
-                            printf("[NETWORK] Updated currentRenderState directly!\n");
-
-                            gameStateQueue.enqueue(snapshot);
-
-                            // Also notify logic thread to update its local state
-                            Command syncToLogic;
-                            syncToLogic.type = CommandType::SYNC_STATE_RECEIVED;
-                            syncToLogic.mark = snapshot.currentPlayer;
-                            commandInputQueue.enqueue(syncToLogic);
-                            printf("[NETWORK] Sent sync to logic thread\n");
-
-                            addMessage("Board and turn synchronized!", MessageType::SUCCESS);
-                        }
-                    }
-
-                // PLAYER_MOVE: Opponent made a move
-                } else if (packet.type == PacketType::PLAYER_MOVE) {
-                    int x = static_cast<int>(packet.data["x"]);
-                    int y = static_cast<int>(packet.data["y"]);
-                    auto mark = static_cast<TileState>(packet.data["mark"].get<int>());
-
-                    printf("[NETWORK] Client processing server move: %c at (%d, %d)\n",
-                           mark == TileState::X ? 'X' : 'O', x, y);
-
-                    Command cmd{};
-                    cmd.type = CommandType::NETWORK_MOVE;
-                    cmd.x = x;
-                    cmd.y = y;
-                    cmd.mark = mark;
-                    commandInputQueue.enqueue(cmd);
-
-                // GAME_RESET: Opponent reset the game
-                } else if (packet.type == PacketType::GAME_RESET) {
-                    printf("[NETWORK] Client received reset (not echoing)\n");
-                    Command cmd;
-                    cmd.type = CommandType::RESET_GAME;
-                    cmd.fromNetwork = true;
-                    commandInputQueue.enqueue(cmd);
+                try {
+                    handleClientPacket(packet);
+                } catch (const json::exception& e) {
+                    printf("[NETWORK] Dropped malformed packet type %d: %s\n", static_cast<int>(packet.type), e.what());
                 }
             }
         }
 
-        // Sleep to prevent busy-waiting
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        updateChat();
+        updatePresence();
+
+        // Sleep to prevent busy-waiting; a local peer's message cuts the sleep short
+        if (isServer && gameServer) {
+            gameServer->waitForTraffic(10);
+        } else if (gameClient) {
+            gameClient->waitForTraffic(10);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
     }
 
     printf("[NETWORK] Thread exiting...\n");
 }
 
+/**
+ * Handles one packet from a client (network thread only): moves, resets and resync
+ * requests go to the logic thread, chat and presence are answered here.
+ * Fields are the client's own; a field of the wrong type throws json::exception,
+ * which drops the packet.
+ *
+ * @param packet The packet, with the sender's connection
+ */
+void Game::handleServerPacket(NetworkPacket& packet) {
+    printf("[NETWORK] Server received packet type %d\n", static_cast<int>(packet.type));
+
+    if (packet.type == PacketType::PLAYER_MOVE) {
+        int x = static_cast<int>(packet.data["x"]);
+        int y = static_cast<int>(packet.data["y"]);
+
+        // Moves are played with the sender's seat; a spectator's move, or one
+        // claiming another mark, goes through as EMPTY and is rejected
+        auto seat = static_cast<TileState>(gameServer->getSeat(packet.connection));
+        auto claimed = static_cast<TileState>(packet.data["mark"].get<int>());
+        auto mark = claimed == seat ? seat : TileState::EMPTY;
+
+        printf("[NETWORK] Server processing client move: %c at (%d, %d)\n",
+               mark == TileState::X ? 'X' : mark == TileState::O ? 'O' : '-', x, y);
+
+        // Forward to logic thread
+        Command cmd{};
+        cmd.type = CommandType::NETWORK_MOVE;
+        cmd.x = x;
+        cmd.y = y;
+        cmd.mark = mark;
+        cmd.sequence = packet.data.value("sequence", 0u);
+        cmd.connection = packet.connection;
+        commandInputQueue.enqueue(cmd);
+
+    } else if (packet.type == PacketType::GAME_RESET) {
+        printf("[NETWORK] Server received reset (not echoing)\n");
+        Command cmd;
+        cmd.type = CommandType::NETWORK_RESET;
+        commandInputQueue.enqueue(cmd);
+
+    } else if (packet.type == PacketType::CHAT_MESSAGE && chatRelay) {
+        std::string room = packet.data.value("room", std::string());
+        if (packet.data.value("history", false)) {
+            NetworkPacket history;
+            if (chatRelay->history(packet.connection, room, std::chrono::steady_clock::now(), history)) {
+                gameServer->sendPacketToClient(packet.connection, history, Lane::CHAT);
+            }
+        } else {
+            // Names are assigned here, so clients cannot speak as someone else
+            std::string from = "Player " + std::to_string(packet.connection);
+            for (const auto& line : ChatRelay::parse(packet)) {
+                chatRelay->submit(packet.connection, from, room, line.text, std::chrono::steady_clock::now());
+            }
+        }
+
+    } else if (packet.type == PacketType::PLAYER_JOINED) {
+        handlePresencePacket(packet);
+
+    } else if (packet.type == PacketType::RESYNC_REQUEST) {
+        printf("[NETWORK] Client %u requested a resync\n", packet.connection);
+        Command cmd{};
+        cmd.type = CommandType::SYNC_STATE_REQUEST;
+        cmd.connection = packet.connection;
+        cmd.sequence = packet.data.value("sequence", FULL_STATE);
+        commandInputQueue.enqueue(cmd);
+    }
+}
+
+/**
+ * Handles one packet from the server (network thread only): game updates go to the
+ * logic thread, chat and presence to their views. A field of the wrong type throws
+ * json::exception, which drops the packet.
+ *
+ * @param packet The packet
+ */
+void Game::handleClientPacket(NetworkPacket& packet) {
+    printf("[NETWORK] Client received packet type %d\n", static_cast<int>(packet.type));
+
+    // GAME_STATE: Full board sync (for late joiners)
+    if (packet.type == PacketType::GAME_STATE) {
+        printf("[NETWORK] RECEIVED GAME STATE SYNC\n");
+
+        // The logic thread owns the board: it applies the state and drops any predicted moves
+        if (packet.data.contains("position") && packet.data.contains("currentPlayer")) {
+            Command syncToLogic;
+            syncToLogic.type = CommandType::SYNC_STATE_RECEIVED;
+            syncToLogic.position = packet.data["position"].get<uint32_t>();
+            syncToLogic.mark = static_cast<TileState>(packet.data["currentPlayer"].get<int>());
+            syncToLogic.sequence = packet.data.value("sequence", 0u);
+            syncToLogic.digest = packet.data.value("digest", uint64_t{0});
+            commandInputQueue.enqueue(syncToLogic);
+            printf("[NETWORK] Sent sync to logic thread\n");
+        }
+
+    // PLAYER_MOVE: Opponent made a move
+    } else if (packet.type == PacketType::PLAYER_MOVE) {
+        int x = static_cast<int>(packet.data["x"]);
+        int y = static_cast<int>(packet.data["y"]);
+        auto mark = static_cast<TileState>(packet.data["mark"].get<int>());
+
+        printf("[NETWORK] Client processing server move: %c at (%d, %d)\n",
+               mark == TileState::X ? 'X' : 'O', x, y);
+
+        Command cmd{};
+        cmd.type = CommandType::NETWORK_MOVE;
+        cmd.x = x;
+        cmd.y = y;
+        cmd.mark = mark;
+        cmd.digest = packet.data.value("digest", uint64_t{0});
+        cmd.sequence = packet.data.value("sequence", 0u);
+        commandInputQueue.enqueue(cmd);
+
+    // GAME_RESET: Opponent reset the game
+    } else if (packet.type == PacketType::GAME_RESET) {
+        printf("[NETWORK] Client received reset (not echoing)\n");
+        Command cmd;
+        cmd.type = CommandType::RESET_GAME;
+        cmd.fromNetwork = true;
+        cmd.sequence = packet.data.value("sequence", 0u);
+        commandInputQueue.enqueue(cmd);
+
+    // CHAT_MESSAGE: A coalesced batch (or the history) of one room
+    } else if (packet.type == PacketType::CHAT_MESSAGE) {
+        for (const auto& line : ChatRelay::parse(packet)) {
+            incomingChat.enqueue(line);
+        }
+
+    // PLAYER_JOINED: Presence snapshot or delta
+    } else if (packet.type == PacketType::PLAYER_JOINED) {
+        handlePresencePacket(packet);
+
+    // MOVE_REJECTED: The server refused our move request (a state resync follows)
+    } else if (packet.type == PacketType::MOVE_REJECTED) {
+        printf("[NETWORK] Move request #%u rejected\n", packet.data.value("sequence", 0u));
+        Command cmd{};
+        cmd.type = CommandType::MOVE_REJECTED;
+        cmd.sequence = packet.data.value("sequence", 0u);
+        commandInputQueue.enqueue(cmd);
+    }
+}
+
 /*-----------------------------------------------------------------------------
  *                          CLEANUP
 *---------------------------------------------------------------------------*/
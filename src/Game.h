@@ -1,13 +1,19 @@
 #pragma once
 
 #include "Board.h"
+#include "Chat.h"
 #include "NetworkManager.h"
+#include "Presence.h"
 #include "MainMenu.h"
+#include "CooperativeSearch.h"
+#include "HintAnalyzer.h"
+#include "RoomMigration.h"
 #include <SDL3/SDL.h>
 #include <imgui.h>
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <deque>
 #include <moodycamel/concurrentqueue.h>
 
 // Commands for inter-thread communication
@@ -17,7 +23,11 @@ enum class CommandType {
     NETWORK_MOVE,
     NETWORK_RESET,
     SYNC_STATE_REQUEST,
-    SYNC_STATE_RECEIVED
+    SYNC_STATE_RECEIVED,
+    MOVE_REJECTED,
+    MIGRATE_ROOM,   // Server: freeze the room and hand it to the server on "port"
+    ADOPT_ROOM,     // Server: carry on with a room another server handed over
+    SEAT_ASSIGNED   // Client: the server seated us as "mark" (EMPTY to spectate)
 };
 
 enum class GameState {
@@ -44,9 +54,9 @@ struct ConnectionState {
     bool isConnected;
     bool isReconnecting = false;
     int reconnectAttempts = 0;
-    int maxReconnectAttempts = 3;
+    int maxReconnectAttempts = 5;
     std::chrono::steady_clock::time_point lastReconnectAttempt;
-    std::chrono::milliseconds reconnectDelay{3000}; // 3 seconds
+    std::chrono::milliseconds reconnectDelay{1000}; // Dead peers are detected within a second, so retry quickly
 };
 
 struct Command {
@@ -54,10 +64,15 @@ struct Command {
     int x, y;
     TileState mark;
     bool fromNetwork = false;
+    uint64_t digest = 0;    // NETWORK_MOVE: sender's state digest after the move (0 = not sent)
+    uint32_t sequence = 0;  // Server-assigned sequence number (requests: the number expected next)
+    uint32_t position = 0;  // SYNC_STATE_RECEIVED, ADOPT_ROOM: PositionCodec index of the board
+    uint16_t port = 0;      // MIGRATE_ROOM: game port of the server taking the room over
+    HSteamNetConnection connection = k_HSteamNetConnection_Invalid;  // Peer the command came from / is for
 };
 
 struct GameStateSnapshot {
-    std::array<std::array<TileState, 3>, 3> boardState;
+    uint32_t position = 0;      // PositionCodec index of the board
     TileState currentPlayer;
     GameResult result;
     bool isMyTurn;
@@ -87,7 +102,8 @@ private:
     SDL_Renderer* renderer;
     bool show_demo_window = true;
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
-    std::unique_ptr<Board> board;
+    std::unique_ptr<Board> board;           // Logic thread while a game runs
+    std::unique_ptr<Board> renderBoard;     // Render thread: the latest GameStateSnapshot, decoded
 
     // ImGui (persistent)
     ImGuiContext* imguiContext;
@@ -103,9 +119,14 @@ private:
     uint16_t port;
     std::string serverAddress;
 
+    // Resume token from the last session as a client, for reclaiming the seat on rejoin
+    std::string resumeToken;
+    std::string resumeServer;   // "address:port" it was issued by
+
     // Connection tracking
     ConnectionState connectionState;
     std::atomic<bool> clientDisconnected{false};
+    std::atomic<bool> returnToMenu{false};      // Network -> render: reconnecting gave up
 
     // Threading
     std::thread logicThread;
@@ -126,9 +147,77 @@ private:
     static const int MESSAGE_DURATION_MS = 5000; // 5 seconds
 
     // Game state
-    TileState myMark; // X or O
+    std::atomic<TileState> myMark; // X or O, EMPTY to spectate; every thread reads it
     TileState currentTurn;
 
+    // Bot (local game): searched on the logic thread in small slices
+    static const int BOT_NODES_PER_SLICE = 2000;
+    static const int BOT_TIME_BUDGET_MS = 500;
+    bool vsBot = false;
+    TileState botMark = TileState::O;
+    std::unique_ptr<CooperativeSearch> botSearch;
+    bool botMovePending = false;
+
+    // Server-authoritative move pipeline (logic thread only). Every state change the server
+    // accepts gets the next sequence number; clients apply them strictly in order.
+    static constexpr uint32_t FULL_STATE = UINT32_MAX;  // SYNC_STATE_REQUEST: full state, not a move delta
+    uint32_t moveSequence = 0;           // Last applied sequence number
+    uint32_t resetSequence = 0;          // Sequence number of the last reset
+    std::vector<NetworkPacket> moveLog;  // Server: fanned-out moves since the last reset
+
+    // Client-side prediction (logic thread only): the board shows the server-confirmed
+    // state plus the client's own moves the server has not acknowledged yet
+    struct PendingMove {
+        uint32_t sequence;
+        int x, y;
+        TileState mark;
+    };
+    Board confirmedBoard;
+    TileState confirmedPlayer = TileState::X;
+    GameResult confirmedResult = GameResult::IN_PROGRESS;
+    std::deque<PendingMove> pendingMoves;
+
+    // Chat: the relay belongs to the server's network thread; the render thread only
+    // talks to the network thread through the two queues
+    static const int CHAT_LOG_LINES = 100;
+    std::unique_ptr<ChatRelay> chatRelay;
+    moodycamel::ConcurrentQueue<ChatLine> outgoingChat;   // Render -> network (room, text)
+    moodycamel::ConcurrentQueue<ChatLine> incomingChat;   // Network -> render
+    std::deque<ChatLine> chatLog;                         // Render thread only
+    char chatInput[ChatRelay::MAX_TEXT_LENGTH + 1] = {};
+    bool chatInLobby = false;
+
+    // Lobby presence: the service (server) or view (client) belongs to the network thread,
+    // which flushes coalesced changes once per presence tick; the render thread only sees
+    // copies of the member list and publishes its own status through localStatus
+    static const int PRESENCE_TICK_MS = 100;
+    std::unique_ptr<PresenceService> presenceService;
+    PresenceView presenceView;
+    moodycamel::ConcurrentQueue<std::vector<PresenceMember>> presenceUpdates;  // Network -> render
+    std::vector<PresenceMember> presenceMembers;                               // Render thread only
+    std::atomic<PresenceStatus> localStatus{PresenceStatus::ONLINE};           // Render -> network
+    PresenceStatus sentStatus = PresenceStatus::ONLINE;                        // Client: last status sent
+    std::chrono::steady_clock::time_point nextPresenceTick;
+
+    // Room migration to another server process on this machine: the logic thread freezes
+    // the room and checkpoints it, the network thread hands it over and sends the clients
+    // on, and the host rejoins the room there as a client, keeping its mark
+    static const int MIGRATION_FLUSH_MS = 250;                     // Redirects delivered before the server stops
+    std::atomic<bool> roomFrozen{false};                           // No moves or resets while handing over
+    char migrationPortBuffer[8] = {};                              // Render thread (UI input)
+    std::unique_ptr<MigrationListener> migrationListener;          // Server: network thread
+    moodycamel::ConcurrentQueue<std::pair<uint16_t, RoomCheckpoint>> outgoingRooms;  // Logic -> network
+    std::unique_ptr<MigrationTransfer> outgoingTransfer;           // Server: network thread, handover in flight
+    std::string outgoingHostToken;                                 // Network thread: the host's seat in it
+    uint16_t migrationFlushPort = 0;                               // Network thread: handed over, redirects going out
+    std::chrono::steady_clock::time_point migrationFlushUntil;
+    std::atomic<uint16_t> migratedPort{0};                         // Network -> render: the room has moved
+    std::string migrationToken;                                    // Host's seat there (read after the join)
+
+    // Hint overlay (per-cell heatmap, computed on the analyzer's worker thread)
+    bool showHints = false;
+    std::unique_ptr<HintAnalyzer> hintAnalyzer;
+
     // Thread functions
     void logicThreadFunc();
     void networkThreadFunc();
@@ -138,7 +227,7 @@ private:
 
     // Methods
     bool initialize();
-    bool startGame(bool asServer, const std::string& serverAddr, uint16_t port);
+    bool startGame(bool asServer, const std::string& serverAddr, uint16_t port, bool againstBot = false);
     void stopGame();
 
     void handleEvent(SDL_Event* event);
@@ -147,16 +236,44 @@ private:
     void renderGame();
     void renderImGui();
     void renderMessages();
+    void renderChat();
     void cleanup();
 
     void handleKeyPress(SDL_Keycode key);
+    void setShowHints(bool enabled);
     void handleMouseClick(int mouseX, int mouseY);
 
     // Message helpers
     void addMessage(const std::string& text, MessageType type = MessageType::INFO);
     void updateMessages();
 
-    // Reconnection
+    // Reconnection (network thread)
     void handleDisconnection();
+    void updateReconnect();
+
+    // Move pipeline (logic thread)
+    bool applyMove(int x, int y, TileState mark, TileState& currentPlayer, GameResult& result);
+    void broadcastMove(int x, int y, TileState mark, TileState currentPlayer);
+    void sendState(HSteamNetConnection connection, uint32_t sinceSequence, TileState currentPlayer, GameResult result);
+    void resetState(TileState& currentPlayer, GameResult& result);
+    void rebuildPrediction(TileState& currentPlayer, GameResult& result);
+    void publishState(TileState currentPlayer, GameResult result);
+
+    // Chat (network thread)
+    void updateChat();
+
+    // Incoming packets (network thread); a malformed one throws json::exception
+    void handleServerPacket(NetworkPacket& packet);
+    void handleClientPacket(NetworkPacket& packet);
+
+    // Presence (network thread)
+    void handlePresencePacket(const NetworkPacket& packet);
+    void updatePresence();
+
+    // Room migration (network thread)
+    void updateMigration();
+
+    // Bot
+    bool updateBot(TileState currentPlayer, GameResult result);
 };
 
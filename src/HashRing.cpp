@@ -0,0 +1,64 @@
+/*******************************************************************************
+ * HashRing.cpp
+ *
+ * Consistent-hash ring placing rooms on the game servers behind the router.
+ *
+ * Architecture:
+ * - The ring is a sorted vector of (hash, node) points; a key's owner is one
+ *   binary search away, wrapping around to the first point past the end, and
+ *   the rest of its preference list follows the ring from there
+ * - Virtual node i of a node hashes "<node>#<i>", so every router process
+ *   builds the same ring from the same nodes, in any order
+ ******************************************************************************/
+
+#include "HashRing.h"
+#include <algorithm>
+#include <string>
+
+void HashRing::add(uint16_t node) {
+    if (contains(node)) {
+        return;
+    }
+    nodes.push_back(node);
+    for (int i = 0; i < VIRTUAL_NODES; i++) {
+        points.emplace_back(hash(std::to_string(node) + "#" + std::to_string(i)), node);
+    }
+    std::sort(points.begin(), points.end());
+}
+
+void HashRing::remove(uint16_t node) {
+    nodes.erase(std::remove(nodes.begin(), nodes.end(), node), nodes.end());
+    points.erase(std::remove_if(points.begin(), points.end(),
+                                [node](const auto& point) { return point.second == node; }),
+                 points.end());
+}
+
+bool HashRing::contains(uint16_t node) const {
+    return std::find(nodes.begin(), nodes.end(), node) != nodes.end();
+}
+
+std::vector<uint16_t> HashRing::preference(std::string_view key) const {
+    std::vector<uint16_t> order;
+    uint64_t keyHash = hash(key);
+    auto owner = std::lower_bound(points.begin(), points.end(), keyHash,
+                                  [](const auto& point, uint64_t value) { return point.first < value; });
+    size_t first = static_cast<size_t>(owner - points.begin());
+    for (size_t i = 0; i < points.size() && order.size() < nodes.size(); i++) {
+        uint16_t node = points[(first + i) % points.size()].second;
+        if (std::find(order.begin(), order.end(), node) == order.end()) {
+            order.push_back(node);
+        }
+    }
+    return order;
+}
+
+uint64_t HashRing::hash(std::string_view bytes) {
+    uint64_t value = 0xcbf29ce484222325ULL;
+    for (unsigned char byte : bytes) {
+        value = (value ^ byte) * 0x100000001b3ULL;
+    }
+    // splitmix64 finalizer
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Consistent hashing of keys (room names) onto nodes (game server ports). Each node
+// sits on the ring at VIRTUAL_NODES points and a key belongs to the node of the first
+// point at or after the key's hash, so adding or removing a node only moves the keys
+// that node gains or loses (about 1/n of them), and the keys spread evenly.
+class HashRing {
+public:
+    static constexpr int VIRTUAL_NODES = 128;
+
+    void add(uint16_t node);
+    void remove(uint16_t node);
+    bool contains(uint16_t node) const;
+
+    // Every node, in the order the key should try them: the node owning the key first,
+    // then the nodes of the points after it. Empty while the ring is.
+    std::vector<uint16_t> preference(std::string_view key) const;
+
+    const std::vector<uint16_t>& getNodes() const { return nodes; }
+
+    // 64-bit FNV-1a with a final avalanche, so similar names land far apart
+    static uint64_t hash(std::string_view bytes);
+
+private:
+    std::vector<std::pair<uint64_t, uint16_t>> points;     // Sorted by hash
+    std::vector<uint16_t> nodes;
+};
@@ -0,0 +1,181 @@
+/*******************************************************************************
+ * HealthCheck.cpp
+ *
+ * Health pings between the router and the game servers behind it.
+ *
+ * Architecture:
+ * - A game server listens for TCP on 127.0.0.1 at its game port's number; its
+ *   network thread takes probes on each update and answers each with its
+ *   status, a few dozen bytes that go out in one non-blocking send
+ * - The router connects without blocking and reads until the server hangs
+ *   up, so the status needs no framing; a refused connection shows up on the
+ *   first read, a silent one after TIMEOUT_MS
+ ******************************************************************************/
+
+#include "HealthCheck.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace {
+
+#ifdef _WIN32
+constexpr HealthSocket NO_SOCKET = INVALID_SOCKET;
+constexpr int SEND_FLAGS = 0;
+
+void closeSocket(HealthSocket socket) {
+    closesocket(socket);
+}
+
+void setNonBlocking(HealthSocket socket) {
+    u_long mode = 1;
+    ioctlsocket(socket, FIONBIO, &mode);
+}
+
+// Not done yet, as opposed to failed
+bool inProgress() {
+    int error = WSAGetLastError();
+    return error == WSAEWOULDBLOCK || error == WSAEINPROGRESS || error == WSAENOTCONN;
+}
+#else
+constexpr HealthSocket NO_SOCKET = -1;
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+
+void closeSocket(HealthSocket socket) {
+    ::close(socket);
+}
+
+void setNonBlocking(HealthSocket socket) {
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+}
+
+bool inProgress() {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS || errno == ENOTCONN || errno == EINTR;
+}
+#endif
+
+sockaddr_in loopback(uint16_t port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+} // namespace
+
+/*-----------------------------------------------------------------------------
+ *                              Server Side
+ *---------------------------------------------------------------------------*/
+
+HealthEndpoint::HealthEndpoint(HealthSocket listenSocket)
+    : listenSocket(listenSocket) {
+}
+
+HealthEndpoint::~HealthEndpoint() {
+    for (HealthSocket probe : probes) {
+        closeSocket(probe);
+    }
+    closeSocket(listenSocket);
+}
+
+std::unique_ptr<HealthEndpoint> HealthEndpoint::create(uint16_t port) {
+    HealthSocket listenSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket == NO_SOCKET) {
+        return nullptr;
+    }
+#ifndef _WIN32
+    // Probes are hung up on from this end, so a restarted server would find the port in TIME_WAIT
+    int reuse = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+
+    sockaddr_in address = loopback(port);
+    if (::bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenSocket, 8) != 0) {
+        closeSocket(listenSocket);
+        return nullptr;
+    }
+    setNonBlocking(listenSocket);
+    return std::unique_ptr<HealthEndpoint>(new HealthEndpoint(listenSocket));
+}
+
+bool HealthEndpoint::acceptProbes() {
+    while (true) {
+        HealthSocket probe = ::accept(listenSocket, nullptr, nullptr);
+        if (probe == NO_SOCKET) {
+            break;
+        }
+        setNonBlocking(probe);
+        probes.push_back(probe);
+    }
+    return !probes.empty();
+}
+
+void HealthEndpoint::answer(const json& status) {
+    std::string bytes = status.dump();
+    for (HealthSocket probe : probes) {
+        ::send(probe, bytes.data(), static_cast<int>(bytes.size()), SEND_FLAGS);
+        closeSocket(probe);
+    }
+    probes.clear();
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Router Side
+ *---------------------------------------------------------------------------*/
+
+HealthProbe::HealthProbe(HealthSocket socket)
+    : socket(socket)
+    , deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(TIMEOUT_MS)) {
+}
+
+HealthProbe::~HealthProbe() {
+    closeSocket(socket);
+}
+
+std::unique_ptr<HealthProbe> HealthProbe::start(uint16_t port) {
+    HealthSocket socket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (socket == NO_SOCKET) {
+        return nullptr;
+    }
+    setNonBlocking(socket);
+
+    // On loopback a connect nobody listens for is usually refused at once
+    sockaddr_in address = loopback(port);
+    if (::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 && !inProgress()) {
+        closeSocket(socket);
+        return nullptr;
+    }
+    return std::unique_ptr<HealthProbe>(new HealthProbe(socket));
+}
+
+HealthProbe::Status HealthProbe::poll(json& status) {
+    char chunk[1024];
+    while (true) {
+        auto count = ::recv(socket, chunk, static_cast<int>(sizeof(chunk)), 0);
+        if (count > 0) {
+            received.append(chunk, static_cast<size_t>(count));
+            if (received.size() > MAX_STATUS_BYTES) {
+                return Status::DOWN;
+            }
+        } else if (count == 0) {
+            status = json::parse(received, nullptr, false);
+            return status.is_object() ? Status::UP : Status::DOWN;
+        } else if (inProgress()) {
+            return std::chrono::steady_clock::now() < deadline ? Status::PENDING : Status::DOWN;
+        } else {
+            return Status::DOWN;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Liveness and load of a game server, for the router in front of it. The server listens
+// for TCP on the loopback interface under its game port's number (the game itself is
+// UDP); a probe connects, reads one JSON object and is hung up on:
+//
+//   { "room": name or "", "clients": n, "held": n, "capacity": n, "movedTo": port or 0 }
+//
+// A server that answers is up; a port that refuses or stays silent is down, whatever
+// else may have it bound. Neither end blocks: both are polled from loops with other work.
+#ifdef _WIN32
+using HealthSocket = uintptr_t;
+#else
+using HealthSocket = int;
+#endif
+
+class HealthEndpoint {
+public:
+    ~HealthEndpoint();
+
+    HealthEndpoint(const HealthEndpoint&) = delete;
+    HealthEndpoint& operator=(const HealthEndpoint&) = delete;
+
+    // nullptr if the port is taken
+    static std::unique_ptr<HealthEndpoint> create(uint16_t port);
+
+    // Takes on the probes that connected since the last call; true if any wait for answer()
+    bool acceptProbes();
+    void answer(const nlohmann::json& status);
+
+private:
+    explicit HealthEndpoint(HealthSocket listenSocket);
+
+    HealthSocket listenSocket;
+    std::vector<HealthSocket> probes;
+};
+
+class HealthProbe {
+public:
+    enum class Status { PENDING, UP, DOWN };
+
+    static constexpr int TIMEOUT_MS = 500;
+    static constexpr size_t MAX_STATUS_BYTES = 4096;
+
+    ~HealthProbe();
+
+    HealthProbe(const HealthProbe&) = delete;
+    HealthProbe& operator=(const HealthProbe&) = delete;
+
+    // Starts connecting to the server on port; nullptr if it refused at once (down)
+    static std::unique_ptr<HealthProbe> start(uint16_t port);
+
+    // PENDING until the server has answered (UP, with its status) or failed to within TIMEOUT_MS
+    Status poll(nlohmann::json& status);
+
+private:
+    explicit HealthProbe(HealthSocket socket);
+
+    HealthSocket socket;
+    std::string received;
+    std::chrono::steady_clock::time_point deadline;
+};
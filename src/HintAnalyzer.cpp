@@ -0,0 +1,166 @@
+/*******************************************************************************
+ * HintAnalyzer.cpp
+ *
+ * Per-cell evaluation heatmap for the hint overlay, computed off the render thread.
+ *
+ * Architecture:
+ * - The render thread submits each new GameStateSnapshot; the worker thread
+ *   searches every empty cell (one SearchEngine call per candidate move)
+ * - Submitting a new position bumps a generation counter and stops the running
+ *   search, so stale work is dropped after at most one search node batch
+ * - The transposition table is shared across positions and never cleared, so
+ *   the position after a move reuses almost all of the previous analysis
+ * - Hints are published cell by cell, so the overlay fills in progressively
+ ******************************************************************************/
+
+#include "HintAnalyzer.h"
+#include "PositionCodec.h"
+#include <algorithm>
+
+namespace {
+
+TileState opponentOf(TileState side) {
+    return side == TileState::X ? TileState::O : TileState::X;
+}
+
+} // namespace
+
+HintAnalyzer::HintAnalyzer(std::shared_ptr<TranspositionTable> table)
+    : table(table ? std::move(table) : std::make_shared<TranspositionTable>(4))
+    , engine(SearchConfig(), this->table) {
+    worker = std::thread(&HintAnalyzer::workerFunc, this);
+}
+
+HintAnalyzer::~HintAnalyzer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    engine.stop();
+    wakeup.notify_all();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+/**
+ * Queues a position for analysis, cancelling any analysis in progress.
+ *
+ * @param position The board as a PositionCodec index
+ * @param toMove The side to move (hints are from this side's point of view)
+ */
+void HintAnalyzer::submit(uint32_t position, TileState toMove) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!PositionCodec::decode(position, pending.board)) {
+        pending.board.resetBoard();
+    }
+    pending.toMove = toMove;
+    pending.generation = ++generation;
+    hasPending = true;
+    hints = HintGrid{};
+    stats = SearchResult();
+
+    engine.stop();
+    wakeup.notify_one();
+}
+
+/**
+ * Cancels any analysis and hides all hints.
+ */
+void HintAnalyzer::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++generation;
+    hasPending = false;
+    hints = HintGrid{};
+    stats = SearchResult();
+    engine.stop();
+}
+
+HintGrid HintAnalyzer::getHints() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hints;
+}
+
+SearchResult HintAnalyzer::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Worker Thread
+ *---------------------------------------------------------------------------*/
+
+void HintAnalyzer::workerFunc() {
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeup.wait(lock, [this] { return hasPending || !running; });
+            if (!running) {
+                return;
+            }
+            request = pending;
+            hasPending = false;
+        }
+
+        busy = true;
+        analyze(request);
+        busy = false;
+    }
+}
+
+/**
+ * Scores every empty cell by searching the position after playing it.
+ * Stops as soon as a newer position is submitted.
+ */
+void HintAnalyzer::analyze(const Request& request) {
+    Board board = request.board;
+    if (board.checkWinner() != GameResult::IN_PROGRESS) {
+        return;
+    }
+
+    int size = board.getSize();
+    TileState opponent = opponentOf(request.toMove);
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            if (generation != request.generation || !running) {
+                return;
+            }
+            if (board.getTile(x, y) != TileState::EMPTY) {
+                continue;
+            }
+
+            board.setTile(x, y, request.toMove);
+            GameResult result = board.checkWinner();
+            SearchResult search;
+            int score = 0;
+
+            if (result == GameResult::DRAW) {
+                score = 0;
+            } else if (result != GameResult::IN_PROGRESS) {
+                score = SearchEngine::WIN_SCORE - 1;
+            } else {
+                search = engine.findBestMove(board, opponent);
+                score = -search.score;
+            }
+            board.clearTile(x, y);
+
+            // Publish unless the search was cut short by a newer position
+            std::lock_guard<std::mutex> lock(mutex);
+            if (generation != request.generation) {
+                return;
+            }
+            hints[y][x].valid = true;
+            hints[y][x].score = score;
+            stats.nodes += search.nodes;
+            stats.cutoffs += search.cutoffs;
+            stats.firstMoveCutoffs += search.firstMoveCutoffs;
+            stats.tableStats += search.tableStats;
+            stats.elapsedMs += search.elapsedMs;
+            stats.depth = std::max(stats.depth, search.depth);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Board.h"
+#include "SearchEngine.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Background worker that evaluates every empty cell of the latest submitted position
+// for the hint overlay. A new submission cancels the evaluation in progress; the
+// transposition table is kept between positions, so follow-up positions (one move
+// later) are mostly answered from the table.
+class HintAnalyzer {
+public:
+    explicit HintAnalyzer(std::shared_ptr<TranspositionTable> table = nullptr);
+    ~HintAnalyzer();
+
+    HintAnalyzer(const HintAnalyzer&) = delete;
+    HintAnalyzer& operator=(const HintAnalyzer&) = delete;
+
+    // position is a PositionCodec index
+    void submit(uint32_t position, TileState toMove);
+    void clear();
+
+    // Copies the hints of the latest submitted position (may be partial while computing)
+    HintGrid getHints() const;
+    // Search statistics summed over the cells analyzed so far for the latest position
+    SearchResult getStats() const;
+    bool isBusy() const { return busy; }
+
+private:
+    struct Request {
+        Board board;
+        TileState toMove = TileState::X;
+        uint64_t generation = 0;
+    };
+
+    std::shared_ptr<TranspositionTable> table;
+    SearchEngine engine;
+
+    std::thread worker;
+    std::atomic<bool> running{true};
+    std::atomic<bool> busy{false};
+    std::atomic<uint64_t> generation{0};
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    Request pending;
+    bool hasPending = false;
+    HintGrid hints{};
+    SearchResult stats;
+
+    void workerFunc();
+    void analyze(const Request& request);
+};
@@ -0,0 +1,253 @@
+/*******************************************************************************
+ * HostResolver.cpp
+ *
+ * Asynchronous host name resolution for GameClient.
+ *
+ * Architecture:
+ * - One worker thread runs the blocking lookups in request order; resolve()
+ *   only touches the cache and the request queue, so it never blocks on the
+ *   network
+ * - The cache holds futures: a running lookup is an entry that never expires,
+ *   so a second request for the same host waits on the first query instead
+ *   of starting another
+ * - Addresses are returned IPv4 first, which is what the server listens on
+ *   everywhere; IPv6 comes second
+ ******************************************************************************/
+
+#include "HostResolver.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#endif
+
+namespace {
+
+// Numeric IPv4 or IPv6 address
+bool parseNumeric(const std::string& text, ResolvedAddress& address) {
+    address = ResolvedAddress();
+    if (inet_pton(AF_INET, text.c_str(), address.bytes.data()) == 1) {
+        return true;
+    }
+    address.ipv6 = true;
+    return inet_pton(AF_INET6, text.c_str(), address.bytes.data()) == 1;
+}
+
+void sortIPv4First(std::vector<ResolvedAddress>& addresses) {
+    std::stable_partition(addresses.begin(), addresses.end(),
+                          [](const ResolvedAddress& address) { return !address.ipv6; });
+}
+
+bool equalsIgnoreCase(const std::string& a, const std::string& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+} // namespace
+
+bool parseHostPort(const std::string& input, std::string& host, uint16_t& port) {
+    std::string portText;
+    if (!input.empty() && input.front() == '[') {
+        // [v6]:port
+        size_t close = input.find(']');
+        if (close == std::string::npos) {
+            return false;
+        }
+        host = input.substr(1, close - 1);
+        if (close + 1 < input.size()) {
+            if (input[close + 1] != ':') {
+                return false;
+            }
+            portText = input.substr(close + 2);
+        }
+    } else if (std::count(input.begin(), input.end(), ':') == 1) {
+        // host:port (more than one colon is a bare IPv6 literal)
+        size_t colon = input.find(':');
+        host = input.substr(0, colon);
+        portText = input.substr(colon + 1);
+    } else {
+        host = input;
+    }
+
+    if (host.empty()) {
+        return false;
+    }
+    if (!portText.empty()) {
+        char* end = nullptr;
+        long value = std::strtol(portText.c_str(), &end, 10);
+        if (*end != '\0' || value < 1 || value > 65535) {
+            return false;
+        }
+        port = static_cast<uint16_t>(value);
+    }
+    return true;
+}
+
+HostResolver::HostResolver(std::string hostsFile)
+    : hostsFile(std::move(hostsFile))
+    , worker(&HostResolver::workerFunc, this) {
+}
+
+HostResolver::~HostResolver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+HostResolver& HostResolver::shared() {
+    static HostResolver instance(std::getenv("MA1_HOSTS_FILE") ? std::getenv("MA1_HOSTS_FILE") : "");
+    return instance;
+}
+
+/**
+ * Starts resolving a host, or returns the cached (or running) lookup.
+ *
+ * @param host Host name or numeric address
+ * @return The lookup; poll with wait_for(0) and get() it once ready
+ */
+std::shared_future<Resolution> HostResolver::resolve(const std::string& host) {
+    ResolvedAddress numeric;
+    if (parseNumeric(host, numeric)) {
+        std::promise<Resolution> ready;
+        ready.set_value(Resolution{{numeric}, std::string()});
+        return ready.get_future().share();
+    }
+
+    std::string key = host;
+    std::transform(key.begin(), key.end(), key.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto cached = cache.find(key);
+    if (cached != cache.end() && now < cached->second.expires) {
+        return cached->second.result;
+    }
+
+    if (cache.size() >= MAX_CACHED) {
+        std::erase_if(cache, [now](const auto& entry) { return now >= entry.second.expires; });
+    }
+
+    std::promise<Resolution> promise;
+    std::shared_future<Resolution> result = promise.get_future().share();
+    cache[key] = CacheEntry{result, Clock::time_point::max()};
+    requests.emplace_back(key, std::move(promise));
+    wakeup.notify_one();
+    return result;
+}
+
+void HostResolver::workerFunc() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeup.wait(lock, [this] { return stopping || !requests.empty(); });
+        if (stopping) {
+            break;
+        }
+
+        auto [host, promise] = std::move(requests.front());
+        requests.pop_front();
+
+        lock.unlock();
+        Resolution resolution = lookup(host);
+        lock.lock();
+
+        auto entry = cache.find(host);
+        if (entry != cache.end()) {
+            int ttlMs = resolution.addresses.empty() ? NEGATIVE_TTL_MS : CACHE_TTL_MS;
+            entry->second.expires = Clock::now() + std::chrono::milliseconds(ttlMs);
+        }
+        promise.set_value(std::move(resolution));
+    }
+
+    // Nobody is left to run these; answer them rather than break their promises
+    for (auto& [host, promise] : requests) {
+        promise.set_value(Resolution{{}, "Resolver shut down"});
+    }
+    requests.clear();
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Lookups (worker thread)
+ *---------------------------------------------------------------------------*/
+
+Resolution HostResolver::lookup(const std::string& host) const {
+    Resolution resolution;
+    if (lookupHostsFile(host, resolution)) {
+        return resolution;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* results = nullptr;
+    int status = getaddrinfo(host.c_str(), nullptr, &hints, &results);
+    if (status != 0) {
+        resolution.error = "Could not resolve " + host + ": " + gai_strerror(status);
+        return resolution;
+    }
+
+    for (addrinfo* result = results; result; result = result->ai_next) {
+        ResolvedAddress address;
+        if (result->ai_family == AF_INET) {
+            const auto* ipv4 = reinterpret_cast<const sockaddr_in*>(result->ai_addr);
+            std::memcpy(address.bytes.data(), &ipv4->sin_addr, 4);
+        } else if (result->ai_family == AF_INET6) {
+            const auto* ipv6 = reinterpret_cast<const sockaddr_in6*>(result->ai_addr);
+            address.ipv6 = true;
+            std::memcpy(address.bytes.data(), &ipv6->sin6_addr, 16);
+        } else {
+            continue;
+        }
+        resolution.addresses.push_back(address);
+    }
+    freeaddrinfo(results);
+
+    sortIPv4First(resolution.addresses);
+    if (resolution.addresses.empty()) {
+        resolution.error = "No usable address for " + host;
+    }
+    return resolution;
+}
+
+// The MA1_HOSTS_FILE override, in /etc/hosts format ("address name [aliases...] # comment")
+bool HostResolver::lookupHostsFile(const std::string& host, Resolution& resolution) const {
+    if (hostsFile.empty()) {
+        return false;
+    }
+    std::ifstream file(hostsFile);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string addressText;
+        std::string name;
+        ResolvedAddress address;
+        if (!(fields >> addressText) || !parseNumeric(addressText, address)) {
+            continue;
+        }
+        while (fields >> name) {
+            if (equalsIgnoreCase(name, host)) {
+                resolution.addresses.push_back(address);
+                break;
+            }
+        }
+    }
+    sortIPv4First(resolution.addresses);
+    return !resolution.addresses.empty();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// One address of a host
+struct ResolvedAddress {
+    bool ipv6 = false;
+    std::array<uint8_t, 16> bytes{};    // Network byte order; IPv4 uses the first 4
+};
+
+struct Resolution {
+    std::vector<ResolvedAddress> addresses;     // IPv4 first; empty if the lookup failed
+    std::string error;
+};
+
+// Splits "host", "host:port", "[v6]:port" or a bare IPv6 literal; port keeps its value if none is given.
+// Returns false if the input is empty or the port is not a number in 1-65535.
+bool parseHostPort(const std::string& input, std::string& host, uint16_t& port);
+
+// Name lookups on a background thread, so neither the UI nor the network thread ever
+// waits on DNS. Callers poll the returned future. Results are cached per host for
+// CACHE_TTL_MS (failures for NEGATIVE_TTL_MS), and concurrent lookups of one host share
+// a single query.
+//
+// Numeric addresses are answered on the spot. Names are looked up in the hosts file
+// named by MA1_HOSTS_FILE, if set (local testing without touching /etc/hosts), then
+// with getaddrinfo, which covers /etc/hosts and DNS.
+class HostResolver {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int CACHE_TTL_MS = 60000;
+    static constexpr int NEGATIVE_TTL_MS = 5000;
+    static constexpr size_t MAX_CACHED = 64;
+
+    explicit HostResolver(std::string hostsFile = std::string());
+    ~HostResolver();
+
+    HostResolver(const HostResolver&) = delete;
+    HostResolver& operator=(const HostResolver&) = delete;
+
+    // Process-wide instance, so the cache outlives individual connections
+    static HostResolver& shared();
+
+    std::shared_future<Resolution> resolve(const std::string& host);
+
+private:
+    struct CacheEntry {
+        std::shared_future<Resolution> result;
+        Clock::time_point expires;      // time_point::max() while the lookup is running
+    };
+
+    std::string hostsFile;
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::deque<std::pair<std::string, std::promise<Resolution>>> requests;
+    std::unordered_map<std::string, CacheEntry> cache;
+    bool stopping = false;
+    std::thread worker;
+
+    void workerFunc();
+    Resolution lookup(const std::string& host) const;
+    bool lookupHostsFile(const std::string& host, Resolution& resolution) const;
+};
@@ -69,7 +69,7 @@ void MainMenu::render() {
 
     // Join server section
     ImGui::Text("Join server:");
-    ImGui::InputText("IP Address", serverIPBuffer, sizeof(serverIPBuffer));
+    ImGui::InputText("Host or IP", serverIPBuffer, sizeof(serverIPBuffer));
     ImGui::InputText("Port", serverPortBuffer, sizeof(serverPortBuffer));
 
     ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.2f, 0.5f, 0.8f, 1.0f));
@@ -85,7 +85,7 @@ void MainMenu::render() {
 
         if (serverIP.empty()) {
             showError = true;
-            errorMessage = "Please enter a server IP address!";
+            errorMessage = "Please enter a server host name or IP address!";
         } else {
             choice = MenuChoice::JOIN_SERVER;
             printf("[MainMenu] Join server selected: %s:%d\n", serverIP.c_str(), serverPort);
@@ -97,6 +97,14 @@ void MainMenu::render() {
     ImGui::Separator();
     ImGui::Spacing();
 
+    // Local game against the bot (no networking)
+    if (ImGui::Button("Play vs Bot", ImVec2(-1, 40))) {
+        choice = MenuChoice::PLAY_BOT;
+        printf("[MainMenu] Local game vs bot selected.\n");
+    }
+
+    ImGui::Spacing();
+
     // Quit button
     ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.7f, 0.2f, 0.2f, 1.0f));
     ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.8f, 0.3f, 0.3f, 1.0f));
@@ -9,6 +9,7 @@ enum class MenuChoice {
     NONE,
     HOST_SERVER,
     JOIN_SERVER,
+    PLAY_BOT,
     QUIT
 };
 
@@ -7,25 +7,148 @@
  * Architecture:
  * - GameServer: Accepts up to 2 clients, broadcasts game state
  * - GameClient: Connects to server, sends/receives moves
- * - NetworkPacket: JSON-serialized messages for cross-network communication
+ * - NetworkPacket: JSON documents, sent as JSON text or MessagePack depending on
+ *   what the connection's handshake settled on (see Protocol.cpp)
+ * - Every connection has two reliable lanes: GAME (moves, state) is always
+ *   served before CHAT, so chat bursts cannot delay moves
+ * - Admission: connection requests are queued and accepted at a bounded rate
+ *   with a cap on unfinished handshakes; dropped players hold their seat for
+ *   a while and reclaim it with the resume token from their handshake
+ * - Clients resolve the server's name on HostResolver's thread and connect
+ *   from updateClient() once it is done, so connecting never blocks
+ * - Same-host clients skip UDP: when the server is on loopback, they talk
+ *   through SharedMemoryTransport's rings instead, under a handle no library
+ *   connection is using; everything above transmit() is unchanged
+ * - Heartbeats: both ends ping every heartbeatIntervalMs (unreliable, so a
+ *   ping never waits behind a backlog) and take the pong for RTT; a peer not
+ *   heard from for deadPeerMs is dropped, long before the library would
+ * - Backpressure: a client whose send queue grows past a soft budget stops
+ *   receiving chat and presence deltas, and its state updates collapse into
+ *   one catch-up (the newest full state, or a resync) sent once it drains;
+ *   past a hard budget, or behind for too long, it is disconnected
  ******************************************************************************/
 
 #include "NetworkManager.h"
+#include <steam/isteamnetworkingutils.h>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <thread>
 
 // Global callback pointers for GameNetworkingSockets
 // (Library requires static callbacks, these point to actual instances)
 static GameServer* g_GameServerCallback = nullptr;
 static GameClient* g_GameClientCallback = nullptr;
 
+namespace {
+
+// Indexed by Lane: priority (lower is served first) and weight within a priority
+const int LANE_PRIORITIES[] = {0, 1};
+const uint16 LANE_WEIGHTS[] = {1, 1};
+
+void configureLanes(ISteamNetworkingSockets* interface, HSteamNetConnection connection) {
+    EResult result = interface->ConfigureConnectionLanes(
+        connection, static_cast<int>(std::size(LANE_PRIORITIES)), LANE_PRIORITIES, LANE_WEIGHTS);
+    if (result != k_EResultOK) {
+        std::cerr << "[NETWORK] Failed to configure lanes: " << result << std::endl;
+    }
+}
+
+/**
+ * Sends serialized data reliably on a lane of a connection.
+ *
+ * @return k_EResultOK, or the reason the message was not queued
+ */
+// What may happen to a packet whose receiver is over its soft budget
+enum class BacklogPolicy {
+    SEND,       // Small and not superseded by anything: always sent
+    COLLAPSE,   // Sequenced state: superseded by the newest full state
+    DROP        // Best effort; receivers recover on their own (presence deltas carry versions)
+};
+
+BacklogPolicy backlogPolicyOf(const NetworkPacket& packet) {
+    switch (packet.type) {
+        case PacketType::GAME_STATE:
+        case PacketType::PLAYER_MOVE:
+        case PacketType::GAME_RESET:
+            return BacklogPolicy::COLLAPSE;
+        case PacketType::CHAT_MESSAGE:
+            return BacklogPolicy::DROP;
+        case PacketType::PLAYER_JOINED:
+            return packet.data.contains("members") ? BacklogPolicy::SEND : BacklogPolicy::DROP;
+        default:
+            return BacklogPolicy::SEND;
+    }
+}
+
+// Remote IP without the port (reconnects come from a new port)
+std::string addressOf(const SteamNetworkingIPAddr& address) {
+    char text[SteamNetworkingIPAddr::k_cchMaxString];
+    address.ToString(text, sizeof(text), false);
+    return text;
+}
+
+EResult sendOnLane(ISteamNetworkingSockets* interface, HSteamNetConnection connection,
+                   const std::string& serialized, Lane lane, int flags = k_nSteamNetworkingSend_Reliable) {
+    SteamNetworkingMessage_t* message = SteamNetworkingUtils()->AllocateMessage(static_cast<int>(serialized.size()));
+    std::memcpy(message->m_pData, serialized.data(), serialized.size());
+    message->m_conn = connection;
+    message->m_nFlags = flags;
+    message->m_idxLane = static_cast<uint16>(lane);
+
+    int64 result = 0;
+    interface->SendMessages(1, &message, &result);
+    return result < 0 ? static_cast<EResult>(-result) : k_EResultOK;
+}
+
+int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+NetworkPacket heartbeatPacket(const char* kind, int64_t micros) {
+    NetworkPacket packet;
+    packet.type = PacketType::HEARTBEAT;
+    packet.data[kind] = micros;
+    return packet;
+}
+
+// The library's timeouts and the status callback, for a listen socket or connection
+std::vector<SteamNetworkingConfigValue_t> connectionConfig(const NetworkTimeouts& timeouts, void* callback) {
+    std::vector<SteamNetworkingConfigValue_t> config(3);
+    config[0].SetPtr(k_ESteamNetworkingConfig_Callback_ConnectionStatusChanged, callback);
+    config[1].SetInt32(k_ESteamNetworkingConfig_TimeoutInitial, timeouts.connectTimeoutMs);
+    config[2].SetInt32(k_ESteamNetworkingConfig_TimeoutConnected, timeouts.connectedTimeoutMs);
+    return config;
+}
+
+int environmentInt(const char* name, int fallback) {
+    const char* value = std::getenv(name);
+    int parsed = value ? std::atoi(value) : 0;
+    return parsed > 0 ? parsed : fallback;
+}
+
+} // namespace
+
+NetworkTimeouts NetworkTimeouts::fromEnvironment() {
+    NetworkTimeouts timeouts;
+    timeouts.connectTimeoutMs = environmentInt("MA1_CONNECT_TIMEOUT_MS", timeouts.connectTimeoutMs);
+    timeouts.connectedTimeoutMs = environmentInt("MA1_CONNECTED_TIMEOUT_MS", timeouts.connectedTimeoutMs);
+    timeouts.heartbeatIntervalMs = environmentInt("MA1_HEARTBEAT_MS", timeouts.heartbeatIntervalMs);
+    timeouts.deadPeerMs = environmentInt("MA1_DEAD_PEER_MS", timeouts.deadPeerMs);
+    return timeouts;
+}
+
 /*******************************************************************************
  *                           SERVER IMPLEMENTATION
  ******************************************************************************/
 
-GameServer::GameServer(uint16_t port)
+GameServer::GameServer(uint16_t port, const NetworkTimeouts& timeouts)
     : listenSocket(k_HSteamListenSocket_Invalid)
     , pollGroup(k_HSteamNetPollGroup_Invalid)
     , interface(nullptr)
     , port(port)
+    , timeouts(timeouts)
     , running(false) {
 }
 
@@ -60,13 +183,11 @@ bool GameServer::startServer(uint16_t port) {
     serverAddress.Clear();
     serverAddress.m_port = port;
 
-    // Set up connection status callback
-    SteamNetworkingConfigValue_t config{};
-    config.SetPtr(k_ESteamNetworkingConfig_Callback_ConnectionStatusChanged, 
-                  (void*)SteamNetConnectionStatusChangedCallback);
+    // Connection status callback and timeouts, inherited by every accepted connection
+    auto config = connectionConfig(timeouts, (void*)SteamNetConnectionStatusChangedCallback);
 
     // Create listen socket
-    listenSocket = interface->CreateListenSocketIP(serverAddress, 1, &config);
+    listenSocket = interface->CreateListenSocketIP(serverAddress, static_cast<int>(config.size()), config.data());
     if (listenSocket == k_HSteamListenSocket_Invalid) {
         std::cerr << "[SERVER] Failed to create listen socket" << std::endl;
         return false;
@@ -79,6 +200,21 @@ bool GameServer::startServer(uint16_t port) {
         return false;
     }
 
+    // Clients on this machine connect through shared memory when they can
+    localListener = SharedMemoryListener::create(port);
+    if (localListener) {
+        std::cout << "[SERVER] Accepting local clients through shared memory" << std::endl;
+    }
+
+    // A router in front of this server pings it here
+    healthEndpoint = HealthEndpoint::create(port);
+    if (!healthEndpoint) {
+        std::cerr << "[SERVER] No health endpoint on TCP port " << port << ": a router will see this server as down"
+                  << std::endl;
+    }
+    room.clear();
+    movedTo = 0;
+
     running = true;
     std::cout << "[SERVER] Started on port " << port << std::endl;
     return true;
@@ -98,10 +234,16 @@ void GameServer::stopServer() {
     running = false;
 
     // Close all client connections gracefully
-    for (auto connection : clients) {
-        interface->CloseConnection(connection, 0, "Server shutting down", false);
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (auto connection : clients) {
+            closeConnection(connection, "Server shutting down", false);
+        }
+        clients.clear();
+        sessions.clear();
+        backlogs.clear();
+        liveness.clear();
     }
-    clients.clear();
 
     // Clean up network resources
     if (listenSocket != k_HSteamListenSocket_Invalid) {
@@ -113,6 +255,8 @@ void GameServer::stopServer() {
         interface->DestroyPollGroup(pollGroup);
         pollGroup = k_HSteamNetPollGroup_Invalid;
     }
+    localListener.reset();
+    healthEndpoint.reset();
 
     GameNetworkingSockets_Kill();
     std::cout << "[SERVER] Stopped" << std::endl;
@@ -133,6 +277,14 @@ void GameServer::updateServer() {
     
     // Receive and process incoming messages
     receiveMessages();
+    acceptLocalClients();
+    receiveLocalMessages();
+
+    admitConnections();
+    serviceHeartbeats();
+    serviceBacklogs();
+    reportAdmission();
+    answerHealthChecks();
 }
 
 /*-----------------------------------------------------------------------------
@@ -177,34 +329,276 @@ void GameServer::processMessage(HSteamNetConnection connection, const void *data
     try {
         // Deserialize JSON packet
         NetworkPacket packet = NetworkPacket::deserialize(message);
+        packet.connection = connection;
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            auto peer = liveness.find(connection);
+            if (peer != liveness.end()) {
+                peer->second.lastHeard = std::chrono::steady_clock::now();
+            }
+        }
+
+        if (packet.type == PacketType::HANDSHAKE) {
+            handleHandshake(connection, packet);
+            return;
+        }
+        if (packet.type == PacketType::HEARTBEAT) {
+            handleHeartbeat(connection, packet);
+            return;
+        }
         incomingPackets.enqueue(packet);
     } catch (const std::exception &e) {
         std::cerr << "[SERVER] Failed to process message: " << e.what() << std::endl;
     }
 }
 
+/**
+ * Answers a client's hello with the session the connection will use from now on,
+ * or rejects the client if the protocol versions do not overlap.
+ *
+ * @param connection The client
+ * @param packet The HANDSHAKE packet
+ */
+void GameServer::handleHandshake(HSteamNetConnection connection, const NetworkPacket& packet) {
+    if (!packet.data.contains("hello")) {
+        return;
+    }
+
+    std::string reason;
+    std::optional<ProtocolSession> session = Protocol::negotiate(Protocol::local(), packet.data["hello"], reason);
+
+    // Seats held for dropped players count as taken, except for the player holding the token
+    auto now = std::chrono::steady_clock::now();
+    std::string token = packet.data.value("resume", std::string());
+    bool idle;      // Nobody has finished a handshake here, and nobody is coming back
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        idle = sessions.empty() && admission.heldSeats(now) == 0;
+    }
+    bool resumed = session && admission.resume(token, now);
+    if (session && !resumed && getClientCount() - 1 + static_cast<int>(admission.heldSeats(now)) >= MAX_CLIENTS) {
+        admission.counters().refusedFull++;
+        reason = "Server full (seat held for a reconnecting player)";
+        session.reset();
+    }
+
+    // The reply is still JSON; the client accepts either codec, so no switch-over point is needed
+    NetworkPacket reply;
+    reply.type = PacketType::HANDSHAKE;
+    if (!session) {
+        printf("[SERVER] Refused connection %u: %s\n", connection, reason.c_str());
+        reply.data["reject"] = reason;
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            transmit(connection, reply.serialize(), Lane::GAME);
+            closeConnection(connection, reason.c_str(), true);
+        }
+        removeClient(connection);
+        return;
+    }
+
+    // The first player of an idle server names the room, which is how a router finds it here
+    if (idle) {
+        room = packet.data.contains("room") && packet.data["room"].is_string() ? packet.data["room"].get<std::string>()
+                                                                              : std::string();
+    }
+
+    reply.data["accept"] = Protocol::accept(*session);
+    reply.data["resume"] = resumeTokens[connection] = admission.issueResumeToken();
+    reply.data["resumed"] = resumed;
+
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    if (std::find(clients.begin(), clients.end(), connection) != clients.end()) {
+        sessions[connection] = *session;
+        liveness[connection].heartbeats = session->version >= Protocol::HEARTBEAT_VERSION;
+        if (!seats.count(connection)) {
+            seats[connection] = assignSeat(resumed ? token : std::string());
+        }
+    }
+    // The client plays the mark it is told, not one it picks
+    reply.data["seat"] = getSeat(connection);
+    transmit(connection, reply.serialize(), Lane::GAME);
+    printf("[SERVER] Connection %u: protocol v%u, %s codec, lanes %s, seat %d\n", connection, session->version,
+           Protocol::codecName(session->codec), session->lanes ? "on" : "off", getSeat(connection));
+}
+
+/**
+ * Picks the seat of a player that finished its handshake: the mark its held seat had
+ * if it resumed one, otherwise the first open mark nobody plays or holds (network thread).
+ *
+ * @param resumedToken The token whose hold the player just reclaimed, empty if none
+ * @return TileState value of the seat, 0 to spectate
+ */
+int GameServer::assignSeat(const std::string& resumedToken) {
+    auto held = heldSeatMarks.find(resumedToken);
+    if (held != heldSeatMarks.end()) {
+        int mark = held->second;
+        heldSeatMarks.erase(held);
+        return mark;
+    }
+
+    // Holds that expired free their marks
+    auto now = std::chrono::steady_clock::now();
+    std::erase_if(heldSeatMarks, [&](const auto& entry) { return !admission.isHeld(entry.first, now); });
+
+    for (int mark : openSeats) {
+        bool taken = false;
+        for (const auto& [connection, seat] : seats) {
+            taken = taken || seat == mark;
+        }
+        for (const auto& [token, seat] : heldSeatMarks) {
+            taken = taken || seat == mark;
+        }
+        if (!taken) {
+            return mark;
+        }
+    }
+    return 0;
+}
+
+void GameServer::setOpenSeats(std::vector<int> marks) {
+    openSeats = std::move(marks);
+}
+
+int GameServer::getSeat(HSteamNetConnection connection) const {
+    auto seat = seats.find(connection);
+    return seat != seats.end() ? seat->second : 0;
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Heartbeats
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Answers a client's ping, or takes the RTT from the pong to one of ours.
+ */
+void GameServer::handleHeartbeat(HSteamNetConnection connection, const NetworkPacket& packet) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    if (packet.data.contains("ping")) {
+        NetworkPacket pong = heartbeatPacket("pong", packet.data.value("ping", int64_t{0}));
+        transmit(connection, pong.serialize(sessionOf(connection).codec), Lane::GAME,
+                 k_nSteamNetworkingSend_UnreliableNoNagle);
+    } else if (packet.data.contains("pong")) {
+        auto peer = liveness.find(connection);
+        if (peer != liveness.end()) {
+            peer->second.rttMs = static_cast<int>((nowMicros() - packet.data.value("pong", int64_t{0})) / 1000);
+        }
+    }
+}
+
+/**
+ * Pings clients that are due and drops the ones that have gone quiet (network thread).
+ */
+void GameServer::serviceHeartbeats() {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<HSteamNetConnection> dead;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (auto& [connection, peer] : liveness) {
+            if (!peer.heartbeats) {
+                continue;
+            }
+            if (now - peer.lastHeard > std::chrono::milliseconds(timeouts.deadPeerMs)) {
+                dead.push_back(connection);
+            } else if (now - peer.lastPing >= std::chrono::milliseconds(timeouts.heartbeatIntervalMs)) {
+                peer.lastPing = now;
+                NetworkPacket ping = heartbeatPacket("ping", nowMicros());
+                transmit(connection, ping.serialize(sessionOf(connection).codec), Lane::GAME,
+                         k_nSteamNetworkingSend_UnreliableNoNagle);
+            }
+        }
+    }
+
+    for (auto connection : dead) {
+        printf("[SERVER] Connection %u silent for %d ms, dropping\n", connection, timeouts.deadPeerMs);
+        dropClient(connection, "Timed out");
+    }
+}
+
+int GameServer::getRttMs(HSteamNetConnection connection) const {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto peer = liveness.find(connection);
+    return peer != liveness.end() ? peer->second.rttMs : -1;
+}
+
 /*-----------------------------------------------------------------------------
  *                              Message Sending
  *---------------------------------------------------------------------------*/
 
+/**
+ * Sends encoded bytes to a client over whichever transport it is on (clientsMutex held).
+ * Shared memory delivers everything reliably and in order, so lanes and flags only
+ * matter on the network.
+ *
+ * @return k_EResultOK, or the reason the message was not queued
+ */
+EResult GameServer::transmit(HSteamNetConnection connection, const std::string& bytes, Lane lane, int flags) {
+    auto channel = localChannels.find(connection);
+    if (channel != localChannels.end()) {
+        return channel->second->send(bytes) ? k_EResultOK : k_EResultLimitExceeded;
+    }
+    return sendOnLane(interface, connection, bytes, lane, flags);
+}
+
+// clientsMutex must be held
+void GameServer::closeConnection(HSteamNetConnection connection, const char* reason, bool linger) {
+    auto channel = localChannels.find(connection);
+    if (channel != localChannels.end()) {
+        channel->second->close();
+        localChannels.erase(channel);
+        return;
+    }
+    interface->CloseConnection(connection, 0, reason, linger);
+}
+
+// clientsMutex must be held
+bool GameServer::isLocalConnection(HSteamNetConnection connection) const {
+    return localChannels.count(connection) > 0;
+}
+
+/**
+ * A handle for a new shared memory client: the next one not in use by any connection,
+ * from either transport, that the server knows about (clientsMutex held). A library
+ * connection that later arrives under a handle in use here is refused.
+ */
+HSteamNetConnection GameServer::allocateLocalConnection() {
+    while (true) {
+        HSteamNetConnection connection = nextLocalConnection++;
+        if (connection == k_HSteamNetConnection_Invalid || localChannels.count(connection) ||
+            liveness.count(connection) || sessions.count(connection) || admission.tracks(connection) ||
+            std::find(clients.begin(), clients.end(), connection) != clients.end()) {
+            continue;
+        }
+        return connection;
+    }
+}
+
+// Session of a client (the pre-handshake defaults until it has negotiated); clientsMutex must be held
+const ProtocolSession& GameServer::sessionOf(HSteamNetConnection connection) const {
+    static const ProtocolSession defaults;
+    auto it = sessions.find(connection);
+    return it != sessions.end() ? it->second : defaults;
+}
+
 /**
  * Broadcasts a NetworkPacket to all connected clients by serializing the packet to JSON and sending it reliably through the Steam networking interface.
  * Logs any errors that occur during message sending for each client connection.
  *
  * @param packet The NetworkPacket to broadcast to all clients
+ * @param lane The lane to send on
  */
-void GameServer::broadcastPacket(const NetworkPacket &packet) {
-    std::string serialized = packet.serialize();
+void GameServer::broadcastPacket(const NetworkPacket &packet, Lane lane) {
+    std::string serialized[Protocol::CODEC_COUNT];  // Each codec is encoded at most once
 
     // Send to all connected clients
+    std::lock_guard<std::mutex> lock(clientsMutex);
     for (auto conn : clients) {
-        EResult result = interface->SendMessageToConnection(
-            conn, serialized.c_str(), serialized.size(),
-            k_nSteamNetworkingSend_Reliable, nullptr);
-
-        if (result != k_EResultOK) {
-            std::cerr << "[SERVER] Failed to send to connection " << conn << std::endl;
+        const ProtocolSession& session = sessionOf(conn);
+        std::string& bytes = serialized[static_cast<size_t>(session.codec)];
+        if (bytes.empty()) {
+            bytes = packet.serialize(session.codec);
         }
+        deliver(conn, packet, bytes, session.lanes ? lane : Lane::GAME);
     }
 }
 
@@ -214,13 +608,258 @@ void GameServer::broadcastPacket(const NetworkPacket &packet) {
  *
  * @param connection The Steam networking connection handle to which the packet should be sent
  * @param packet The NetworkPacket to send to the specified client
+ * @param lane The lane to send on
  */
-void GameServer::sendPacketToClient(HSteamNetConnection connection, const NetworkPacket &packet) {
-    std::string serialized = packet.serialize();
+void GameServer::sendPacketToClient(HSteamNetConnection connection, const NetworkPacket &packet, Lane lane) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    const ProtocolSession& session = sessionOf(connection);
+    std::string serialized = packet.serialize(session.codec);
+    deliver(connection, packet, serialized, session.lanes ? lane : Lane::GAME);
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Local Clients (shared memory)
+ *---------------------------------------------------------------------------*/
 
-    interface->SendMessageToConnection(
-        connection, serialized.c_str(), serialized.size(),
-        k_nSteamNetworkingSend_Reliable, nullptr);
+/**
+ * Takes on clients that opened a shared memory channel since the last update. They are
+ * connected as soon as they are taken on, so admission's queue and rate do not apply.
+ */
+void GameServer::acceptLocalClients() {
+    if (!localListener) {
+        return;
+    }
+
+    for (auto& channel : localListener->accept()) {
+        if (getClientCount() >= MAX_CLIENTS) {
+            admission.counters().refusedFull++;
+            channel->close();
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        HSteamNetConnection connection;
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            connection = allocateLocalConnection();
+            localChannels[connection] = std::move(channel);
+            clients.push_back(connection);
+            Liveness& peer = liveness[connection];
+            peer.lastHeard = now;
+            peer.lastPing = now;
+        }
+        printf("[SERVER] Local client %u connected through shared memory\n", connection);
+        connectionEvents.enqueue(ConnectionEvent{connection, true});
+    }
+}
+
+/**
+ * Drains the shared memory channels, and drops the clients that closed theirs.
+ */
+void GameServer::receiveLocalMessages() {
+    std::vector<std::pair<HSteamNetConnection, std::shared_ptr<SharedMemoryChannel>>> channels;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        channels.assign(localChannels.begin(), localChannels.end());
+    }
+
+    std::string message;
+    for (const auto& [connection, channel] : channels) {
+        while (channel->receive(message)) {
+            processMessage(connection, message.data(), static_cast<uint32_t>(message.size()));
+        }
+        if (channel->isOpen()) {
+            continue;
+        }
+
+        bool known;     // Not if we closed it ourselves while handling its messages
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            known = localChannels.count(connection) > 0;
+        }
+        if (known) {
+            printf("[SERVER] Local client %u closed its connection\n", connection);
+            dropClient(connection, nullptr);
+        }
+    }
+}
+
+void GameServer::waitForTraffic(int timeoutMs) {
+    if (localListener) {
+        localListener->wait(timeoutMs);
+    } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Admission Control
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Accepts the connection requests admission control lets through this update. Requests
+ * admitted while all seats are taken are refused (network thread).
+ */
+void GameServer::admitConnections() {
+    for (auto connection : admission.admit(std::chrono::steady_clock::now())) {
+        if (getClientCount() >= MAX_CLIENTS) {
+            admission.counters().refusedFull++;
+            admission.closed(connection);
+            interface->CloseConnection(connection, 0, "Server full", false);
+            continue;
+        }
+
+        EResult result = interface->AcceptConnection(connection);
+        if (result != k_EResultOK) {
+            admission.closed(connection);
+            interface->CloseConnection(connection, 0, "Failed to accept", false);
+            std::cerr << "[SERVER] Failed to accept " << connection << ": " << result << std::endl;
+        }
+    }
+}
+
+// One summary line every ADMISSION_REPORT_MS, and only if something happened
+void GameServer::reportAdmission() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastAdmissionReport < std::chrono::milliseconds(ADMISSION_REPORT_MS)) {
+        return;
+    }
+    lastAdmissionReport = now;
+
+    const AdmissionControl::Counters& counters = admission.counters();
+    if (counters == reportedCounters) {
+        return;
+    }
+    reportedCounters = counters;
+    printf("[SERVER] Admission: requested=%llu admitted=%llu connected=%llu busy=%llu full=%llu "
+           "abandoned=%llu resumed=%llu disconnected=%llu | queued=%zu handshaking=%zu clients=%d/%d\n",
+           static_cast<unsigned long long>(counters.requested),
+           static_cast<unsigned long long>(counters.admitted),
+           static_cast<unsigned long long>(counters.connected),
+           static_cast<unsigned long long>(counters.refusedBusy),
+           static_cast<unsigned long long>(counters.refusedFull),
+           static_cast<unsigned long long>(counters.abandoned),
+           static_cast<unsigned long long>(counters.resumed),
+           static_cast<unsigned long long>(counters.disconnected),
+           admission.queued(), admission.handshaking(), getClientCount(), MAX_CLIENTS);
+}
+
+/**
+ * Answers the router's health pings with this server's room and load. The room is
+ * only the players' while some are here or holding a seat; the router goes by that.
+ */
+void GameServer::answerHealthChecks() {
+    if (!healthEndpoint || !healthEndpoint->acceptProbes()) {
+        return;
+    }
+    healthEndpoint->answer({{"room", room},
+                            {"clients", getClientCount()},
+                            {"held", admission.heldSeats(std::chrono::steady_clock::now())},
+                            {"capacity", MAX_CLIENTS},
+                            {"movedTo", movedTo}});
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Backpressure
+ *---------------------------------------------------------------------------*/
+
+int64_t GameServer::pendingBytes(HSteamNetConnection connection) const {
+    auto channel = localChannels.find(connection);
+    if (channel != localChannels.end()) {
+        return channel->second->pendingBytes();
+    }
+
+    SteamNetConnectionRealTimeStatus_t status{};
+    if (interface->GetConnectionRealTimeStatus(connection, &status, 0, nullptr) != k_EResultOK) {
+        return 0;
+    }
+    return static_cast<int64_t>(status.m_cbPendingReliable) + status.m_cbSentUnackedReliable;
+}
+
+/**
+ * Sends an encoded packet to a client unless the client is behind (clientsMutex held).
+ * While a client is over its soft budget, droppable packets are discarded and state
+ * updates are collapsed; serviceBacklogs() catches it up once it has drained.
+ *
+ * @param connection The client
+ * @param packet The packet, for its backlog policy
+ * @param bytes The packet encoded with the client's codec
+ * @param lane The lane to send on
+ */
+void GameServer::deliver(HSteamNetConnection connection, const NetworkPacket& packet, const std::string& bytes, Lane lane) {
+    BacklogPolicy policy = backlogPolicyOf(packet);
+    if (policy != BacklogPolicy::SEND) {
+        Backlog& backlog = backlogs[connection];
+        if (backlog.holding || pendingBytes(connection) > SOFT_PENDING_BYTES) {
+            if (policy == BacklogPolicy::DROP) {
+                return;
+            }
+            if (!backlog.holding) {
+                printf("[SERVER] Connection %u is falling behind, holding back state updates\n", connection);
+                backlog.holding = true;
+                backlog.since = std::chrono::steady_clock::now();
+            }
+            if (packet.type == PacketType::GAME_STATE) {
+                backlog.latestState = bytes;
+                backlog.latestLane = lane;
+                backlog.deltasDropped = false;
+            } else {
+                backlog.deltasDropped = true;
+            }
+            return;
+        }
+    }
+
+    EResult result = transmit(connection, bytes, lane);
+    if (result != k_EResultOK) {
+        std::cerr << "[SERVER] Failed to send to connection " << connection << ": " << result << std::endl;
+    }
+}
+
+/**
+ * Catches up clients that have drained below half their soft budget, and disconnects
+ * clients that are over the hard budget or have been behind for too long (network thread).
+ */
+void GameServer::serviceBacklogs() {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<HSteamNetConnection> slowConsumers;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (auto connection : clients) {
+            int64_t pending = pendingBytes(connection);
+            auto it = backlogs.find(connection);
+            bool holding = it != backlogs.end() && it->second.holding;
+
+            if (pending > HARD_PENDING_BYTES ||
+                (holding && now - it->second.since > std::chrono::milliseconds(SLOW_CONSUMER_TIMEOUT_MS))) {
+                slowConsumers.push_back(connection);
+            } else if (holding && pending <= SOFT_PENDING_BYTES / 2) {
+                Backlog backlog = std::move(it->second);
+                backlogs.erase(it);
+                if (backlog.deltasDropped) {
+                    // Only the game knows the full state: ask it, as if the client had
+                    NetworkPacket resync;
+                    resync.type = PacketType::RESYNC_REQUEST;
+                    resync.data = json::object();
+                    resync.connection = connection;
+                    incomingPackets.enqueue(resync);
+                } else if (!backlog.latestState.empty()) {
+                    transmit(connection, backlog.latestState, backlog.latestLane);
+                }
+                printf("[SERVER] Connection %u caught up\n", connection);
+            }
+        }
+    }
+
+    for (auto connection : slowConsumers) {
+        printf("[SERVER] Disconnecting slow consumer %u\n", connection);
+        dropClient(connection, "Too far behind");
+    }
+}
+
+int GameServer::getClientCount() const {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    return static_cast<int>(clients.size());
 }
 
 /*-----------------------------------------------------------------------------
@@ -247,56 +886,55 @@ void GameServer::SteamNetConnectionStatusChangedCallback(SteamNetConnectionStatu
  * @param info Pointer to the SteamNetConnectionStatusChangedCallback_t structure containing information about the connection status change event
  */
 void GameServer::onConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t *info) {
-    printf("[SERVER] Connection state=%d, handle=%d\n", 
-           info->m_info.m_eState, info->m_hConn);
+    HSteamNetConnection connection = info->m_hConn;
+    auto now = std::chrono::steady_clock::now();
 
     switch (info->m_info.m_eState) {
         case k_ESteamNetworkingConnectionState_None:
-            std::cout << "[SERVER] Connection closed" << std::endl;
             break;
 
-        case k_ESteamNetworkingConnectionState_Connecting:
-            std::cout << "[SERVER] Client attempting to connect..." << std::endl;
-
-            // Enforce 2-player limit
-            if (clients.size() >= 2) {
-                interface->CloseConnection(info->m_hConn, 0, "Server full", false);
-                std::cout << "[SERVER] Rejected: Server full" << std::endl;
-            } else {
-                // Accept connection
-                EResult result = interface->AcceptConnection(info->m_hConn);
-                if (result != k_EResultOK) {
-                    interface->CloseConnection(info->m_hConn, 0, "Failed to accept", false);
-                    std::cout << "[SERVER] Failed to accept: " << result << std::endl;
-                } else {
-                    std::cout << "[SERVER] Connection accepted" << std::endl;
-                }
+        case k_ESteamNetworkingConnectionState_Connecting: {
+            bool taken;     // By a shared memory client
+            {
+                std::lock_guard<std::mutex> lock(clientsMutex);
+                taken = isLocalConnection(connection);
+            }
+            // Queued here, accepted in admitConnections() at a bounded rate
+            if (taken || !admission.request(connection, addressOf(info->m_info.m_addrRemote), now)) {
+                interface->CloseConnection(connection, 0, "Server busy, try again", false);
             }
             break;
+        }
 
         case k_ESteamNetworkingConnectionState_FindingRoute:
-            std::cout << "[SERVER] Finding route to client..." << std::endl;
             break;
 
         case k_ESteamNetworkingConnectionState_Connected:
-            std::cout << "[SERVER] Client fully connected! (Handle: " << info->m_hConn << ")" << std::endl;
+            admission.connected(connection);
 
             // Add to clients list (avoid duplicates)
-            if (std::find(clients.begin(), clients.end(), info->m_hConn) == clients.end()) {
-                clients.push_back(info->m_hConn);
-                interface->SetConnectionPollGroup(info->m_hConn, pollGroup);
-                std::cout << "[SERVER] Total clients: " << clients.size() << "/2" << std::endl;
+            {
+                std::lock_guard<std::mutex> lock(clientsMutex);
+                if (std::find(clients.begin(), clients.end(), connection) != clients.end()) {
+                    break;
+                }
+                clients.push_back(connection);
+                Liveness& peer = liveness[connection];
+                peer.lastHeard = now;
+                peer.lastPing = now;
             }
+            interface->SetConnectionPollGroup(connection, pollGroup);
+            configureLanes(interface, connection);
+            connectionEvents.enqueue(ConnectionEvent{connection, true});
             break;
 
         case k_ESteamNetworkingConnectionState_ClosedByPeer:
-            std::cout << "[SERVER] Client disconnected: " << info->m_info.m_szEndDebug << std::endl;
-            clients.erase(std::remove(clients.begin(), clients.end(), info->m_hConn), clients.end());
-            break;
-
         case k_ESteamNetworkingConnectionState_ProblemDetectedLocally:
-            std::cout << "[SERVER] Connection problem: " << info->m_info.m_szEndDebug << std::endl;
-            clients.erase(std::remove(clients.begin(), clients.end(), info->m_hConn), clients.end());
+            admission.closed(connection);
+            if (info->m_info.m_eState == k_ESteamNetworkingConnectionState_ProblemDetectedLocally) {
+                printf("[SERVER] Connection %u problem: %s\n", connection, info->m_info.m_szEndDebug);
+            }
+            dropClient(connection, nullptr);
             break;
 
         default:
@@ -305,13 +943,137 @@ void GameServer::onConnectionStatusChanged(SteamNetConnectionStatusChangedCallba
     }
 }
 
+/**
+ * Closes a client's connection for good. A player that drops keeps its seat for a
+ * while, and its resume token reclaims it.
+ *
+ * @param connection The client
+ * @param reason Sent to the peer, if it is still there to read it
+ */
+void GameServer::dropClient(HSteamNetConnection connection, const char* reason) {
+    auto token = resumeTokens.find(connection);
+    if (token != resumeTokens.end()) {
+        // Local clients come back over loopback if shared memory is unavailable next time
+        SteamNetConnectionInfo_t info{};
+        bool local;
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            local = isLocalConnection(connection);
+        }
+        if (local) {
+            admission.holdSeat(token->second, "127.0.0.1", std::chrono::steady_clock::now());
+        } else if (interface->GetConnectionInfo(connection, &info)) {
+            admission.holdSeat(token->second, addressOf(info.m_addrRemote), std::chrono::steady_clock::now());
+        }
+        heldSeatMarks[token->second] = getSeat(connection);
+    }
+    removeClient(connection);
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    closeConnection(connection, reason, false);
+}
+
+/**
+ * Drops a connection from the client list, reporting the disconnect only if the
+ * connection had been reported as connected.
+ */
+void GameServer::removeClient(HSteamNetConnection connection) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto it = std::find(clients.begin(), clients.end(), connection);
+    if (it != clients.end()) {
+        clients.erase(it);
+        sessions.erase(connection);
+        backlogs.erase(connection);
+        liveness.erase(connection);
+        resumeTokens.erase(connection);
+        seats.erase(connection);
+        admission.counters().disconnected++;
+        connectionEvents.enqueue(ConnectionEvent{connection, false});
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Room Migration
+ *---------------------------------------------------------------------------*/
+
+// Tokens and marks of the connected players, who present the tokens when they follow the room
+std::vector<std::pair<std::string, int>> GameServer::getSeats() const {
+    std::vector<std::pair<std::string, int>> held;
+    for (const auto& [connection, token] : resumeTokens) {
+        held.emplace_back(token, getSeat(connection));
+    }
+    return held;
+}
+
+std::string GameServer::issueResumeToken() {
+    return admission.issueResumeToken();
+}
+
+/**
+ * Holds a seat for each token of a room this server took over, at most MAX_CLIENTS of
+ * them and players before spectators. The players connect from wherever they are, so
+ * the address only matters for queue priority.
+ */
+void GameServer::holdSeats(const std::vector<std::pair<std::string, int>>& held) {
+    std::vector<std::pair<std::string, int>> seats = held;
+    std::stable_partition(seats.begin(), seats.end(), [](const auto& seat) { return seat.second != 0; });
+    if (seats.size() > static_cast<size_t>(MAX_CLIENTS)) {
+        printf("[SERVER] Room brought %zu seats, holding %d\n", seats.size(), MAX_CLIENTS);
+        seats.resize(MAX_CLIENTS);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& [token, mark] : seats) {
+        admission.holdSeat(token, "127.0.0.1", now);
+        heldSeatMarks[token] = mark;
+    }
+}
+
+/**
+ * Sends every client on to the server that took the room over, each with its own
+ * resume token, and closes its connection (lingering, so the redirect is delivered).
+ * The sessions end here without holding a seat: the room is no longer on this server.
+ *
+ * @param port Game port of the room's new server, on this host
+ */
+void GameServer::redirectClients(uint16_t port) {
+    std::vector<HSteamNetConnection> redirected;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        redirected = clients;
+    }
+
+    for (HSteamNetConnection connection : redirected) {
+        NetworkPacket redirect;
+        redirect.type = PacketType::REDIRECT;
+        redirect.data["port"] = port;
+        auto token = resumeTokens.find(connection);
+        if (token != resumeTokens.end()) {
+            redirect.data["resume"] = token->second;
+        }
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            transmit(connection, redirect.serialize(sessionOf(connection).codec), Lane::GAME);
+            closeConnection(connection, "Room moved", true);
+        }
+        removeClient(connection);
+    }
+    movedTo = port;
+    printf("[SERVER] Sent %zu client(s) on to port %u\n", redirected.size(), port);
+}
+
+// A room taken over from another server keeps its name
+void GameServer::setRoom(const std::string& name) {
+    room = name;
+}
+
 /*******************************************************************************
  *                           CLIENT IMPLEMENTATION
  ******************************************************************************/
 
-GameClient::GameClient()
+GameClient::GameClient(const NetworkTimeouts& timeouts)
     : serverConnection(k_HSteamNetConnection_Invalid)
     , interface(nullptr)
+    , timeouts(timeouts)
     , running(false)
     , connected(false) {
 }
@@ -343,45 +1105,144 @@ bool GameClient::connectToServer(const std::string &serverAddress, uint16_t port
     interface = SteamNetworkingSockets();
     g_GameClientCallback = this;
 
-    // Parse server address
-    SteamNetworkingIPAddr serverAddr;
-    serverAddr.Clear();
+    // Parse server address ("host", "host:port", "[v6]:port", each optionally followed by "/room")
+    size_t roomStart = serverAddress.find('/');
+    room = roomStart != std::string::npos ? serverAddress.substr(roomStart + 1) : std::string();
+    serverPort = port;
+    if (!parseHostPort(serverAddress.substr(0, roomStart), serverHost, serverPort)) {
+        std::cerr << "[CLIENT] Invalid server address: " << serverAddress << std::endl;
+        return false;
+    }
+
+    return startLookup();
+}
+
+/**
+ * Starts another connection attempt to the server of the last connectToServer() call.
+ * The resume token of the previous session is presented in the handshake.
+ *
+ * @return true if the attempt was started
+ */
+bool GameClient::reconnect() {
+    if (!interface) {
+        return false;
+    }
+    closeConnection("Reconnecting");
+    connected = false;
+    return startLookup();
+}
+
+// Resolution is usually a cache hit; updateClient() connects once it is done
+bool GameClient::startLookup() {
+    lastError.clear();
+    lookup = HostResolver::shared().resolve(serverHost);
+    running = true;
+    printf("[CLIENT] Resolving %s...\n", serverHost.c_str());
+    return true;
+}
 
-    if (serverAddress == "127.0.0.1" || serverAddress == "localhost") {
-        // Localhost connection
-        serverAddr.SetIPv4(0x7f000001, port);
-        printf("[CLIENT] Connecting to localhost:%d\n", port);
+void GameClient::finishLookup() {
+    Resolution resolution = lookup.get();
+    lookup = std::shared_future<Resolution>();
+
+    if (resolution.addresses.empty()) {
+        std::cerr << "[CLIENT] " << resolution.error << std::endl;
+        lastError = resolution.error;
+        running = false;
+        return;
+    }
+
+    const ResolvedAddress& address = resolution.addresses.front();
+    serverAddr.Clear();
+    if (address.ipv6) {
+        serverAddr.SetIPv6(address.bytes.data(), serverPort);
     } else {
-        // Parse IP address manually (supports IPv4)
-        unsigned char ip[4];
-        if (sscanf(serverAddress.c_str(), "%hhu.%hhu.%hhu.%hhu",
-                   &ip[0], &ip[1], &ip[2], &ip[3]) == 4) {
-            uint32_t ipv4 = (ip[0] << 24) | (ip[1] << 16) | (ip[2] << 8) | ip[3];
-            serverAddr.SetIPv4(ipv4, port);
-            printf("[CLIENT] Connecting to %s:%d\n", serverAddress.c_str(), port);
-        } else {
-            std::cerr << "[CLIENT] Invalid IP format: " << serverAddress << std::endl;
-            return false;
-        }
+        serverAddr.SetIPv4((uint32_t(address.bytes[0]) << 24) | (uint32_t(address.bytes[1]) << 16) |
+                           (uint32_t(address.bytes[2]) << 8) | address.bytes[3], serverPort);
     }
 
-    // Set up connection status callback
-    SteamNetworkingConfigValue_t config{};
-    config.SetPtr(k_ESteamNetworkingConfig_Callback_ConnectionStatusChanged,
-                  (void*)SteamNetConnectionStatusChangedCallback);
+    char addressText[SteamNetworkingIPAddr::k_cchMaxString];
+    serverAddr.ToString(addressText, sizeof(addressText), true);
+    printf("[CLIENT] Connecting to %s (%s)\n", serverHost.c_str(), addressText);
+    if (serverAddr.IsLocalHost() && openLocalConnection()) {
+        return;
+    }
+    if (!openConnection()) {
+        lastError = "Failed to create connection";
+        running = false;
+    }
+}
+
+bool GameClient::openConnection() {
+    // Connection status callback and timeouts
+    auto config = connectionConfig(timeouts, (void*)SteamNetConnectionStatusChangedCallback);
 
     // Initiate connection
-    serverConnection = interface->ConnectByIPAddress(serverAddr, 1, &config);
+    serverConnection = interface->ConnectByIPAddress(serverAddr, static_cast<int>(config.size()), config.data());
     if (serverConnection == k_HSteamNetConnection_Invalid) {
         std::cerr << "[CLIENT] Failed to create connection" << std::endl;
         return false;
     }
 
+    liveness = Liveness();
+    rttMs = -1;
     running = true;
     std::cout << "[CLIENT] Connection initiated..." << std::endl;
     return true;
 }
 
+/**
+ * Connects through shared memory to a server on this machine. There is no connection
+ * setup beyond claiming a slot, so the client is connected at once and says hello.
+ *
+ * @return false if no local server takes the connection (the network is used instead)
+ */
+bool GameClient::openLocalConnection() {
+    std::shared_ptr<SharedMemoryChannel> channel = SharedMemoryChannel::connect(serverPort);
+    if (!channel) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(localChannelMutex);
+        localChannel = std::move(channel);
+    }
+
+    liveness = Liveness();
+    rttMs = -1;
+    codec = Codec::JSON;
+    useLanes = true;
+    running = true;
+    connected = true;
+    std::cout << "[CLIENT] ✓ Connected to server through shared memory!" << std::endl;
+    sendHello();
+    return true;
+}
+
+// Whichever transport is in use
+void GameClient::closeConnection(const char* reason) {
+    std::shared_ptr<SharedMemoryChannel> channel;
+    {
+        std::lock_guard<std::mutex> lock(localChannelMutex);
+        channel = std::move(localChannel);
+    }
+    if (channel) {
+        channel->close();
+    }
+    if (serverConnection != k_HSteamNetConnection_Invalid) {
+        interface->CloseConnection(serverConnection, 0, reason, false);
+        serverConnection = k_HSteamNetConnection_Invalid;
+    }
+}
+
+std::shared_ptr<SharedMemoryChannel> GameClient::getLocalChannel() const {
+    std::lock_guard<std::mutex> lock(localChannelMutex);
+    return localChannel;
+}
+
+bool GameClient::isLocal() const {
+    return connected && getLocalChannel() != nullptr;
+}
+
 /*-----------------------------------------------------------------------------
  *                          Client Disconnection
  *---------------------------------------------------------------------------*/
@@ -394,9 +1255,8 @@ void GameClient::disconnectFromServer() {
     running = false;
     connected = false;
 
-    if (serverConnection != k_HSteamNetConnection_Invalid) {
-        interface->CloseConnection(serverConnection, 0, "Client disconnected", false);
-        serverConnection = k_HSteamNetConnection_Invalid;
+    if (interface) {
+        closeConnection("Client disconnected");
     }
 
     GameNetworkingSockets_Kill();
@@ -413,11 +1273,31 @@ void GameClient::disconnectFromServer() {
 void GameClient::updateClient() {
     if (!running) return;
 
+    // Still resolving the server's name
+    if (lookup.valid()) {
+        if (lookup.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+        finishLookup();
+        if (!running) return;
+    }
+
     // Process connection state changes
     interface->RunCallbacks();
     
     // Receive messages from server
     receiveMessages();
+
+    serviceHeartbeat();
+}
+
+void GameClient::waitForTraffic(int timeoutMs) {
+    std::shared_ptr<SharedMemoryChannel> channel = getLocalChannel();
+    if (channel) {
+        channel->wait(timeoutMs);
+    } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+    }
 }
 
 /*-----------------------------------------------------------------------------
@@ -429,6 +1309,22 @@ void GameClient::updateClient() {
  * Processes each message and adds it to a concurrent queue for the game logic thread to handle.
  */
 void GameClient::receiveMessages() {
+    std::shared_ptr<SharedMemoryChannel> channel = getLocalChannel();
+    if (channel) {
+        // A redirect closes the channel from within processMessage()
+        std::string message;
+        while (getLocalChannel() == channel && channel->receive(message)) {
+            processMessage(message.data(), static_cast<uint32_t>(message.size()));
+        }
+        if (getLocalChannel() == channel && !channel->isOpen()) {
+            std::cout << "[CLIENT] Server closed the shared memory connection" << std::endl;
+            closeConnection(nullptr);
+            connected = false;
+            running = false;
+        }
+        return;
+    }
+
     while (true) {
         ISteamNetworkingMessage* incomingMessage = nullptr;
         int numberMessages = interface->ReceiveMessagesOnConnection(
@@ -457,12 +1353,105 @@ void GameClient::processMessage(const void *data, uint32_t size) {
     try {
         // Deserialize JSON packet
         NetworkPacket packet = NetworkPacket::deserialize(message);
+        liveness.lastHeard = std::chrono::steady_clock::now();
+
+        if (packet.type == PacketType::HANDSHAKE) {
+            handleHandshake(packet);
+            return;
+        }
+        if (packet.type == PacketType::HEARTBEAT) {
+            handleHeartbeat(packet);
+            return;
+        }
+        if (packet.type == PacketType::REDIRECT) {
+            handleRedirect(packet);
+            return;
+        }
         incomingPackets.enqueue(packet);
     } catch (const std::exception &e) {
         std::cerr << "[CLIENT] Parse error: " << e.what() << std::endl;
     }
 }
 
+/**
+ * Switches to the session the server picked (or reports its rejection; the server
+ * closes the connection itself).
+ *
+ * @param packet The HANDSHAKE packet
+ */
+void GameClient::handleHandshake(const NetworkPacket& packet) {
+    if (packet.data.contains("accept")) {
+        ProtocolSession session = Protocol::accepted(packet.data["accept"]);
+        codec = session.codec;
+        useLanes = session.lanes;
+        resumeToken = packet.data.value("resume", std::string());
+        // Servers from before seats always seated the client as O
+        seat = packet.data.contains("seat") && packet.data["seat"].is_number_integer() ? packet.data["seat"].get<int>() : 2;
+        redirected = false;
+        liveness.heartbeats = session.version >= Protocol::HEARTBEAT_VERSION;
+        liveness.lastHeard = std::chrono::steady_clock::now();
+        printf("[CLIENT] Protocol v%u, %s codec, lanes %s, seat %d%s\n", session.version,
+               Protocol::codecName(session.codec), session.lanes ? "on" : "off", *seat,
+               packet.data.value("resumed", false) ? " (resumed)" : "");
+    } else if (packet.data.contains("reject")) {
+        std::cerr << "[CLIENT] Server rejected our protocol: " << packet.data.value("reject", std::string()) << std::endl;
+    }
+}
+
+/**
+ * Answers the server's ping, or takes the RTT from the pong to one of ours.
+ */
+void GameClient::handleHeartbeat(const NetworkPacket& packet) {
+    if (packet.data.contains("ping")) {
+        NetworkPacket pong = heartbeatPacket("pong", packet.data.value("ping", int64_t{0}));
+        transmit(pong.serialize(codec), Lane::GAME, k_nSteamNetworkingSend_UnreliableNoNagle);
+    } else if (packet.data.contains("pong")) {
+        liveness.rttMs = static_cast<int>((nowMicros() - packet.data.value("pong", int64_t{0})) / 1000);
+        rttMs = liveness.rttMs;
+    }
+}
+
+/**
+ * Follows the room to its new server: closes this connection and connects to the
+ * given port on the same host, presenting the token the old server handed over.
+ */
+void GameClient::handleRedirect(const NetworkPacket& packet) {
+    uint16_t port = packet.data.value("port", uint16_t{0});
+    if (port == 0) {
+        return;
+    }
+    resumeToken = packet.data.value("resume", resumeToken);
+    serverPort = port;
+    printf("[CLIENT] Room moved, following it to port %u\n", port);
+
+    closeConnection("Redirected");
+    connected = false;
+    redirected = true;
+    startLookup();
+}
+
+/**
+ * Pings the server when due, and gives the connection up if the server has gone quiet
+ * (the game notices through isConnected() and can reconnect()).
+ */
+void GameClient::serviceHeartbeat() {
+    if (!connected || !liveness.heartbeats) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - liveness.lastHeard > std::chrono::milliseconds(timeouts.deadPeerMs)) {
+        printf("[CLIENT] Server silent for %d ms, dropping the connection\n", timeouts.deadPeerMs);
+        closeConnection("Timed out");
+        connected = false;
+        running = false;
+    } else if (now - liveness.lastPing >= std::chrono::milliseconds(timeouts.heartbeatIntervalMs)) {
+        liveness.lastPing = now;
+        NetworkPacket ping = heartbeatPacket("ping", nowMicros());
+        transmit(ping.serialize(codec), Lane::GAME, k_nSteamNetworkingSend_UnreliableNoNagle);
+    }
+}
+
 /*-----------------------------------------------------------------------------
  *                              Message Sending
  *---------------------------------------------------------------------------*/
@@ -472,23 +1461,50 @@ void GameClient::processMessage(const void *data, uint32_t size) {
  * Logs any errors that occur during message sending.
  *
  * @param packet The NetworkPacket to send to the server
+ * @param lane The lane to send on
  */
-void GameClient::sendPacketToServer(const NetworkPacket &packet) const {
+void GameClient::sendPacketToServer(const NetworkPacket &packet, Lane lane) const {
     if (!isConnected()) {
         std::cerr << "[CLIENT] Cannot send - not connected" << std::endl;
         return;
     }
 
-    std::string serialized = packet.serialize();
-    EResult result = interface->SendMessageToConnection(
-        serverConnection, serialized.c_str(), serialized.size(),
-        k_nSteamNetworkingSend_Reliable, nullptr);
+    std::string serialized = packet.serialize(codec);
+    EResult result = transmit(serialized, useLanes ? lane : Lane::GAME);
 
     if (result != k_EResultOK) {
         std::cerr << "[CLIENT] Failed to send packet: " << result << std::endl;
     }
 }
 
+/**
+ * Sends encoded bytes to the server over whichever transport is in use. Shared memory
+ * delivers everything reliably and in order, so lanes and flags only matter on the network.
+ *
+ * @return k_EResultOK, or the reason the message was not queued
+ */
+EResult GameClient::transmit(const std::string& bytes, Lane lane, int flags) const {
+    std::shared_ptr<SharedMemoryChannel> channel = getLocalChannel();
+    if (channel) {
+        return channel->send(bytes) ? k_EResultOK : k_EResultLimitExceeded;
+    }
+    return sendOnLane(interface, serverConnection, bytes, lane, flags);
+}
+
+// Offer what this build supports; JSON until the server answers
+void GameClient::sendHello() {
+    NetworkPacket hello;
+    hello.type = PacketType::HANDSHAKE;
+    hello.data["hello"] = Protocol::hello(Protocol::local());
+    if (!resumeToken.empty()) {
+        hello.data["resume"] = resumeToken;
+    }
+    if (!room.empty()) {
+        hello.data["room"] = room;
+    }
+    transmit(hello.serialize(), Lane::GAME);
+}
+
 /*-----------------------------------------------------------------------------
  *                          Connection Status Callbacks
  *---------------------------------------------------------------------------*/
@@ -529,7 +1545,11 @@ void GameClient::onConnectionStatusChanged(SteamNetConnectionStatusChangedCallba
 
         case k_ESteamNetworkingConnectionState_Connected:
             std::cout << "[CLIENT] ✓ Connected to server!" << std::endl;
+            configureLanes(interface, info->m_hConn);
+            codec = Codec::JSON;
+            useLanes = true;
             connected = true;
+            sendHello();
             break;
 
         case k_ESteamNetworkingConnectionState_ClosedByPeer:
@@ -2,9 +2,21 @@
 
 #include <steam/steamnetworkingsockets.h>
 #include <steam/steamnetworkingtypes.h>
+#include "Admission.h"
+#include "HealthCheck.h"
+#include "HostResolver.h"
+#include "Protocol.h"
+#include "SharedMemoryTransport.h"
+#include <memory>
 #include <string>
 #include <atomic>
+#include <chrono>
 #include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <nlohmann/json.hpp>
 #include <moodycamel/concurrentqueue.h>
@@ -16,64 +28,206 @@ enum class PacketType {
     GAME_STATE_UPDATE,  // Server sends updated game state to clients
     GAME_STATE,         // Server sends the full game state (e.g. on new client join)
     GAME_RESET,         // Signal to reset the game state
-    PLAYER_JOINED,      // New player joined the lobby
-    CHAT_MESSAGE
+    PLAYER_JOINED,      // Lobby presence: member snapshot, or a coalesced join/status/leave delta
+    CHAT_MESSAGE,
+    RESYNC_REQUEST,     // Client asks for the moves after "sequence", or the full GAME_STATE
+    MOVE_REJECTED,      // Server refused a client's move request
+    HANDSHAKE,          // Protocol negotiation; handled by GameServer/GameClient, never queued
+    HEARTBEAT,          // Ping/pong for RTT and dead-peer detection; never queued either
+    REDIRECT            // The room moved to another port on this host; handled by GameClient, never queued
+};
+
+// Send lanes, configured on every connection. Lower lanes are served first, so game
+// traffic is never queued behind chat.
+enum class Lane : uint16_t {
+    GAME = 0,
+    CHAT = 1
 };
 
 struct NetworkPacket {
     PacketType type;
     json data;
+    HSteamNetConnection connection = k_HSteamNetConnection_Invalid;  // Sender, set by the server (not serialized)
 
-    std::string serialize() const {
+    std::string serialize(Codec codec = Codec::JSON) const {
         json packetJson;
         packetJson["type"] = static_cast<int>(type);
         packetJson["data"] = data;
+        if (codec == Codec::BINARY) {
+            std::string bytes;
+            json::to_msgpack(packetJson, bytes);
+            return bytes;
+        }
         return packetJson.dump();
     }
 
+    // Accepts either codec (see Codec). Throws on anything but {"type": <known type>,
+    // "data": <object>}, so a packet that comes out always has a valid type and an object
+    // to read from; the fields inside are still the sender's and must be checked.
     static NetworkPacket deserialize(const std::string& packetStr) {
-        NetworkPacket packet;
+        json packetJson = !packetStr.empty() && packetStr[0] != '{' ? json::from_msgpack(packetStr)
+                                                                    : json::parse(packetStr);
+        if (!packetJson.is_object() || !packetJson.contains("type") || !packetJson["type"].is_number_integer()) {
+            throw std::invalid_argument("packet without a type");
+        }
+        int type = packetJson["type"].get<int>();
+        if (type < static_cast<int>(PacketType::PLAYER_MOVE) || type > static_cast<int>(PacketType::REDIRECT)) {
+            throw std::invalid_argument("unknown packet type " + std::to_string(type));
+        }
 
-        try {
-            auto packetJson = json::parse(packetStr);
-            packet.type = static_cast<PacketType>(packetJson["type"].get<int>());
-            packet.data = packetJson["data"];
-        } catch (const json::parse_error& e) {
-            // Handle JSON parsing error
-            std::cerr << "JSON parse error: " << e.what() << std::endl;
-            // You may want to set packet.type to an invalid value or throw an exception
+        NetworkPacket packet;
+        packet.type = static_cast<PacketType>(type);
+        packet.data = packetJson.contains("data") ? packetJson["data"] : json::object();
+        if (packet.data.is_null()) {
+            packet.data = json::object();
+        } else if (!packet.data.is_object()) {
+            throw std::invalid_argument("packet data is not an object");
         }
         return packet;
     }
 };
 
+// Connection timing. The library's timeouts are the backstop; peers that negotiated
+// heartbeats are declared dead after deadPeerMs without a single message.
+struct NetworkTimeouts {
+    int connectTimeoutMs = 5000;        // Connection attempt (library)
+    int connectedTimeoutMs = 10000;     // Established connection gone silent (library)
+    int heartbeatIntervalMs = 250;      // App-level ping; also keeps idle connections alive
+    int deadPeerMs = 1000;
+
+    // Defaults, overridden by MA1_CONNECT_TIMEOUT_MS, MA1_CONNECTED_TIMEOUT_MS,
+    // MA1_HEARTBEAT_MS and MA1_DEAD_PEER_MS
+    static NetworkTimeouts fromEnvironment();
+};
+
+// Heartbeat state of one connection
+struct Liveness {
+    bool heartbeats = false;            // The peer answers pings (negotiated)
+    std::chrono::steady_clock::time_point lastHeard;
+    std::chrono::steady_clock::time_point lastPing;
+    int rttMs = -1;                     // Until the first pong
+};
+
+// A client finishing its connection (connected) or going away (!connected)
+struct ConnectionEvent {
+    HSteamNetConnection connection = k_HSteamNetConnection_Invalid;
+    bool connected = false;
+};
+
 class GameServer {
 public:
-    GameServer(uint16_t port);
+    GameServer(uint16_t port, const NetworkTimeouts& timeouts = NetworkTimeouts());
     ~GameServer();
 
     bool startServer(uint16_t port);
     void stopServer();
     void updateServer();
+    // Network thread: sleeps up to timeoutMs, waking early when a local (shared memory) client writes
+    void waitForTraffic(int timeoutMs);
 
-    void broadcastPacket(const NetworkPacket& packet);
-    void sendPacketToClient(HSteamNetConnection connection, const NetworkPacket& packet);
+    void broadcastPacket(const NetworkPacket& packet, Lane lane = Lane::GAME);
+    void sendPacketToClient(HSteamNetConnection connection, const NetworkPacket& packet, Lane lane = Lane::GAME);
 
     moodycamel::ConcurrentQueue<NetworkPacket> incomingPackets;
+    moodycamel::ConcurrentQueue<ConnectionEvent> connectionEvents;
+
+    int getClientCount() const;
+    int getRttMs(HSteamNetConnection connection) const;     // -1 if unknown
+
+    // Seats (network thread). A seat is the mark a connection plays, as a TileState value
+    // (0 = spectator); moves are applied with it, never with a mark taken from a packet.
+    // Joining players take the open marks in order, and a resumed player gets its old one.
+    void setOpenSeats(std::vector<int> marks);
+    int getSeat(HSteamNetConnection connection) const;
+
+    // Room migration (network thread). The source hands over its seats (token and mark,
+    // plus a token issued for its own host) and then sends every client on; the
+    // destination holds each seat, so the players following the room get theirs back.
+    std::vector<std::pair<std::string, int>> getSeats() const;
+    std::string issueResumeToken();
+    void holdSeats(const std::vector<std::pair<std::string, int>>& seats);
+    void redirectClients(uint16_t port);
 
-    int getClientCount() const { return static_cast<int>(clients.size()); }
+    // What a router sees of this server (network thread): the room its players named,
+    // and the port it moved to if it did
+    void setRoom(const std::string& name);
+    const std::string& getRoom() const { return room; }
+
+    static constexpr int MAX_CLIENTS = 2;
+    static constexpr int ADMISSION_REPORT_MS = 5000;
+
+    // Backpressure, on reliable bytes a connection has queued or not yet acknowledged
+    static constexpr int64_t SOFT_PENDING_BYTES = 32 * 1024;   // Beyond: state updates collapse, chat is dropped
+    static constexpr int64_t HARD_PENDING_BYTES = 256 * 1024;  // Beyond: the client is disconnected
+    static constexpr int SLOW_CONSUMER_TIMEOUT_MS = 10000;     // Also disconnected: held back this long
 
 private:
     HSteamListenSocket listenSocket;
     HSteamNetPollGroup pollGroup;
     ISteamNetworkingSockets* interface;
+    std::unique_ptr<SharedMemoryListener> localListener;   // Network thread only
+    std::unique_ptr<HealthEndpoint> healthEndpoint;        // Network thread only
 
+    // Guards clients and sessions: the logic thread sends too
+    mutable std::mutex clientsMutex;
     std::vector<HSteamNetConnection> clients;
+    std::unordered_map<HSteamNetConnection, ProtocolSession> sessions;
+    // Shared memory clients, which go through the same sessions, heartbeats and backlogs as
+    // network clients. Their handles are ours, not the library's: this map alone says which
+    // transport a handle is on.
+    std::unordered_map<HSteamNetConnection, std::shared_ptr<SharedMemoryChannel>> localChannels;
+    HSteamNetConnection nextLocalConnection = 1;
+
+    // Updates held back from a client that is falling behind
+    struct Backlog {
+        bool holding = false;           // State updates are being collapsed instead of sent
+        bool deltasDropped = false;     // Some were moves/resets: only a full resync catches up
+        std::string latestState;        // Otherwise the newest full state, encoded
+        Lane latestLane = Lane::GAME;
+        std::chrono::steady_clock::time_point since;
+    };
+    std::unordered_map<HSteamNetConnection, Backlog> backlogs;
+    std::unordered_map<HSteamNetConnection, Liveness> liveness;
+
+    // Admission (network thread only)
+    AdmissionControl admission;
+    std::unordered_map<HSteamNetConnection, std::string> resumeTokens;
+    std::vector<int> openSeats;
+    std::unordered_map<HSteamNetConnection, int> seats;
+    std::unordered_map<std::string, int> heldSeatMarks;     // By resume token, while admission holds it
+    std::string room;                                       // Named by the first player, or by a migration
+    uint16_t movedTo = 0;
+    AdmissionControl::Counters reportedCounters;
+    std::chrono::steady_clock::time_point lastAdmissionReport;
     uint16_t port;
+    NetworkTimeouts timeouts;
     std::atomic<bool> running;
 
     void receiveMessages();
+    void acceptLocalClients();
+    void receiveLocalMessages();
     void processMessage(HSteamNetConnection connection, const void* data, uint32_t size);
+    void removeClient(HSteamNetConnection connection);
+    void handleHandshake(HSteamNetConnection connection, const NetworkPacket& packet);
+    int assignSeat(const std::string& resumedToken);
+    void handleHeartbeat(HSteamNetConnection connection, const NetworkPacket& packet);
+    void serviceHeartbeats();
+    void dropClient(HSteamNetConnection connection, const char* reason);
+    const ProtocolSession& sessionOf(HSteamNetConnection connection) const;
+
+    // Either transport; clientsMutex must be held
+    EResult transmit(HSteamNetConnection connection, const std::string& bytes, Lane lane,
+                     int flags = k_nSteamNetworkingSend_Reliable);
+    void closeConnection(HSteamNetConnection connection, const char* reason, bool linger);
+    bool isLocalConnection(HSteamNetConnection connection) const;
+    HSteamNetConnection allocateLocalConnection();
+
+    int64_t pendingBytes(HSteamNetConnection connection) const;
+    void deliver(HSteamNetConnection connection, const NetworkPacket& packet, const std::string& bytes, Lane lane);
+    void serviceBacklogs();
+    void admitConnections();
+    void reportAdmission();
+    void answerHealthChecks();
 
     void onConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* info);
     static void SteamNetConnectionStatusChangedCallback(SteamNetConnectionStatusChangedCallback_t* info);
@@ -82,26 +236,79 @@ private:
 // Client
 class GameClient {
 public:
-    GameClient();
+    explicit GameClient(const NetworkTimeouts& timeouts = NetworkTimeouts());
     ~GameClient();
 
+    // serverAddress is a host name or address, optionally with ":port" (which overrides port)
+    // and "/room" (which a router in front of several servers places the client by).
+    // Returns at once; the name is resolved in the background before connecting.
     bool connectToServer(const std::string& serverAddress, uint16_t port);
+    // New attempt to the last server, e.g. after the connection was lost
+    bool reconnect();
     void disconnectFromServer();
     void updateClient();
+    // Network thread: sleeps up to timeoutMs, waking early when a local (shared memory) server writes
+    void waitForTraffic(int timeoutMs);
 
-    void sendPacketToServer(const NetworkPacket& packet) const;
+    void sendPacketToServer(const NetworkPacket& packet, Lane lane = Lane::GAME) const;
     bool isConnected() const { return connected; }
+    bool isConnecting() const { return running && !connected; }
+    bool isLocal() const;       // Connected through shared memory
+    int getRttMs() const { return rttMs; }  // -1 if unknown
+    // Why the last attempt ended before connecting (e.g. the name did not resolve); network thread
+    const std::string& getLastError() const { return lastError; }
+    // The connection ended because the server sent us on to the room's new server; network thread
+    bool wasRedirected() const { return redirected; }
+
+    // Presented in the handshake to reclaim a held seat; replaced by the server's new token
+    void setResumeToken(const std::string& token) { resumeToken = token; }
+    const std::string& getResumeToken() const { return resumeToken; }
+
+    // The seat the server gave us in its last handshake (a TileState value, 0 to spectate),
+    // once per handshake; network thread
+    std::optional<int> takeSeat() { return std::exchange(seat, std::nullopt); }
 
     moodycamel::ConcurrentQueue<NetworkPacket> incomingPackets;
 
 private:
     HSteamNetConnection serverConnection;
+    std::string serverHost;
+    uint16_t serverPort = 0;
+    std::string room;           // Sent in the hello; empty is the default room
+    std::shared_future<Resolution> lookup;  // Set while serverHost is being resolved
+    std::string lastError;
+    SteamNetworkingIPAddr serverAddr;
     ISteamNetworkingSockets* interface;
+    // Set instead of serverConnection when the server is on this machine
+    std::shared_ptr<SharedMemoryChannel> localChannel;
+    mutable std::mutex localChannelMutex;   // Replaced on the network thread, used by every sender
+    NetworkTimeouts timeouts;
     std::atomic<bool> running;
     std::atomic<bool> connected;
+    Liveness liveness;                  // Network thread only
+    std::atomic<int> rttMs{-1};
+
+    // Negotiated with the server (set on the network thread, read by any sender)
+    std::atomic<Codec> codec{Codec::JSON};
+    std::atomic<bool> useLanes{true};
+    std::string resumeToken;    // Network thread once connected
+    std::optional<int> seat;    // Network thread, until taken
+    bool redirected = false;    // Network thread
 
     void receiveMessages();
     void processMessage(const void* data, uint32_t size);
+    void handleHandshake(const NetworkPacket& packet);
+    void handleHeartbeat(const NetworkPacket& packet);
+    void handleRedirect(const NetworkPacket& packet);
+    void serviceHeartbeat();
+    bool startLookup();
+    void finishLookup();
+    bool openConnection();
+    bool openLocalConnection();
+    void closeConnection(const char* reason);
+    void sendHello();
+    std::shared_ptr<SharedMemoryChannel> getLocalChannel() const;
+    EResult transmit(const std::string& bytes, Lane lane, int flags = k_nSteamNetworkingSend_Reliable) const;
 
     void onConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* info);
     static void SteamNetConnectionStatusChangedCallback(SteamNetConnectionStatusChangedCallback_t* info);
@@ -0,0 +1,398 @@
+/*******************************************************************************
+ * Nnue.cpp
+ *
+ * Quantized NNUE-style evaluation for alpha-beta search.
+ *
+ * Architecture:
+ * - The first layer is never recomputed during search: making a move adds one
+ *   int16 weight row per perspective to the accumulator, unmaking subtracts it
+ * - Evaluation is a single clipped-ReLU + int8 dot product over 2 x hidden values
+ * - Inner loops use AVX2 (when compiled with it), SSE2 on x64, NEON on ARM64,
+ *   and a scalar fallback elsewhere; all paths give identical results
+ * - The network size follows the board (2 features per cell and perspective), so
+ *   the same code serves larger boards once Board supports them
+ ******************************************************************************/
+
+#include "Nnue.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NNUE_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define NNUE_NEON
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'M', 'A', '1', 'N', 'N', 'U', 'E', 0};
+
+// Weight of an open line with k own marks (matches SearchEngine::evaluate)
+constexpr int LINE_WEIGHT[4] = {0, 1, 10, 100};
+
+void addRow(int16_t* accumulator, const int16_t* row, int count) {
+#if defined(NNUE_AVX2)
+    for (int i = 0; i < count; i += 16) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(accumulator + i));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(accumulator + i), _mm256_add_epi16(a, r));
+    }
+#elif defined(NNUE_SSE2)
+    for (int i = 0; i < count; i += 8) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(accumulator + i));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(accumulator + i), _mm_add_epi16(a, r));
+    }
+#elif defined(NNUE_NEON)
+    for (int i = 0; i < count; i += 8) {
+        vst1q_s16(accumulator + i, vaddq_s16(vld1q_s16(accumulator + i), vld1q_s16(row + i)));
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        accumulator[i] = static_cast<int16_t>(accumulator[i] + row[i]);
+    }
+#endif
+}
+
+void subtractRow(int16_t* accumulator, const int16_t* row, int count) {
+#if defined(NNUE_AVX2)
+    for (int i = 0; i < count; i += 16) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(accumulator + i));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(accumulator + i), _mm256_sub_epi16(a, r));
+    }
+#elif defined(NNUE_SSE2)
+    for (int i = 0; i < count; i += 8) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(accumulator + i));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(accumulator + i), _mm_sub_epi16(a, r));
+    }
+#elif defined(NNUE_NEON)
+    for (int i = 0; i < count; i += 8) {
+        vst1q_s16(accumulator + i, vsubq_s16(vld1q_s16(accumulator + i), vld1q_s16(row + i)));
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        accumulator[i] = static_cast<int16_t>(accumulator[i] - row[i]);
+    }
+#endif
+}
+
+/**
+ * Sum of clamp(values[i], 0, 127) * weights[i]; count is a multiple of 32.
+ */
+int32_t clippedDot(const int16_t* values, const int8_t* weights, int count) {
+#if defined(NNUE_AVX2)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ceiling = _mm256_set1_epi16(NnueNetwork::ACTIVATION_MAX);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < count; i += 32) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i + 16));
+        a = _mm256_min_epi16(_mm256_max_epi16(a, zero), ceiling);
+        b = _mm256_min_epi16(_mm256_max_epi16(b, zero), ceiling);
+        // packus interleaves 128-bit lanes; permute back to the original order
+        __m256i activations = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(activations, w), ones));
+    }
+    __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0x4E));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0xB1));
+    return _mm_cvtsi128_si32(total);
+#elif defined(NNUE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ceiling = _mm_set1_epi16(NnueNetwork::ACTIVATION_MAX);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < count; i += 16) {
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+        // Sign-extend the int8 weights to int16
+        __m128i wLow = _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8);
+        __m128i wHigh = _mm_srai_epi16(_mm_unpackhi_epi8(w, w), 8);
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i));
+        __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i + 8));
+        a = _mm_min_epi16(_mm_max_epi16(a, zero), ceiling);
+        b = _mm_min_epi16(_mm_max_epi16(b, zero), ceiling);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a, wLow));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(b, wHigh));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#elif defined(NNUE_NEON)
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t ceiling = vdupq_n_s16(NnueNetwork::ACTIVATION_MAX);
+    int32x4_t sum = vdupq_n_s32(0);
+    for (int i = 0; i < count; i += 8) {
+        int16x8_t a = vminq_s16(vmaxq_s16(vld1q_s16(values + i), zero), ceiling);
+        int16x8_t w = vmovl_s8(vld1_s8(weights + i));
+        sum = vmlal_s16(sum, vget_low_s16(a), vget_low_s16(w));
+        sum = vmlal_s16(sum, vget_high_s16(a), vget_high_s16(w));
+    }
+    return vaddvq_s32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        int32_t activation = std::clamp<int32_t>(values[i], 0, NnueNetwork::ACTIVATION_MAX);
+        sum += activation * weights[i];
+    }
+    return sum;
+#endif
+}
+
+} // namespace
+
+const char* NnueNetwork::simdName() {
+#if defined(NNUE_AVX2)
+    return "AVX2";
+#elif defined(NNUE_SSE2)
+    return "SSE2";
+#elif defined(NNUE_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Loading / Saving
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Loads weights from a file written by save(). The board size must match Board.
+ */
+bool NnueNetwork::load(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        fprintf(stderr, "[NNUE] Cannot open %s\n", path.c_str());
+        return false;
+    }
+
+    Header header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+              header.version == VERSION &&
+              static_cast<int>(header.boardSize) == Board().getSize() &&
+              header.hidden > 0 && header.hidden <= NnueAccumulator::MAX_HIDDEN &&
+              header.hidden % 32 == 0 && header.outputScale > 0;
+
+    if (ok) {
+        boardSize = static_cast<int>(header.boardSize);
+        hidden = static_cast<int>(header.hidden);
+        outputBias = header.outputBias;
+        outputScale = header.outputScale;
+
+        size_t features = 2 * static_cast<size_t>(boardSize) * boardSize;
+        inputWeights.resize(features * hidden);
+        inputBias.resize(hidden);
+        outputWeights.resize(2 * static_cast<size_t>(hidden));
+        ok = std::fread(inputWeights.data(), sizeof(int16_t), inputWeights.size(), file) == inputWeights.size() &&
+             std::fread(inputBias.data(), sizeof(int16_t), inputBias.size(), file) == inputBias.size() &&
+             std::fread(outputWeights.data(), sizeof(int8_t), outputWeights.size(), file) == outputWeights.size();
+        if (ok && !accumulatorFits()) {
+            fprintf(stderr, "[NNUE] %s can overflow the int16 accumulator\n", path.c_str());
+            ok = false;
+        }
+    }
+    std::fclose(file);
+
+    if (!ok) {
+        fprintf(stderr, "[NNUE] %s is not a valid network for a %dx%d board\n",
+                path.c_str(), Board().getSize(), Board().getSize());
+        hidden = 0;
+        return false;
+    }
+    return true;
+}
+
+bool NnueNetwork::save(const std::string& path) const {
+    if (!isLoaded()) {
+        fprintf(stderr, "[NNUE] No network to write to %s\n", path.c_str());
+        return false;
+    }
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "[NNUE] Cannot write %s\n", path.c_str());
+        return false;
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.boardSize = static_cast<uint32_t>(boardSize);
+    header.hidden = static_cast<uint32_t>(hidden);
+    header.outputBias = outputBias;
+    header.outputScale = outputScale;
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(inputWeights.data(), sizeof(int16_t), inputWeights.size(), file) == inputWeights.size() &&
+              std::fwrite(inputBias.data(), sizeof(int16_t), inputBias.size(), file) == inputBias.size() &&
+              std::fwrite(outputWeights.data(), sizeof(int8_t), outputWeights.size(), file) == outputWeights.size();
+    std::fclose(file);
+    return ok;
+}
+
+/**
+ * Builds a network equivalent to the hand-written line evaluation: for every line,
+ * relation (own / opponent marks) and k, one hidden unit is fully active exactly when
+ * the line holds at least k marks of that relation and none of the other.
+ *
+ * @param boardSize Board edge length (lines are rows, columns and both diagonals)
+ * @return The network (hidden size padded to a multiple of 32); not loaded if the
+ *         board needs more than MAX_HIDDEN units or would overflow the accumulator
+ */
+NnueNetwork NnueNetwork::createLineNetwork(int boardSize) {
+    NnueNetwork network;
+    network.boardSize = boardSize;
+
+    // Lines as lists of cells
+    std::vector<std::vector<int>> lines;
+    for (int i = 0; i < boardSize; i++) {
+        std::vector<int> row;
+        std::vector<int> column;
+        for (int j = 0; j < boardSize; j++) {
+            row.push_back(i * boardSize + j);
+            column.push_back(j * boardSize + i);
+        }
+        lines.push_back(row);
+        lines.push_back(column);
+    }
+    std::vector<int> diagonal;
+    std::vector<int> antiDiagonal;
+    for (int i = 0; i < boardSize; i++) {
+        diagonal.push_back(i * boardSize + i);
+        antiDiagonal.push_back(i * boardSize + (boardSize - 1 - i));
+    }
+    lines.push_back(diagonal);
+    lines.push_back(antiDiagonal);
+
+    int units = static_cast<int>(lines.size()) * 2 * boardSize;
+    if (units > NnueAccumulator::MAX_HIDDEN) {
+        fprintf(stderr, "[NNUE] A %dx%d line network needs %d hidden units (at most %d)\n",
+                boardSize, boardSize, units, NnueAccumulator::MAX_HIDDEN);
+        network.boardSize = 0;
+        return network;
+    }
+    network.hidden = (units + 31) / 32 * 32;
+
+    int cells = boardSize * boardSize;
+    network.inputWeights.assign(2 * static_cast<size_t>(cells) * network.hidden, 0);
+    network.inputBias.assign(network.hidden, 0);
+    network.outputWeights.assign(2 * static_cast<size_t>(network.hidden), 0);
+    network.outputScale = ACTIVATION_MAX;
+
+    // Any mark of the other relation keeps the unit at or below zero: the other
+    // boardSize - 1 cells add at most ACTIVATION_MAX * (boardSize - 1)
+    const int16_t blocker = static_cast<int16_t>(-ACTIVATION_MAX * boardSize);
+
+    int unit = 0;
+    for (const auto& line : lines) {
+        for (int relation = 0; relation < 2; relation++) {
+            for (int k = 1; k <= boardSize; k++, unit++) {
+                network.inputBias[unit] = static_cast<int16_t>(-ACTIVATION_MAX * (k - 1));
+                for (int cell : line) {
+                    for (int featureRelation = 0; featureRelation < 2; featureRelation++) {
+                        size_t feature = static_cast<size_t>(cell) * 2 + featureRelation;
+                        network.inputWeights[feature * network.hidden + unit] =
+                            featureRelation == relation ? ACTIVATION_MAX : blocker;
+                    }
+                }
+
+                // Increment of the line weight from k - 1 to k marks (side-to-move half only)
+                int increment = k < 4 ? LINE_WEIGHT[k] - LINE_WEIGHT[k - 1] : 127;
+                increment = std::min(increment, 127);
+                network.outputWeights[unit] = static_cast<int8_t>(relation == 0 ? increment : -increment);
+            }
+        }
+    }
+
+    if (!network.accumulatorFits()) {
+        fprintf(stderr, "[NNUE] A %dx%d line network would overflow the int16 accumulator\n",
+                boardSize, boardSize);
+        network.hidden = 0;
+        network.boardSize = 0;
+    }
+    return network;
+}
+
+/**
+ * Whether every accumulator value stays within int16 for any position: the bias plus,
+ * per cell, the largest weight of the marks the cell can hold. The SIMD adds wrap
+ * around, so a network failing this could turn a blocked unit into an active one.
+ */
+bool NnueNetwork::accumulatorFits() const {
+    int cells = boardSize * boardSize;
+    for (int unit = 0; unit < hidden; unit++) {
+        int64_t high = inputBias[unit];
+        int64_t low = inputBias[unit];
+        for (int cell = 0; cell < cells; cell++) {
+            int16_t own = inputWeights[(static_cast<size_t>(cell) * 2) * hidden + unit];
+            int16_t other = inputWeights[(static_cast<size_t>(cell) * 2 + 1) * hidden + unit];
+            high += std::max<int64_t>({0, own, other});
+            low += std::min<int64_t>({0, own, other});
+        }
+        if (high > INT16_MAX || low < INT16_MIN) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Inference
+ *---------------------------------------------------------------------------*/
+
+const int16_t* NnueNetwork::featureRow(int cell, TileState mark, TileState perspective) const {
+    size_t feature = static_cast<size_t>(cell) * 2 + (mark == perspective ? 0 : 1);
+    return inputWeights.data() + feature * hidden;
+}
+
+/**
+ * Recomputes both accumulators from scratch (at the search root).
+ */
+void NnueNetwork::refresh(const Board& board, NnueAccumulator& accumulator) const {
+    for (int perspective = 0; perspective < 2; perspective++) {
+        std::copy(inputBias.begin(), inputBias.end(), accumulator.values[perspective]);
+    }
+
+    int size = board.getSize();
+    for (int cell = 0; cell < size * size; cell++) {
+        TileState mark = board.getTile(cell % size, cell / size);
+        if (mark != TileState::EMPTY) {
+            addTile(accumulator, cell, mark);
+        }
+    }
+}
+
+void NnueNetwork::addTile(NnueAccumulator& accumulator, int cell, TileState mark) const {
+    addRow(accumulator.values[0], featureRow(cell, mark, TileState::X), hidden);
+    addRow(accumulator.values[1], featureRow(cell, mark, TileState::O), hidden);
+}
+
+void NnueNetwork::removeTile(NnueAccumulator& accumulator, int cell, TileState mark) const {
+    subtractRow(accumulator.values[0], featureRow(cell, mark, TileState::X), hidden);
+    subtractRow(accumulator.values[1], featureRow(cell, mark, TileState::O), hidden);
+}
+
+/**
+ * Evaluates the position held in the accumulator.
+ *
+ * @param accumulator Up-to-date accumulator of the position
+ * @param side The side to score for
+ * @return Score from the perspective of side
+ */
+int NnueNetwork::evaluate(const NnueAccumulator& accumulator, TileState side) const {
+    int us = side == TileState::X ? 0 : 1;
+    int32_t sum = outputBias;
+    sum += clippedDot(accumulator.values[us], outputWeights.data(), hidden);
+    sum += clippedDot(accumulator.values[1 - us], outputWeights.data() + hidden, hidden);
+    return sum / outputScale;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Board.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// First-layer outputs of both perspectives (index 0 = X's view, 1 = O's view).
+// Updated incrementally: one weight row is added/subtracted per tile change.
+struct NnueAccumulator {
+    static constexpr int MAX_HIDDEN = 256;
+    alignas(32) int16_t values[2][MAX_HIDDEN];
+};
+
+// Small quantized NNUE-style evaluation network:
+//
+//   inputs:  2 x cells one-hot features per perspective (own mark / opponent mark)
+//   layer 1: int16 weights [inputs][hidden] + int16 bias, kept in an NnueAccumulator
+//   output:  clipped ReLU [0, 127] of [side to move, other side] (2 x hidden) dotted
+//            with int8 weights, plus bias, divided by outputScale
+//
+// Weights load from a file; createLineNetwork builds a network equivalent to
+// SearchEngine::evaluate so the network path can be used (and checked) without training.
+class NnueNetwork {
+public:
+    static constexpr int ACTIVATION_MAX = 127;
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+    static NnueNetwork createLineNetwork(int boardSize);
+
+    bool isLoaded() const { return hidden > 0; }
+    int getBoardSize() const { return boardSize; }
+    int getHiddenSize() const { return hidden; }
+    static const char* simdName();
+
+    // Accumulator maintenance
+    void refresh(const Board& board, NnueAccumulator& accumulator) const;
+    void addTile(NnueAccumulator& accumulator, int cell, TileState mark) const;
+    void removeTile(NnueAccumulator& accumulator, int cell, TileState mark) const;
+
+    int evaluate(const NnueAccumulator& accumulator, TileState side) const;
+
+private:
+    struct Header {
+        char magic[8];              // "MA1NNUE\0"
+        uint32_t version;
+        uint32_t boardSize;
+        uint32_t hidden;
+        int32_t outputBias;
+        int32_t outputScale;
+    };
+
+    static constexpr uint32_t VERSION = 1;
+
+    int boardSize = 0;
+    int hidden = 0;                     // Multiple of 32, at most MAX_HIDDEN
+    std::vector<int16_t> inputWeights;  // [2 * cells][hidden]
+    std::vector<int16_t> inputBias;     // [hidden]
+    std::vector<int8_t> outputWeights;  // [2 * hidden]: side to move, then other side
+    int32_t outputBias = 0;
+    int32_t outputScale = ACTIVATION_MAX;
+
+    // Feature row of a mark on a cell, seen from one perspective
+    const int16_t* featureRow(int cell, TileState mark, TileState perspective) const;
+    bool accumulatorFits() const;
+};
@@ -0,0 +1,236 @@
+/*******************************************************************************
+ * PositionCodec.cpp
+ *
+ * Base-3 position indices and 2-bit packed positions.
+ *
+ * Architecture:
+ * - Encoding folds eight cells at once inside a 64-bit word (SWAR): byte digits
+ *   combine into base-9 pairs, base-81 quads and finally a base-6561 octet with
+ *   three shift/mask/multiply-add steps instead of eight dependent ones
+ * - Decoding splits the index into base-243 chunks and expands each with one
+ *   lookup in a table of five-digit byte strings
+ * - Packing 2-bit cells compresses/expands eight bytes to 16 bits the same way
+ * - Byte loads and stores are assembled explicitly, so results do not depend
+ *   on the host byte order
+ ******************************************************************************/
+
+#include "PositionCodec.h"
+#include <algorithm>
+
+namespace {
+
+constexpr int OCTET_DIGITS = 8;
+constexpr uint32_t OCTET_BASE = 6561;       // 3^8
+constexpr int CHUNK_DIGITS = 5;
+constexpr uint32_t CHUNK_BASE = 243;        // 3^5
+
+constexpr uint64_t LANE8_MASK = 0x00FF00FF00FF00FFULL;
+constexpr uint64_t LANE16_MASK = 0x0000FFFF0000FFFFULL;
+
+// Byte strings of every five-digit base-3 number (digit i in byte i)
+struct DigitTable {
+    uint64_t entries[CHUNK_BASE];
+};
+
+constexpr DigitTable makeDigitTable() {
+    DigitTable table{};
+    for (uint32_t value = 0; value < CHUNK_BASE; value++) {
+        uint32_t rest = value;
+        for (int digit = 0; digit < CHUNK_DIGITS; digit++) {
+            table.entries[value] |= static_cast<uint64_t>(rest % 3) << (8 * digit);
+            rest /= 3;
+        }
+    }
+    return table;
+}
+
+constexpr DigitTable DIGITS = makeDigitTable();
+
+uint64_t load64(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+void storeBytes(uint64_t value, int count, uint8_t* bytes) {
+    for (int i = 0; i < count; i++) {
+        bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+// Eight byte digits -> base-3 value of those digits (byte 0 least significant)
+uint32_t encodeOctet(const uint8_t* cells) {
+    uint64_t v = load64(cells);
+    v = (v & LANE8_MASK) + 3 * ((v >> 8) & LANE8_MASK);
+    v = (v & LANE16_MASK) + 9 * ((v >> 16) & LANE16_MASK);
+    return static_cast<uint32_t>((v & 0xFFFFFFFFULL) + 81 * (v >> 32));
+}
+
+// Eight 2-bit cells (one per byte) -> 16 bits, cell 0 in the low bits
+uint64_t packOctet(const uint8_t* cells) {
+    uint64_t v = load64(cells) & 0x0303030303030303ULL;
+    v = (v | (v >> 6)) & 0x000F000F000F000FULL;
+    v = (v | (v >> 12)) & 0x000000FF000000FFULL;
+    return (v | (v >> 24)) & 0xFFFFULL;
+}
+
+// Inverse of packOctet
+uint64_t unpackOctet(uint64_t bits) {
+    uint64_t v = bits & 0xFFFFULL;
+    v = (v | (v << 24)) & 0x000000FF000000FFULL;
+    v = (v | (v << 12)) & 0x000F000F000F000FULL;
+    return (v | (v << 6)) & 0x0303030303030303ULL;
+}
+
+} // namespace
+
+/*-----------------------------------------------------------------------------
+ *                          Base-3 Index
+ *---------------------------------------------------------------------------*/
+
+uint32_t PositionCodec::indexCount(int cellCount) {
+    if (cellCount < 0 || cellCount > INDEX_MAX_CELLS) {
+        return 0;
+    }
+    uint32_t count = 1;
+    for (int i = 0; i < cellCount; i++) {
+        count *= 3;
+    }
+    return count;
+}
+
+uint32_t PositionCodec::encode(const Board& board) {
+    uint8_t cells[INDEX_MAX_CELLS] = {};
+    int size = board.getSize();
+    const auto& grid = board.getGrid();
+
+    for (int cell = 0; cell < size * size; cell++) {
+        cells[cell] = static_cast<uint8_t>(grid[cell / size][cell % size]);
+    }
+    return encodeCells(cells, size * size);
+}
+
+bool PositionCodec::decode(uint32_t index, Board& board) {
+    uint8_t cells[INDEX_MAX_CELLS];
+    int size = board.getSize();
+    if (!decodeCells(index, size * size, cells)) {
+        return false;
+    }
+
+    board.resetBoard();
+    for (int cell = 0; cell < size * size; cell++) {
+        if (cells[cell] != 0) {
+            board.setTile(cell % size, cell / size, static_cast<TileState>(cells[cell]));
+        }
+    }
+    return true;
+}
+
+/**
+ * Encodes a cell array as a base-3 index.
+ *
+ * @param cells cellCount digits (0..2), cell 0 least significant
+ * @param cellCount At most INDEX_MAX_CELLS
+ * @return The index
+ */
+uint32_t PositionCodec::encodeCells(const uint8_t* cells, int cellCount) {
+    int octets = cellCount / OCTET_DIGITS;
+    uint32_t index = 0;
+
+    // Most significant digits first: the loose tail, then whole octets downwards
+    for (int cell = cellCount - 1; cell >= octets * OCTET_DIGITS; cell--) {
+        index = index * 3 + cells[cell];
+    }
+    for (int octet = octets - 1; octet >= 0; octet--) {
+        index = index * OCTET_BASE + encodeOctet(cells + octet * OCTET_DIGITS);
+    }
+    return index;
+}
+
+/**
+ * Expands a base-3 index into a cell array.
+ *
+ * @param index The index
+ * @param cellCount At most INDEX_MAX_CELLS
+ * @param cells Receives cellCount digits
+ * @return false if the index is out of range for cellCount (cells untouched)
+ */
+bool PositionCodec::decodeCells(uint32_t index, int cellCount, uint8_t* cells) {
+    if (index >= indexCount(cellCount)) {
+        return false;
+    }
+
+    for (int cell = 0; cell < cellCount; cell += CHUNK_DIGITS) {
+        storeBytes(DIGITS.entries[index % CHUNK_BASE], std::min(CHUNK_DIGITS, cellCount - cell), cells + cell);
+        index /= CHUNK_BASE;
+    }
+    return true;
+}
+
+void PositionCodec::encodeBatch(const uint8_t* cells, int cellCount, size_t count, uint32_t* indices) {
+    if (cellCount == 9) {
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t* position = cells + i * 9;
+            indices[i] = encodeOctet(position) + OCTET_BASE * position[8];
+        }
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        indices[i] = encodeCells(cells + i * cellCount, cellCount);
+    }
+}
+
+void PositionCodec::decodeBatch(const uint32_t* indices, int cellCount, size_t count, uint8_t* cells) {
+    if (cellCount == 9) {
+        for (size_t i = 0; i < count; i++) {
+            uint32_t index = indices[i] < OCTET_BASE * 3 ? indices[i] : 0;
+            uint64_t low = DIGITS.entries[index % CHUNK_BASE];
+            uint64_t high = DIGITS.entries[index / CHUNK_BASE];
+            storeBytes(low | (high << (8 * CHUNK_DIGITS)), 8, cells + i * 9);
+            cells[i * 9 + 8] = static_cast<uint8_t>(high >> (8 * (OCTET_DIGITS - CHUNK_DIGITS)));
+        }
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint8_t* out = cells + i * cellCount;
+        if (!decodeCells(indices[i], cellCount, out)) {
+            std::fill(out, out + cellCount, uint8_t{0});
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Bit Packing
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Packs cells at 2 bits each into wordCount(cellCount) words.
+ *
+ * @param cells cellCount values (0..3)
+ * @param cellCount Any size
+ * @param words Receives the packed words (cell i at bits 2*(i % 32) of word i / 32)
+ */
+void PositionCodec::pack(const uint8_t* cells, int cellCount, uint64_t* words) {
+    std::fill(words, words + wordCount(cellCount), uint64_t{0});
+
+    int cell = 0;
+    for (; cell + OCTET_DIGITS <= cellCount; cell += OCTET_DIGITS) {
+        words[cell / CELLS_PER_WORD] |= packOctet(cells + cell) << (2 * (cell % CELLS_PER_WORD));
+    }
+    for (; cell < cellCount; cell++) {
+        words[cell / CELLS_PER_WORD] |= static_cast<uint64_t>(cells[cell] & 3) << (2 * (cell % CELLS_PER_WORD));
+    }
+}
+
+void PositionCodec::unpack(const uint64_t* words, int cellCount, uint8_t* cells) {
+    int cell = 0;
+    for (; cell + OCTET_DIGITS <= cellCount; cell += OCTET_DIGITS) {
+        uint64_t bits = words[cell / CELLS_PER_WORD] >> (2 * (cell % CELLS_PER_WORD));
+        storeBytes(unpackOctet(bits), OCTET_DIGITS, cells + cell);
+    }
+    for (; cell < cellCount; cell++) {
+        cells[cell] = static_cast<uint8_t>((words[cell / CELLS_PER_WORD] >> (2 * (cell % CELLS_PER_WORD))) & 3);
+    }
+}
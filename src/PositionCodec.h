@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Board.h"
+#include <cstddef>
+#include <cstdint>
+
+// Compact position encodings shared by the wire protocol, GameStateSnapshot, the
+// self-play dataset and the tablebase:
+//
+//   index:  base-3 number of the cells in row-major order, cell 0 least significant
+//           (digit = TileState value). A 3x3 board fits in 15 bits (3^9 = 19,683).
+//   packed: 2 bits per cell, 32 cells per 64-bit word, for boards whose index would
+//           not fit in 32 bits.
+//
+// Cell arrays are one byte per cell (TileState values). The batch functions handle
+// 3x3 boards eight cells at a time inside a 64-bit register.
+class PositionCodec {
+public:
+    static constexpr int INDEX_MAX_CELLS = 20;     // 3^20 < 2^32
+    static constexpr int CELLS_PER_WORD = 32;
+
+    // Number of distinct indices for a board with the given cell count (3^cells)
+    static uint32_t indexCount(int cellCount);
+
+    static uint32_t encode(const Board& board);
+    // Resets the board and places the marks of the index; false if it is out of range
+    static bool decode(uint32_t index, Board& board);
+
+    static uint32_t encodeCells(const uint8_t* cells, int cellCount);
+    static bool decodeCells(uint32_t index, int cellCount, uint8_t* cells);
+
+    // count positions of cellCount cells each, stored back to back
+    static void encodeBatch(const uint8_t* cells, int cellCount, size_t count, uint32_t* indices);
+    static void decodeBatch(const uint32_t* indices, int cellCount, size_t count, uint8_t* cells);
+
+    // Bit-packed form for boards of any size
+    static size_t wordCount(int cellCount) { return (cellCount + CELLS_PER_WORD - 1) / CELLS_PER_WORD; }
+    static void pack(const uint8_t* cells, int cellCount, uint64_t* words);
+    static void unpack(const uint64_t* words, int cellCount, uint8_t* cells);
+};
@@ -0,0 +1,234 @@
+/*******************************************************************************
+ * Presence.cpp
+ *
+ * Lobby presence: who is connected and what they are doing.
+ *
+ * Architecture:
+ * - The server keeps the member list and, for every member touched since the
+ *   last flush, the state it had at that flush; churn inside a tick is never
+ *   recorded, only the net difference is sent
+ * - One versioned PLAYER_JOINED delta is broadcast per presence tick, so the
+ *   cost of a tick is proportional to what changed, not to the lobby size;
+ *   nothing is sent while everyone is idle
+ * - Late joiners (and clients that missed a delta) get a full snapshot once
+ * - Entries are arrays rather than objects to keep the JSON small
+ ******************************************************************************/
+
+#include "Presence.h"
+#include <algorithm>
+
+namespace {
+
+json memberEntry(const PresenceMember& member) {
+    return json::array({member.id, member.name, static_cast<int>(member.status)});
+}
+
+std::vector<PresenceMember> sortedMembers(const std::unordered_map<uint32_t, PresenceMember>& members) {
+    std::vector<PresenceMember> result;
+    result.reserve(members.size());
+    for (const auto& [id, member] : members) {
+        result.push_back(member);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const PresenceMember& a, const PresenceMember& b) { return a.id < b.id; });
+    return result;
+}
+
+} // namespace
+
+const char* presenceStatusName(PresenceStatus status) {
+    switch (status) {
+        case PresenceStatus::PLAYING: return "playing";
+        case PresenceStatus::AWAY:    return "away";
+        default:                      return "online";
+    }
+}
+
+PresenceStatus toPresenceStatus(int value) {
+    switch (value) {
+        case static_cast<int>(PresenceStatus::PLAYING): return PresenceStatus::PLAYING;
+        case static_cast<int>(PresenceStatus::AWAY):    return PresenceStatus::AWAY;
+        default:                                        return PresenceStatus::ONLINE;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Server
+ *---------------------------------------------------------------------------*/
+
+// Remembers the member's state as of the last flush, the first time it changes in a tick
+void PresenceService::touch(uint32_t id) {
+    if (flushedState.count(id)) {
+        return;
+    }
+    auto it = members.find(id);
+    flushedState[id] = it != members.end() ? std::optional<PresenceMember>(it->second) : std::nullopt;
+}
+
+void PresenceService::join(uint32_t id, const std::string& name, PresenceStatus status) {
+    touch(id);
+    members[id] = PresenceMember{id, name, status};
+}
+
+void PresenceService::leave(uint32_t id) {
+    if (!members.count(id)) {
+        return;
+    }
+    touch(id);
+    members.erase(id);
+}
+
+void PresenceService::setStatus(uint32_t id, PresenceStatus status) {
+    auto it = members.find(id);
+    if (it == members.end() || it->second.status == status) {
+        return;
+    }
+    touch(id);
+    it->second.status = status;
+}
+
+/**
+ * Builds the delta between the last flush and now.
+ *
+ * @param delta Receives the PLAYER_JOINED packet
+ * @return false if the members' net state is unchanged (nothing to send)
+ */
+bool PresenceService::flushDelta(NetworkPacket& delta) {
+    json joined = json::array();
+    json status = json::array();
+    json left = json::array();
+
+    for (const auto& [id, before] : flushedState) {
+        auto it = members.find(id);
+        if (it == members.end()) {
+            if (before) {
+                left.push_back(id);
+            }
+        } else if (!before) {
+            joined.push_back(memberEntry(it->second));
+        } else if (before->status != it->second.status) {
+            status.push_back(json::array({id, static_cast<int>(it->second.status)}));
+        }
+    }
+    flushedState.clear();
+
+    if (joined.empty() && status.empty() && left.empty()) {
+        return false;
+    }
+
+    delta.type = PacketType::PLAYER_JOINED;
+    delta.data = json::object();
+    delta.data["from"] = version;
+    delta.data["version"] = ++version;
+    if (!joined.empty()) delta.data["join"] = joined;
+    if (!status.empty()) delta.data["status"] = status;
+    if (!left.empty()) delta.data["leave"] = left;
+    return true;
+}
+
+/**
+ * Full member list at the last flushed version. Changes still pending are not
+ * included; they arrive with the next delta, which follows on from this version.
+ */
+NetworkPacket PresenceService::snapshot() const {
+    std::unordered_map<uint32_t, PresenceMember> flushed = members;
+    for (const auto& [id, before] : flushedState) {
+        if (before) {
+            flushed[id] = *before;
+        } else {
+            flushed.erase(id);
+        }
+    }
+
+    json entries = json::array();
+    for (const auto& member : sortedMembers(flushed)) {
+        entries.push_back(memberEntry(member));
+    }
+
+    NetworkPacket packet;
+    packet.type = PacketType::PLAYER_JOINED;
+    packet.data["version"] = version;
+    packet.data["members"] = entries;
+    return packet;
+}
+
+std::vector<PresenceMember> PresenceService::getMembers() const {
+    return sortedMembers(members);
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Client
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Applies a PLAYER_JOINED snapshot or delta.
+ *
+ * @param packet The packet from the server
+ * @param joinedNames If set, receives the names of members a delta added
+ * @return NEEDS_SNAPSHOT if a delta does not follow on from the current version
+ */
+PresenceView::ApplyResult PresenceView::apply(const NetworkPacket& packet, std::vector<std::string>* joinedNames) {
+    const json& data = packet.data;
+    if (!data.contains("version")) {
+        return ApplyResult::IGNORED;
+    }
+    uint32_t packetVersion = data.value("version", 0u);
+
+    if (data.contains("members")) {
+        members.clear();
+        for (const auto& entry : data["members"]) {
+            if (entry.is_array() && entry.size() == 3) {
+                uint32_t id = entry[0].get<uint32_t>();
+                members[id] = PresenceMember{id, entry[1].get<std::string>(), toPresenceStatus(entry[2].get<int>())};
+            }
+        }
+        version = packetVersion;
+        hasSnapshot = true;
+        return ApplyResult::APPLIED;
+    }
+
+    if (!hasSnapshot) {
+        return ApplyResult::IGNORED;    // Requested snapshot still on its way
+    }
+    uint32_t from = data.value("from", 0u);
+    if (from < version) {
+        return ApplyResult::IGNORED;
+    }
+    if (from != version) {
+        hasSnapshot = false;
+        return ApplyResult::NEEDS_SNAPSHOT;
+    }
+
+    for (const auto& entry : data.value("join", json::array())) {
+        if (entry.is_array() && entry.size() == 3) {
+            uint32_t id = entry[0].get<uint32_t>();
+            members[id] = PresenceMember{id, entry[1].get<std::string>(), toPresenceStatus(entry[2].get<int>())};
+            if (joinedNames) {
+                joinedNames->push_back(members[id].name);
+            }
+        }
+    }
+    for (const auto& entry : data.value("status", json::array())) {
+        if (entry.is_array() && entry.size() == 2) {
+            auto it = members.find(entry[0].get<uint32_t>());
+            if (it != members.end()) {
+                it->second.status = toPresenceStatus(entry[1].get<int>());
+            }
+        }
+    }
+    for (const auto& id : data.value("leave", json::array())) {
+        members.erase(id.get<uint32_t>());
+    }
+    version = packetVersion;
+    return ApplyResult::APPLIED;
+}
+
+std::vector<PresenceMember> PresenceView::getMembers() const {
+    return sortedMembers(members);
+}
+
+void PresenceView::clear() {
+    members.clear();
+    version = 0;
+    hasSnapshot = false;
+}
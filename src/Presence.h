@@ -0,0 +1,72 @@
+#pragma once
+
+#include "NetworkManager.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class PresenceStatus {
+    ONLINE = 0,
+    PLAYING = 1,
+    AWAY = 2
+};
+
+struct PresenceMember {
+    uint32_t id = 0;            // Connection handle on the server (0 = host)
+    std::string name;
+    PresenceStatus status = PresenceStatus::ONLINE;
+};
+
+// Server-side presence (network thread only). Changes are only recorded as they happen;
+// flushDelta() compares each touched member against its state at the previous flush,
+// so a tick's worth of join/leave/status churn becomes at most one entry per member
+// (a join and leave in the same tick, or a status that flips back, cancel out).
+//
+// PLAYER_JOINED payloads (arrays keep them compact):
+//   snapshot: { "version": v, "members": [[id, name, status], ...] }
+//   delta:    { "from": v - 1, "version": v, "join": [[id, name, status], ...],
+//               "status": [[id, status], ...], "leave": [id, ...] }
+class PresenceService {
+public:
+    void join(uint32_t id, const std::string& name, PresenceStatus status = PresenceStatus::ONLINE);
+    void leave(uint32_t id);
+    void setStatus(uint32_t id, PresenceStatus status);
+
+    // Returns false (and leaves the version alone) if nothing observable changed
+    bool flushDelta(NetworkPacket& delta);
+    NetworkPacket snapshot() const;
+
+    std::vector<PresenceMember> getMembers() const;
+    uint32_t getVersion() const { return version; }
+
+private:
+    std::unordered_map<uint32_t, PresenceMember> members;
+    std::unordered_map<uint32_t, std::optional<PresenceMember>> flushedState;  // Touched since the last flush
+    uint32_t version = 0;
+
+    void touch(uint32_t id);
+};
+
+// Client-side mirror of the server's member list
+class PresenceView {
+public:
+    enum class ApplyResult {
+        APPLIED,
+        IGNORED,        // Not a presence payload, or an old delta
+        NEEDS_SNAPSHOT  // Missed a delta: ask the server for a snapshot
+    };
+
+    ApplyResult apply(const NetworkPacket& packet, std::vector<std::string>* joinedNames = nullptr);
+    std::vector<PresenceMember> getMembers() const;
+    void clear();
+
+private:
+    std::unordered_map<uint32_t, PresenceMember> members;
+    uint32_t version = 0;
+    bool hasSnapshot = false;
+};
+
+const char* presenceStatusName(PresenceStatus status);
+PresenceStatus toPresenceStatus(int value);     // Unknown (e.g. wire) values read as ONLINE
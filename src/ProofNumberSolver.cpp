@@ -0,0 +1,347 @@
+/*******************************************************************************
+ * ProofNumberSolver.cpp
+ *
+ * Exact solver for Board positions using depth-first proof-number search (df-pn).
+ * Used for checking puzzles and variants where a heuristic score is not enough.
+ *
+ * Architecture:
+ * - Two df-pn runs decide the exact value: first "side to move wins", and if that
+ *   is disproven, "opponent wins" (disproven again => draw)
+ * - Proof/disproof numbers are kept in a fixed-size table (sized from the memory
+ *   limit) with 4-entry buckets; solved entries are never evicted for unsolved ones
+ * - A search also hands its numbers back to the parent, which keeps the last known
+ *   numbers of every child, so a store the full table drops loses no progress
+ * - One solver instance per thread; batch mode runs one solver per core
+ ******************************************************************************/
+
+#include "ProofNumberSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+constexpr int BUCKET_SIZE = 4;
+
+// Distinguishes the "X attacks" and "O attacks" runs in the table
+constexpr uint64_t ATTACKER_O_KEY = 0x6A09E667F3BCC909ULL;
+
+TileState opponentOf(TileState side) {
+    return side == TileState::X ? TileState::O : TileState::X;
+}
+
+uint32_t saturatingAdd(uint32_t a, uint32_t b, uint32_t limit) {
+    return (a >= limit || b >= limit || a + b >= limit) ? limit : a + b;
+}
+
+} // namespace
+
+/*-----------------------------------------------------------------------------
+ *                          Construction
+ *---------------------------------------------------------------------------*/
+
+ProofNumberSolver::ProofNumberSolver(const SolverConfig& config)
+    : config(config) {
+    size_t entries = std::max<size_t>(1, config.memoryMB) * 1024 * 1024 / sizeof(Entry);
+    size_t powerOfTwo = BUCKET_SIZE;
+    while (powerOfTwo * 2 <= entries) {
+        powerOfTwo *= 2;
+    }
+
+    table = std::make_unique<Entry[]>(powerOfTwo);
+    // Mask selects the first entry of a bucket
+    tableMask = (powerOfTwo - 1) & ~static_cast<uint64_t>(BUCKET_SIZE - 1);
+    clearTable();
+}
+
+ProofNumberSolver::~ProofNumberSolver() = default;
+
+void ProofNumberSolver::clearTable() {
+    std::fill(table.get(), table.get() + tableMask + BUCKET_SIZE, Entry{0, 0, 0});
+}
+
+const char* ProofNumberSolver::outcomeName(SolveOutcome outcome) {
+    switch (outcome) {
+        case SolveOutcome::WIN: return "WIN";
+        case SolveOutcome::DRAW: return "DRAW";
+        case SolveOutcome::LOSS: return "LOSS";
+        default: return "UNKNOWN";
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Solving
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Solves the position exactly.
+ *
+ * @param board The position to solve (not modified)
+ * @param toMove The side to move
+ * @return SolveResult with the outcome for the side to move and a move achieving it
+ */
+SolveResult ProofNumberSolver::solve(const Board& board, TileState toMove) {
+    auto start = std::chrono::steady_clock::now();
+    SolveResult result;
+    Board work = board;
+    nodes = 0;
+    aborted = false;
+
+    GameResult state = work.checkWinner();
+    if (state != GameResult::IN_PROGRESS) {
+        // Game already over: the previous mover won, or it is a draw
+        result.outcome = state == GameResult::DRAW ? SolveOutcome::DRAW : SolveOutcome::LOSS;
+    } else if (prove(work, toMove, toMove)) {
+        result.outcome = SolveOutcome::WIN;
+    } else if (!aborted && prove(work, toMove, opponentOf(toMove))) {
+        result.outcome = SolveOutcome::LOSS;
+    } else if (!aborted) {
+        result.outcome = SolveOutcome::DRAW;
+    }
+
+    // Pick a move that realizes the outcome from the last run's table
+    if (result.outcome == SolveOutcome::WIN || result.outcome == SolveOutcome::DRAW) {
+        attacker = result.outcome == SolveOutcome::WIN ? toMove : opponentOf(toMove);
+        attackerKey = attacker == TileState::O ? ATTACKER_O_KEY : 0;
+
+        int size = work.getSize();
+        for (int y = 0; y < size && result.bestX < 0; y++) {
+            for (int x = 0; x < size && result.bestX < 0; x++) {
+                if (work.getTile(x, y) != TileState::EMPTY) {
+                    continue;
+                }
+                work.setTile(x, y, toMove);
+                uint32_t pn = 1;
+                uint32_t dn = 1;
+                if (!evaluateTerminal(work, pn, dn)) {
+                    lookup(work, pn, dn);
+                }
+                work.clearTile(x, y);
+
+                // WIN: child proven for us; DRAW: child disproven for the opponent
+                bool good = result.outcome == SolveOutcome::WIN ? pn == 0 : dn == 0;
+                if (good) {
+                    result.bestX = x;
+                    result.bestY = y;
+                }
+            }
+        }
+    }
+
+    result.nodes = nodes;
+    result.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+/**
+ * Runs df-pn from the root trying to prove a forced win for attackingSide.
+ *
+ * @param board The root position (restored before returning)
+ * @param toMove The side to move at the root
+ * @param attackingSide The side whose win we try to prove
+ * @return true if proven; false if disproven or aborted (check 'aborted')
+ */
+bool ProofNumberSolver::prove(Board& board, TileState toMove, TileState attackingSide) {
+    attacker = attackingSide;
+    attackerKey = attacker == TileState::O ? ATTACKER_O_KEY : 0;
+
+    uint32_t pn = 1;
+    uint32_t dn = 1;
+    multipleIterativeDeepening(board, toMove, INFINITE_PN, INFINITE_PN, pn, dn);
+    return pn == 0;
+}
+
+/**
+ * Multiple iterative deepening (MID) step of df-pn: expands the most-proving child
+ * until the node's proof or disproof number reaches its threshold.
+ *
+ * @param board The current position (restored before returning)
+ * @param side The side to move
+ * @param thresholdPn Proof number threshold
+ * @param thresholdDn Disproof number threshold
+ * @param pn In: the node's last known proof number; out: its proof number after the search
+ * @param dn In: the node's last known disproof number; out: its disproof number after the search
+ */
+void ProofNumberSolver::multipleIterativeDeepening(Board& board, TileState side,
+                                                   uint32_t thresholdPn, uint32_t thresholdDn,
+                                                   uint32_t& pn, uint32_t& dn) {
+    nodes++;
+    if (config.maxNodes > 0 && nodes > config.maxNodes) {
+        aborted = true;
+    }
+    if (aborted) {
+        return;
+    }
+
+    if (evaluateTerminal(board, pn, dn)) {
+        store(board, pn, dn);
+        return;
+    }
+
+    bool orNode = side == attacker;
+    int size = board.getSize();
+
+    std::vector<int> children;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            if (board.getTile(x, y) == TileState::EMPTY) {
+                children.push_back(y * size + x);
+            }
+        }
+    }
+
+    // Unvisited children start at 1/1
+    std::vector<uint32_t> childPn(children.size(), 1);
+    std::vector<uint32_t> childDn(children.size(), 1);
+    for (size_t i = 0; i < children.size(); i++) {
+        int x = children[i] % size;
+        int y = children[i] / size;
+        board.setTile(x, y, side);
+        evaluateTerminal(board, childPn[i], childDn[i]);
+        board.clearTile(x, y);
+    }
+
+    while (true) {
+        // Refresh child numbers from the table (transpositions may have moved them); a
+        // child the table dropped keeps the numbers its last search handed back
+        for (size_t i = 0; i < children.size(); i++) {
+            int x = children[i] % size;
+            int y = children[i] / size;
+            board.setTile(x, y, side);
+            lookup(board, childPn[i], childDn[i]);
+            board.clearTile(x, y);
+        }
+
+        // OR node: pn = min(child pn), dn = sum(child dn); AND node is the dual
+        const std::vector<uint32_t>& selectBy = orNode ? childPn : childDn;
+        const std::vector<uint32_t>& sumOf = orNode ? childDn : childPn;
+
+        size_t best = 0;
+        uint32_t bestValue = INFINITE_PN;
+        uint32_t secondValue = INFINITE_PN;
+        uint32_t sum = 0;
+        for (size_t i = 0; i < children.size(); i++) {
+            if (selectBy[i] < bestValue) {
+                secondValue = bestValue;
+                bestValue = selectBy[i];
+                best = i;
+            } else if (selectBy[i] < secondValue) {
+                secondValue = selectBy[i];
+            }
+            sum = saturatingAdd(sum, sumOf[i], INFINITE_PN);
+        }
+
+        pn = orNode ? bestValue : sum;
+        dn = orNode ? sum : bestValue;
+        store(board, pn, dn);
+
+        if (pn >= thresholdPn || dn >= thresholdDn || aborted) {
+            return;
+        }
+
+        // Child thresholds
+        uint32_t childThresholdPn;
+        uint32_t childThresholdDn;
+        if (orNode) {
+            childThresholdPn = std::min(thresholdPn, saturatingAdd(secondValue, 1, INFINITE_PN));
+            childThresholdDn = saturatingAdd(thresholdDn - dn, childDn[best], INFINITE_PN);
+        } else {
+            childThresholdPn = saturatingAdd(thresholdPn - pn, childPn[best], INFINITE_PN);
+            childThresholdDn = std::min(thresholdDn, saturatingAdd(secondValue, 1, INFINITE_PN));
+        }
+
+        int x = children[best] % size;
+        int y = children[best] / size;
+        board.setTile(x, y, side);
+        multipleIterativeDeepening(board, opponentOf(side), childThresholdPn, childThresholdDn,
+                                   childPn[best], childDn[best]);
+        board.clearTile(x, y);
+    }
+}
+
+/**
+ * Evaluates finished games: attacker win is proven (0/inf), anything else is
+ * disproven (inf/0) since the attacker needs a win.
+ *
+ * @return true if the position is terminal (pn/dn set)
+ */
+bool ProofNumberSolver::evaluateTerminal(const Board& board, uint32_t& pn, uint32_t& dn) const {
+    GameResult result = board.checkWinner();
+    if (result == GameResult::IN_PROGRESS) {
+        return false;
+    }
+
+    bool attackerWon = (result == GameResult::X_WINS && attacker == TileState::X) ||
+                       (result == GameResult::O_WINS && attacker == TileState::O);
+    pn = attackerWon ? 0 : INFINITE_PN;
+    dn = attackerWon ? INFINITE_PN : 0;
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Proof-Number Table
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Reads the proof/disproof numbers of a position; leaves pn/dn untouched on a miss.
+ */
+void ProofNumberSolver::lookup(const Board& board, uint32_t& pn, uint32_t& dn) const {
+    uint64_t key = keyFor(board);
+    const Entry* bucket = &table[key & tableMask];
+
+    for (int i = 0; i < BUCKET_SIZE; i++) {
+        if (bucket[i].key == key && (bucket[i].pn != 0 || bucket[i].dn != 0)) {
+            pn = bucket[i].pn;
+            dn = bucket[i].dn;
+            return;
+        }
+    }
+}
+
+/**
+ * Stores the proof/disproof numbers of a position. When the bucket is full the
+ * unsolved entry with the least work (pn + dn) is replaced; solved entries survive.
+ */
+void ProofNumberSolver::store(const Board& board, uint32_t pn, uint32_t dn) {
+    uint64_t key = keyFor(board);
+    Entry* bucket = &table[key & tableMask];
+    Entry* victim = nullptr;
+    uint64_t victimWork = UINT64_MAX;
+
+    for (int i = 0; i < BUCKET_SIZE; i++) {
+        Entry& entry = bucket[i];
+        bool empty = entry.pn == 0 && entry.dn == 0;
+
+        if (entry.key == key && !empty) {
+            victim = &entry;
+            break;
+        }
+        if (empty) {
+            victim = &entry;
+            victimWork = 0;
+            continue;
+        }
+
+        if (entry.pn == 0 || entry.dn == 0) {
+            continue; // Solved positions are only replaced by other solutions
+        }
+        uint64_t work = static_cast<uint64_t>(entry.pn) + entry.dn;
+        if (work < victimWork) {
+            victim = &entry;
+            victimWork = work;
+        }
+    }
+
+    // Every slot holds a solved position: keep them unless we are storing a solution
+    if (!victim) {
+        if (pn != 0 && dn != 0) {
+            return;
+        }
+        victim = &bucket[key % BUCKET_SIZE];
+    }
+
+    victim->key = key;
+    victim->pn = pn;
+    victim->dn = dn;
+}
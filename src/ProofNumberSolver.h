@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Board.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Exact game-theoretic value, from the perspective of the side to move
+enum class SolveOutcome {
+    WIN = 0,
+    DRAW = 1,
+    LOSS = 2,
+    UNKNOWN = 3 // Node or memory budget exhausted
+};
+
+struct SolverConfig {
+    size_t memoryMB = 64;       // Size of the proof-number table
+    uint64_t maxNodes = 0;      // 0 = unlimited
+};
+
+struct SolveResult {
+    SolveOutcome outcome = SolveOutcome::UNKNOWN;
+    int bestX = -1;             // Winning move (WIN) or drawing move (DRAW), -1 otherwise
+    int bestY = -1;
+    uint64_t nodes = 0;
+    double elapsedMs = 0.0;
+};
+
+class ProofNumberSolver {
+public:
+    explicit ProofNumberSolver(const SolverConfig& config = SolverConfig());
+    ~ProofNumberSolver();
+
+    SolveResult solve(const Board& board, TileState toMove);
+
+    static const char* outcomeName(SolveOutcome outcome);
+
+private:
+    static constexpr uint32_t INFINITE_PN = 1u << 30;
+
+    struct Entry {
+        uint64_t key;
+        uint32_t pn;
+        uint32_t dn;
+    };
+
+    SolverConfig config;
+    std::unique_ptr<Entry[]> table;
+    uint64_t tableMask = 0;
+
+    TileState attacker = TileState::X;
+    uint64_t attackerKey = 0;
+    uint64_t nodes = 0;
+    bool aborted = false;
+
+    bool prove(Board& board, TileState toMove, TileState attackingSide);
+    void multipleIterativeDeepening(Board& board, TileState side, uint32_t thresholdPn, uint32_t thresholdDn,
+                                    uint32_t& pn, uint32_t& dn);
+
+    bool evaluateTerminal(const Board& board, uint32_t& pn, uint32_t& dn) const;
+    void lookup(const Board& board, uint32_t& pn, uint32_t& dn) const;
+    void store(const Board& board, uint32_t pn, uint32_t dn);
+    void clearTable();
+
+    uint64_t keyFor(const Board& board) const { return board.getHash() ^ attackerKey; }
+};
@@ -0,0 +1,144 @@
+/*******************************************************************************
+ * Protocol.cpp
+ *
+ * Protocol version and capability negotiation.
+ *
+ * Architecture:
+ * - The client offers its version range and, per option, what it supports in
+ *   order of preference; the server walks its own preference list and takes
+ *   the first entry the client also offered
+ * - Options are exchanged by name; unknown names are skipped, so new codecs or
+ *   compressors can be rolled out one build at a time
+ * - A peer that never says hello (an older build) keeps the defaults of
+ *   ProtocolSession: JSON, no compression
+ ******************************************************************************/
+
+#include "Protocol.h"
+#include <algorithm>
+
+using json = nlohmann::json;
+
+namespace {
+
+const char* compressionName(Compression compression) {
+    switch (compression) {
+        default: return "none";
+    }
+}
+
+template <typename T>
+std::optional<T> fromName(const std::string& name, std::initializer_list<T> values, const char* (*toName)(T)) {
+    for (T value : values) {
+        if (name == toName(value)) {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<Codec> codecFromName(const std::string& name) {
+    return fromName(name, {Codec::BINARY, Codec::JSON}, Protocol::codecName);
+}
+
+std::optional<Compression> compressionFromName(const std::string& name) {
+    return fromName(name, {Compression::NONE}, compressionName);
+}
+
+// First of our preferences that the peer also listed
+template <typename T>
+std::optional<T> pickCommon(const std::vector<T>& preferences, const json& offered,
+                            std::optional<T> (*parse)(const std::string&)) {
+    if (!offered.is_array()) {
+        return std::nullopt;
+    }
+    for (T candidate : preferences) {
+        for (const auto& name : offered) {
+            if (name.is_string() && parse(name.get<std::string>()) == candidate) {
+                return candidate;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+const char* Protocol::codecName(Codec codec) {
+    switch (codec) {
+        case Codec::BINARY: return "binary";
+        default:            return "json";
+    }
+}
+
+Capabilities Protocol::local() {
+    Capabilities capabilities;
+    capabilities.version = VERSION;
+    capabilities.minVersion = MIN_VERSION;
+    capabilities.codecs = {Codec::BINARY, Codec::JSON};
+    capabilities.compression = {Compression::NONE};
+    capabilities.lanes = true;
+    return capabilities;
+}
+
+json Protocol::hello(const Capabilities& capabilities) {
+    json codecs = json::array();
+    for (Codec codec : capabilities.codecs) {
+        codecs.push_back(codecName(codec));
+    }
+    json compression = json::array();
+    for (Compression method : capabilities.compression) {
+        compression.push_back(compressionName(method));
+    }
+    return {{"version", capabilities.version},
+            {"minVersion", capabilities.minVersion},
+            {"codecs", codecs},
+            {"compression", compression},
+            {"lanes", capabilities.lanes}};
+}
+
+/**
+ * Picks the session for a connection from the client's hello.
+ *
+ * @param local The server's capabilities
+ * @param hello The client's "hello" object
+ * @param reason Set if negotiation fails
+ * @return The session, or nullopt if the two ends have no version in common
+ */
+std::optional<ProtocolSession> Protocol::negotiate(const Capabilities& local, const json& hello, std::string& reason) {
+    uint32_t peerVersion = hello.value("version", 0u);
+    uint32_t peerMinVersion = hello.value("minVersion", peerVersion);
+
+    ProtocolSession session;
+    session.version = std::min(local.version, peerVersion);
+    if (session.version < std::max(local.minVersion, peerMinVersion)) {
+        reason = "Incompatible protocol: server " + std::to_string(local.minVersion) + "-" +
+                 std::to_string(local.version) + ", client " + std::to_string(peerMinVersion) + "-" +
+                 std::to_string(peerVersion);
+        return std::nullopt;
+    }
+
+    // Every build speaks JSON and uncompressed, so those are the fallbacks
+    session.negotiated = true;
+    session.codec = pickCommon(local.codecs, hello.value("codecs", json::array()), codecFromName).value_or(Codec::JSON);
+    session.compression = pickCommon(local.compression, hello.value("compression", json::array()), compressionFromName)
+                              .value_or(Compression::NONE);
+    session.lanes = local.lanes && hello.value("lanes", false);
+    return session;
+}
+
+json Protocol::accept(const ProtocolSession& session) {
+    return {{"version", session.version},
+            {"codec", codecName(session.codec)},
+            {"compression", compressionName(session.compression)},
+            {"lanes", session.lanes}};
+}
+
+ProtocolSession Protocol::accepted(const json& accept) {
+    ProtocolSession session;
+    session.negotiated = true;
+    session.version = accept.value("version", session.version);
+    session.codec = codecFromName(accept.value("codec", std::string())).value_or(Codec::JSON);
+    session.compression = compressionFromName(accept.value("compression", std::string())).value_or(Compression::NONE);
+    session.lanes = accept.value("lanes", false);
+    return session;
+}
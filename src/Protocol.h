@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Wire encodings of a NetworkPacket. Receivers tell them apart by the first byte
+// (JSON text always starts with '{', a MessagePack map never does), so switching
+// codec never has to be synchronized with the message stream.
+enum class Codec : uint8_t {
+    JSON,       // Human-readable; what every build speaks, and handy for debugging
+    BINARY      // MessagePack encoding of the same document
+};
+
+enum class Compression : uint8_t {
+    NONE
+};
+
+// What one end supports, each list in order of preference (fastest first)
+struct Capabilities {
+    uint32_t version = 0;
+    uint32_t minVersion = 0;
+    std::vector<Codec> codecs;
+    std::vector<Compression> compression;
+    bool lanes = false;
+};
+
+// What a connection agreed on. The defaults are the pre-handshake protocol, which
+// stays in use with peers that never send a hello.
+struct ProtocolSession {
+    bool negotiated = false;
+    uint32_t version = 1;
+    Codec codec = Codec::JSON;
+    Compression compression = Compression::NONE;
+    bool lanes = true;
+};
+
+// Version and capability handshake, run once per connection right after it is up:
+//
+//   client -> server   HANDSHAKE { "hello": { "version", "minVersion", "codecs": [...],
+//                                             "compression": [...], "lanes" }, "resume", "room" }
+//   server -> client   HANDSHAKE { "accept": { "version", "codec", "compression", "lanes" } }
+//                   or HANDSHAKE { "reject": reason }, then the server closes the connection
+//
+// Options travel as names, so a build simply ignores the ones it does not know.
+// Handshake packets themselves are always JSON.
+class Protocol {
+public:
+    static constexpr uint32_t VERSION = 4;      // 1: JSON only, no handshake; 2: handshake; 3: heartbeats; 4: redirects
+    static constexpr uint32_t MIN_VERSION = 1;
+    static constexpr uint32_t HEARTBEAT_VERSION = 3;
+    static constexpr uint32_t REDIRECT_VERSION = 4;     // Follows REDIRECT (room migration, the router)
+    static constexpr size_t CODEC_COUNT = 2;
+
+    static Capabilities local();
+
+    static nlohmann::json hello(const Capabilities& capabilities);
+    // Server side: the fastest options both ends support, or nullopt (with a reason) if the versions do not overlap
+    static std::optional<ProtocolSession> negotiate(const Capabilities& local, const nlohmann::json& hello,
+                                                    std::string& reason);
+    static nlohmann::json accept(const ProtocolSession& session);
+    // Client side: the session the server picked
+    static ProtocolSession accepted(const nlohmann::json& accept);
+
+    static const char* codecName(Codec codec);
+};
@@ -0,0 +1,401 @@
+/*******************************************************************************
+ * RoomMigration.cpp
+ *
+ * Room checkpoints and their transfer between server processes on one host.
+ *
+ * Architecture:
+ * - The checkpoint is the compact form the wire protocol already uses for a
+ *   full state sync (position index, player to move, sequence), plus the
+ *   room's name and seats (resume token and mark each); a few dozen bytes
+ *   of JSON
+ * - One Unix domain socket per game port, mode 0600 in a 0700 directory of
+ *   this user's under the temp directory
+ * - Both ends live on network threads, which must keep up their heartbeats:
+ *   every socket is non-blocking, messages are assembled across polls, and
+ *   either side gives up after TRANSFER_TIMEOUT_MS
+ ******************************************************************************/
+
+#include "RoomMigration.h"
+
+#ifndef _WIN32
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+json RoomCheckpoint::toJson() const {
+    json held = json::array();
+    for (const Seat& seat : seats) {
+        held.push_back({{"token", seat.token}, {"mark", static_cast<int>(seat.mark)}});
+    }
+    return {{"room", room},
+            {"position", position},
+            {"currentPlayer", static_cast<int>(currentPlayer)},
+            {"sequence", sequence},
+            {"seats", held}};
+}
+
+std::optional<RoomCheckpoint> RoomCheckpoint::fromJson(const json& data) {
+    if (!data.is_object() || !data.contains("position") || !data.contains("currentPlayer")) {
+        return std::nullopt;
+    }
+    try {
+        RoomCheckpoint checkpoint;
+        checkpoint.position = data["position"].get<uint32_t>();
+        int player = data["currentPlayer"].get<int>();
+        if (player != static_cast<int>(TileState::X) && player != static_cast<int>(TileState::O)) {
+            return std::nullopt;
+        }
+        checkpoint.currentPlayer = static_cast<TileState>(player);
+        checkpoint.sequence = data.value("sequence", 0u);
+        checkpoint.room = data.value("room", std::string());
+        for (const auto& seat : data.value("seats", json::array())) {
+            if (!seat.is_object() || !seat.contains("token") || !seat["token"].is_string()) {
+                continue;
+            }
+            int mark = seat.value("mark", 0);
+            if (mark != static_cast<int>(TileState::X) && mark != static_cast<int>(TileState::O)) {
+                mark = static_cast<int>(TileState::EMPTY);
+            }
+            checkpoint.seats.push_back({seat["token"].get<std::string>(), static_cast<TileState>(mark)});
+        }
+        return checkpoint;
+    } catch (const json::exception&) {
+        return std::nullopt;
+    }
+}
+
+#ifndef _WIN32
+
+namespace {
+
+enum class ReadStatus { PENDING, DONE, FAILED };
+
+// Private to this user: another local account must not be able to offer rooms, or answer for a server
+std::optional<std::string> socketDirectory() {
+    const char* base = std::getenv("TMPDIR");
+    std::string directory = std::string(base && *base ? base : "/tmp") + "/ma1-rooms-" + std::to_string(::getuid());
+    if (::mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+        return std::nullopt;
+    }
+    struct stat status;
+    if (::lstat(directory.c_str(), &status) != 0 || !S_ISDIR(status.st_mode) || status.st_uid != ::getuid() ||
+        (status.st_mode & 077) != 0) {
+        return std::nullopt;
+    }
+    return directory;
+}
+
+std::optional<std::string> socketPath(uint16_t port) {
+    std::optional<std::string> directory = socketDirectory();
+    if (!directory) {
+        return std::nullopt;
+    }
+    return *directory + "/room-" + std::to_string(port) + ".sock";
+}
+
+bool makeAddress(const std::string& path, sockaddr_un& address) {
+    address = sockaddr_un{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+void setNonBlocking(int socket) {
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+}
+
+std::string frame(const json& message) {
+    std::string body = message.dump();
+    uint32_t length = static_cast<uint32_t>(body.size());
+    return std::string(reinterpret_cast<const char*>(&length), sizeof(length)) + body;
+}
+
+// Sends as much of outgoing as the socket takes and drops it from the front; false if the peer is gone
+bool sendSome(int socket, std::string& outgoing) {
+    while (!outgoing.empty()) {
+        ssize_t count = ::send(socket, outgoing.data(), outgoing.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (count > 0) {
+            outgoing.erase(0, static_cast<size_t>(count));
+        } else if (count < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+    }
+    return true;
+}
+
+// Reads what has arrived of one length-prefixed message into buffer
+ReadStatus receiveSome(int socket, std::string& buffer, json& message) {
+    char chunk[4096];
+    while (true) {
+        size_t needed = sizeof(uint32_t);
+        if (buffer.size() >= sizeof(uint32_t)) {
+            uint32_t length = 0;
+            std::memcpy(&length, buffer.data(), sizeof(length));
+            if (length > RoomMigration::MAX_MESSAGE_BYTES) {
+                return ReadStatus::FAILED;
+            }
+            needed += length;
+            if (buffer.size() == needed) {
+                message = json::parse(buffer.begin() + sizeof(uint32_t), buffer.end(), nullptr, false);
+                return message.is_discarded() ? ReadStatus::FAILED : ReadStatus::DONE;
+            }
+        }
+
+        ssize_t count = ::recv(socket, chunk, std::min(sizeof(chunk), needed - buffer.size()), MSG_DONTWAIT);
+        if (count > 0) {
+            buffer.append(chunk, static_cast<size_t>(count));
+        } else if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return ReadStatus::PENDING;
+        } else {
+            return ReadStatus::FAILED;
+        }
+    }
+}
+
+} // namespace
+
+bool RoomMigration::isSupported() {
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Source Side
+ *---------------------------------------------------------------------------*/
+
+MigrationTransfer::MigrationTransfer(int socket, uint16_t targetPort, std::string outgoing)
+    : socket(socket)
+    , targetPort(targetPort)
+    , outgoing(std::move(outgoing))
+    , deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(RoomMigration::TRANSFER_TIMEOUT_MS)) {
+}
+
+MigrationTransfer::~MigrationTransfer() {
+    ::close(socket);
+}
+
+/**
+ * Starts handing a room to the server process on targetPort. Connecting to a local
+ * socket completes at once, or fails at once if nobody listens.
+ *
+ * @param targetPort Game port of the destination
+ * @param checkpoint The room
+ * @param error Set if there is nobody to hand the room to
+ * @return The transfer in flight, to poll() on each update
+ */
+std::unique_ptr<MigrationTransfer> MigrationTransfer::start(uint16_t targetPort, const RoomCheckpoint& checkpoint,
+                                                            std::string& error) {
+    std::optional<std::string> path = socketPath(targetPort);
+    sockaddr_un address;
+    if (!path || !makeAddress(*path, address)) {
+        error = "No usable socket directory";
+        return nullptr;
+    }
+
+    int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket < 0) {
+        error = std::strerror(errno);
+        return nullptr;
+    }
+    setNonBlocking(socket);
+    if (::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        error = errno == EAGAIN ? "Server on port " + std::to_string(targetPort) + " is busy"
+                                : "No server on port " + std::to_string(targetPort) + " takes rooms";
+        ::close(socket);
+        return nullptr;
+    }
+    return std::unique_ptr<MigrationTransfer>(new MigrationTransfer(socket, targetPort, frame(checkpoint.toJson())));
+}
+
+MigrationTransfer::Status MigrationTransfer::poll(std::string& error) {
+    if (!sendSome(socket, outgoing)) {
+        error = "Server on port " + std::to_string(targetPort) + " hung up";
+        return Status::FAILED;
+    }
+
+    json answer;
+    ReadStatus read = outgoing.empty() ? receiveSome(socket, incoming, answer) : ReadStatus::PENDING;
+    if (read == ReadStatus::PENDING) {
+        if (std::chrono::steady_clock::now() < deadline) {
+            return Status::PENDING;
+        }
+        error = "No answer from port " + std::to_string(targetPort);
+        return Status::FAILED;
+    }
+    if (read == ReadStatus::FAILED || !answer.is_object()) {
+        error = "No answer from port " + std::to_string(targetPort);
+        return Status::FAILED;
+    }
+    if (!answer.value("accepted", false)) {
+        error = answer.value("reason", std::string("Declined"));
+        return Status::FAILED;
+    }
+    return Status::ACCEPTED;
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Destination Side
+ *---------------------------------------------------------------------------*/
+
+MigrationListener::MigrationListener(int listenSocket, std::string path)
+    : listenSocket(listenSocket)
+    , path(std::move(path)) {
+}
+
+MigrationListener::~MigrationListener() {
+    closePeer();
+    ::close(listenSocket);
+    ::unlink(path.c_str());
+}
+
+std::unique_ptr<MigrationListener> MigrationListener::create(uint16_t port) {
+    std::optional<std::string> path = socketPath(port);
+    sockaddr_un address;
+    if (!path || !makeAddress(*path, address)) {
+        return nullptr;
+    }
+
+    int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket < 0) {
+        return nullptr;
+    }
+    // A socket file nobody answers on is left over from a crashed server
+    if (::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        ::close(socket);
+        return nullptr;
+    }
+    ::unlink(path->c_str());
+
+    if (::bind(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::chmod(path->c_str(), 0600) != 0 || ::listen(socket, 4) != 0) {
+        ::close(socket);
+        ::unlink(path->c_str());
+        return nullptr;
+    }
+    setNonBlocking(socket);
+    return std::unique_ptr<MigrationListener>(new MigrationListener(socket, *path));
+}
+
+/**
+ * Takes in a checkpoint, a piece at a time: the source sends it right after
+ * connecting, and a peer that has not finished within TRANSFER_TIMEOUT_MS is dropped.
+ */
+std::optional<RoomCheckpoint> MigrationListener::poll() {
+    if (offered) {
+        reply(false, "Busy");
+    }
+
+    if (peerSocket < 0) {
+        peerSocket = ::accept(listenSocket, nullptr, nullptr);
+        if (peerSocket < 0) {
+            return std::nullopt;
+        }
+        setNonBlocking(peerSocket);
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RoomMigration::TRANSFER_TIMEOUT_MS);
+    }
+
+    json message;
+    ReadStatus read = receiveSome(peerSocket, incoming, message);
+    if (read == ReadStatus::PENDING) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            closePeer();
+        }
+        return std::nullopt;
+    }
+
+    std::optional<RoomCheckpoint> checkpoint =
+        read == ReadStatus::DONE ? RoomCheckpoint::fromJson(message) : std::nullopt;
+    offered = true;
+    if (!checkpoint) {
+        reply(false, "Malformed checkpoint");
+    }
+    return checkpoint;
+}
+
+/**
+ * Answers the peer and hangs up. The answer is a few dozen bytes into a socket
+ * nothing else has been written to, so it goes out in one non-blocking send.
+ */
+void MigrationListener::reply(bool accepted, const std::string& reason) {
+    if (!offered) {
+        return;
+    }
+    json answer = {{"accepted", accepted}};
+    if (!reason.empty()) {
+        answer["reason"] = reason;
+    }
+    std::string bytes = frame(answer);
+    sendSome(peerSocket, bytes);
+    closePeer();
+}
+
+void MigrationListener::closePeer() {
+    if (peerSocket >= 0) {
+        ::close(peerSocket);
+    }
+    peerSocket = -1;
+    offered = false;
+    incoming.clear();
+}
+
+#else
+
+bool RoomMigration::isSupported() {
+    return false;
+}
+
+MigrationTransfer::MigrationTransfer(int socket, uint16_t targetPort, std::string outgoing)
+    : socket(socket)
+    , targetPort(targetPort)
+    , outgoing(std::move(outgoing)) {
+}
+
+MigrationTransfer::~MigrationTransfer() = default;
+
+std::unique_ptr<MigrationTransfer> MigrationTransfer::start(uint16_t, const RoomCheckpoint&, std::string& error) {
+    error = "Room migration is not supported on this platform";
+    return nullptr;
+}
+
+MigrationTransfer::Status MigrationTransfer::poll(std::string& error) {
+    error = "Room migration is not supported on this platform";
+    return Status::FAILED;
+}
+
+MigrationListener::MigrationListener(int listenSocket, std::string path)
+    : listenSocket(listenSocket)
+    , path(std::move(path)) {
+}
+
+MigrationListener::~MigrationListener() = default;
+
+std::unique_ptr<MigrationListener> MigrationListener::create(uint16_t) {
+    return nullptr;
+}
+
+std::optional<RoomCheckpoint> MigrationListener::poll() {
+    return std::nullopt;
+}
+
+void MigrationListener::reply(bool, const std::string&) {
+}
+
+void MigrationListener::closePeer() {
+}
+
+#endif
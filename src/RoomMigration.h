@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Board.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Everything a server process needs to carry on with a room another one was hosting:
+// its name, the board as a PositionCodec index, whose turn it is, the move sequence (so
+// clients keep counting from where they were) and the seats: each player's resume token
+// and mark, which the new host holds for the players following the room.
+struct RoomCheckpoint {
+    struct Seat {
+        std::string token;
+        TileState mark = TileState::EMPTY;      // EMPTY for a spectator
+    };
+
+    std::string room;                           // As the players named it, for the router
+    uint32_t position = 0;
+    TileState currentPlayer = TileState::X;
+    uint32_t sequence = 0;
+    std::vector<Seat> seats;
+
+    nlohmann::json toJson() const;
+    static std::optional<RoomCheckpoint> fromJson(const nlohmann::json& data);
+};
+
+// Moving a room between game server processes on one machine. The destination (a
+// hosting process nobody has joined yet) listens on a local socket named after its game
+// port, in a directory only this user can enter; the source connects, sends the
+// checkpoint and waits for the answer:
+//
+//   source -> destination   length-prefixed JSON checkpoint
+//   destination -> source   length-prefixed { "accepted": bool, "reason": ... }
+//
+// Both ends run on a network thread, so neither ever blocks: each side is polled once
+// per update and gives up after TRANSFER_TIMEOUT_MS.
+// POSIX only (Unix domain sockets); isSupported() is false on other platforms.
+class RoomMigration {
+public:
+    static constexpr int TRANSFER_TIMEOUT_MS = 1000;
+    static constexpr uint32_t MAX_MESSAGE_BYTES = 64 * 1024;
+
+    static bool isSupported();
+};
+
+// Source side of one handover
+class MigrationTransfer {
+public:
+    enum class Status { PENDING, ACCEPTED, FAILED };
+
+    ~MigrationTransfer();
+
+    MigrationTransfer(const MigrationTransfer&) = delete;
+    MigrationTransfer& operator=(const MigrationTransfer&) = delete;
+
+    // Connects to the server on targetPort and starts sending; nullptr (with a reason)
+    // if nothing listens there
+    static std::unique_ptr<MigrationTransfer> start(uint16_t targetPort, const RoomCheckpoint& checkpoint,
+                                                    std::string& error);
+
+    // Network thread, never blocks: PENDING until the destination has answered. FAILED
+    // (with a reason) if it declined, hung up or did not answer in time.
+    Status poll(std::string& error);
+
+    uint16_t getTargetPort() const { return targetPort; }
+
+private:
+    MigrationTransfer(int socket, uint16_t targetPort, std::string outgoing);
+
+    int socket;
+    uint16_t targetPort;
+    std::string outgoing;       // Not yet sent
+    std::string incoming;       // The answer, as far as it has arrived
+    std::chrono::steady_clock::time_point deadline;
+};
+
+class MigrationListener {
+public:
+    ~MigrationListener();
+
+    MigrationListener(const MigrationListener&) = delete;
+    MigrationListener& operator=(const MigrationListener&) = delete;
+
+    // Listens for rooms sent to the server on port; nullptr if unsupported or the socket is taken
+    static std::unique_ptr<MigrationListener> create(uint16_t port);
+
+    // Network thread, never blocks: a checkpoint once one has fully arrived. Every offer
+    // must be answered with reply() before the next poll().
+    std::optional<RoomCheckpoint> poll();
+    void reply(bool accepted, const std::string& reason = std::string());
+
+private:
+    MigrationListener(int listenSocket, std::string path);
+
+    void closePeer();
+
+    int listenSocket;
+    int peerSocket = -1;
+    bool offered = false;       // The peer's checkpoint went out through poll()
+    std::string incoming;
+    std::chrono::steady_clock::time_point deadline;
+    std::string path;
+};
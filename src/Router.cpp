@@ -0,0 +1,539 @@
+/*******************************************************************************
+ * Router.cpp
+ *
+ * Front door for a pool of game servers on one machine: clients connect to the
+ * router's public port and are sent on to the server that owns their room, so
+ * capacity grows by starting more servers without clients knowing about them.
+ *
+ * Usage: MA1Router <publicPort> <backendPort> [backendPort...]
+ *
+ * Architecture:
+ * - A game server is one board, so it hosts one room (named in the client's
+ *   hello; unnamed clients share the default room) and a room is wherever it
+ *   is: the router keeps an ownership map from room to backend, not a formula
+ * - A room's first player claims it a free backend, tried in the order of the
+ *   room's preference list on a consistent-hash ring, so rooms spread evenly
+ *   and a backend starting or stopping leaves the other claims alone
+ * - Every HEALTH_CHECK_MS the router pings each backend (HealthCheck.h) and
+ *   gets back its room and load. The reports confirm the claims; a room that
+ *   migrated is reported by its new server, and by the old one until it stops;
+ *   a claim nobody confirms for CLAIM_TIMEOUT_MS is given up
+ * - The router never relays game traffic: it reads the hello, looks the room
+ *   up and answers with a REDIRECT to the backend's port, passing the client's
+ *   resume token through. Client and backend then talk directly (over shared
+ *   memory when the client is on this machine too), so the router costs a
+ *   player one round trip and is off the data path for the rest of the game
+ * - Clients too old to follow a redirect, and hellos that are not what a
+ *   client sends, are refused as soon as they arrive
+ ******************************************************************************/
+
+#include "HashRing.h"
+#include "HealthCheck.h"
+#include "NetworkManager.h"
+#include "Protocol.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+std::atomic<bool> g_running{true};
+
+void onSignal(int) {
+    g_running = false;
+}
+
+// Fields of a peer's JSON object: missing or of another type is nullopt, never an exception
+std::optional<std::string> stringField(const json& object, const char* key) {
+    if (!object.contains(key) || !object[key].is_string()) {
+        return std::nullopt;
+    }
+    return object[key].get<std::string>();
+}
+
+std::optional<uint64_t> unsignedField(const json& object, const char* key) {
+    if (!object.contains(key) || !object[key].is_number_unsigned()) {
+        return std::nullopt;
+    }
+    return object[key].get<uint64_t>();
+}
+
+class Router {
+public:
+    static constexpr int HELLO_TIMEOUT_MS = 5000;   // Connected but silent: dropped
+    static constexpr int HEALTH_CHECK_MS = 1000;
+    static constexpr int CLAIM_TIMEOUT_MS = 10000;  // A room's backend not reporting it this long: unclaimed
+    static constexpr int REPORT_MS = 5000;
+    static constexpr size_t MAX_PENDING = 256;      // Connections waiting for their hello
+
+    Router(uint16_t port, const std::vector<uint16_t>& ports)
+        : port(port) {
+        for (uint16_t backend : ports) {
+            backends[backend];
+        }
+    }
+
+    bool start();
+    void run();
+    void stop();
+
+private:
+    // Running totals, reported as one line per REPORT_MS when they change
+    struct Counters {
+        uint64_t routed = 0;
+        uint64_t refusedBusy = 0;
+        uint64_t refusedVersion = 0;
+        uint64_t refusedMalformed = 0;
+        uint64_t refusedNoBackend = 0;
+        uint64_t abandoned = 0;     // Closed or timed out before saying hello
+
+        bool operator==(const Counters&) const = default;
+    };
+
+    // A game server as its last health report had it
+    struct Backend {
+        bool up = false;
+        std::unique_ptr<HealthProbe> probe;     // Ping in flight
+        std::string room;
+        uint64_t clients = 0;
+        uint64_t held = 0;                      // Seats held for players coming back
+
+        bool occupied() const { return up && (clients > 0 || held > 0); }
+    };
+
+    // Where a room is: claimed when the router sends its first player somewhere, then
+    // confirmed by every report of that backend (or of the one it moved from)
+    struct Owner {
+        uint16_t backend;
+        std::chrono::steady_clock::time_point confirmed;
+    };
+
+    uint16_t port;
+    std::map<uint16_t, Backend> backends;
+    HashRing ring;                                          // The backends that are up
+    std::unordered_map<std::string, Owner> owners;
+    ISteamNetworkingSockets* interface = nullptr;
+    HSteamListenSocket listenSocket = k_HSteamListenSocket_Invalid;
+    HSteamNetPollGroup pollGroup = k_HSteamNetPollGroup_Invalid;
+    std::unordered_map<HSteamNetConnection, std::chrono::steady_clock::time_point> pending;
+    Counters counters;
+    Counters reportedCounters;
+
+    void receiveHellos();
+    void route(HSteamNetConnection connection, const NetworkPacket& packet);
+    void reject(HSteamNetConnection connection, const std::string& reason);
+    void answer(HSteamNetConnection connection, const NetworkPacket& reply);
+    std::optional<uint16_t> place(const std::string& room);
+    void expireHellos(std::chrono::steady_clock::time_point now);
+
+    void pingBackends();
+    void collectPings(std::chrono::steady_clock::time_point now);
+    void applyReport(uint16_t backendPort, Backend& backend, const json& status,
+                     std::chrono::steady_clock::time_point now);
+    void setUp(uint16_t backendPort, Backend& backend, bool up);
+    void expireClaims(std::chrono::steady_clock::time_point now);
+    void report();
+
+    void onConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* info);
+    static void SteamNetConnectionStatusChangedCallback(SteamNetConnectionStatusChangedCallback_t* info);
+};
+
+Router* g_RouterCallback = nullptr;
+
+bool Router::start() {
+    SteamDatagramErrMsg errorMessage;
+    if (!GameNetworkingSockets_Init(nullptr, errorMessage)) {
+        std::cerr << "[ROUTER] Failed to initialize: " << errorMessage << std::endl;
+        return false;
+    }
+    interface = SteamNetworkingSockets();
+    g_RouterCallback = this;
+
+    SteamNetworkingIPAddr address{};
+    address.Clear();
+    address.m_port = port;
+    SteamNetworkingConfigValue_t config;
+    config.SetPtr(k_ESteamNetworkingConfig_Callback_ConnectionStatusChanged, (void*)SteamNetConnectionStatusChangedCallback);
+
+    listenSocket = interface->CreateListenSocketIP(address, 1, &config);
+    pollGroup = interface->CreatePollGroup();
+    if (listenSocket == k_HSteamListenSocket_Invalid || pollGroup == k_HSteamNetPollGroup_Invalid) {
+        std::cerr << "[ROUTER] Failed to listen on port " << port << std::endl;
+        return false;
+    }
+
+    pingBackends();
+    std::cout << "[ROUTER] Listening on port " << port << ", " << backends.size() << " backend(s) configured" << std::endl;
+    return true;
+}
+
+void Router::run() {
+    auto nextHealthCheck = std::chrono::steady_clock::now() + std::chrono::milliseconds(HEALTH_CHECK_MS);
+    auto nextReport = std::chrono::steady_clock::now() + std::chrono::milliseconds(REPORT_MS);
+
+    while (g_running) {
+        interface->RunCallbacks();
+
+        // Reports first, so hellos are routed on the freshest ones
+        auto now = std::chrono::steady_clock::now();
+        collectPings(now);
+        receiveHellos();
+
+        expireHellos(now);
+        if (now >= nextHealthCheck) {
+            expireClaims(now);
+            pingBackends();
+            nextHealthCheck = now + std::chrono::milliseconds(HEALTH_CHECK_MS);
+        }
+        if (now >= nextReport) {
+            report();
+            nextReport = now + std::chrono::milliseconds(REPORT_MS);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+void Router::stop() {
+    if (!interface) {
+        return;
+    }
+    for (const auto& [connection, since] : pending) {
+        interface->CloseConnection(connection, 0, "Router shutting down", false);
+    }
+    pending.clear();
+    for (auto& [backendPort, backend] : backends) {
+        backend.probe.reset();
+    }
+    if (listenSocket != k_HSteamListenSocket_Invalid) {
+        interface->CloseListenSocket(listenSocket);
+    }
+    if (pollGroup != k_HSteamNetPollGroup_Invalid) {
+        interface->DestroyPollGroup(pollGroup);
+    }
+    interface = nullptr;
+    GameNetworkingSockets_Kill();
+    report();
+    std::cout << "[ROUTER] Stopped" << std::endl;
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Routing
+ *---------------------------------------------------------------------------*/
+
+void Router::receiveHellos() {
+    while (true) {
+        ISteamNetworkingMessage* message = nullptr;
+        if (interface->ReceiveMessagesOnPollGroup(pollGroup, &message, 1) <= 0) {
+            break;
+        }
+        // A connection says one thing here; anything after the hello is already being closed
+        HSteamNetConnection connection = message->GetConnection();
+        if (pending.count(connection)) {
+            try {
+                route(connection, NetworkPacket::deserialize(
+                                      std::string(static_cast<const char*>(message->GetData()), message->GetSize())));
+            } catch (const std::exception& e) {
+                std::cerr << "[ROUTER] Malformed packet from " << connection << ": " << e.what() << std::endl;
+                counters.refusedMalformed++;
+                reject(connection, "Malformed packet");
+            }
+        }
+        message->Release();
+    }
+}
+
+/**
+ * Answers a client's hello with a REDIRECT to the backend owning its room (or a
+ * rejection) and closes the connection once the answer is delivered. Every field is
+ * checked before it is used, so a bad hello is refused here instead of timing out.
+ *
+ * @param connection The client
+ * @param packet Its first packet
+ */
+void Router::route(HSteamNetConnection connection, const NetworkPacket& packet) {
+    const json& data = packet.data;
+    bool isHello = packet.type == PacketType::HANDSHAKE && data.contains("hello") && data["hello"].is_object();
+    std::optional<std::string> room = data.contains("room") ? stringField(data, "room") : std::string();
+    std::optional<std::string> resume = data.contains("resume") ? stringField(data, "resume") : std::string();
+    if (!isHello || !room || !resume) {
+        counters.refusedMalformed++;
+        reject(connection, "Expected a hello");
+        return;
+    }
+
+    // No version, or not a number, is a client from before versions
+    uint64_t version = unsignedField(data["hello"], "version").value_or(0);
+    if (version < Protocol::REDIRECT_VERSION) {
+        counters.refusedVersion++;
+        reject(connection, "This server needs protocol v" + std::to_string(Protocol::REDIRECT_VERSION) +
+                               " or newer (client: v" + std::to_string(version) + ")");
+        return;
+    }
+
+    std::optional<uint16_t> backend = place(*room);
+    if (!backend) {
+        counters.refusedNoBackend++;
+        reject(connection, "No game server available");
+        return;
+    }
+
+    // The answer is JSON, which clients accept before any negotiation
+    NetworkPacket reply;
+    reply.type = PacketType::REDIRECT;
+    reply.data["port"] = *backend;
+    if (!resume->empty()) {
+        reply.data["resume"] = *resume;
+    }
+    counters.routed++;
+    answer(connection, reply);
+}
+
+void Router::reject(HSteamNetConnection connection, const std::string& reason) {
+    NetworkPacket reply;
+    reply.type = PacketType::HANDSHAKE;
+    reply.data["reject"] = reason;
+    answer(connection, reply);
+}
+
+void Router::answer(HSteamNetConnection connection, const NetworkPacket& reply) {
+    std::string bytes = reply.serialize();
+    interface->SendMessageToConnection(connection, bytes.data(), static_cast<uint32>(bytes.size()),
+                                       k_nSteamNetworkingSend_Reliable, nullptr);
+    interface->CloseConnection(connection, 0, "Routed", true);
+    pending.erase(connection);
+}
+
+/**
+ * The backend a room is on: its owner while that is up, otherwise the first free
+ * backend in the room's preference order, which the room then claims.
+ *
+ * @param room The room's name, empty for the default room
+ * @return The backend's port; nullopt if every backend is up with another room, or down
+ */
+std::optional<uint16_t> Router::place(const std::string& room) {
+    auto owner = owners.find(room);
+    if (owner != owners.end() && backends[owner->second.backend].up) {
+        return owner->second.backend;
+    }
+
+    for (uint16_t candidate : ring.preference(room)) {
+        const Backend& backend = backends[candidate];
+        bool claimed = std::any_of(owners.begin(), owners.end(),
+                                   [candidate](const auto& entry) { return entry.second.backend == candidate; });
+        if (backend.up && !backend.occupied() && !claimed) {
+            owners[room] = Owner{candidate, std::chrono::steady_clock::now()};
+            printf("[ROUTER] Room \"%s\" placed on port %u\n", room.c_str(), candidate);
+            return candidate;
+        }
+    }
+    return std::nullopt;
+}
+
+void Router::expireHellos(std::chrono::steady_clock::time_point now) {
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (now - it->second > std::chrono::milliseconds(HELLO_TIMEOUT_MS)) {
+            interface->CloseConnection(it->first, 0, "No hello", false);
+            counters.abandoned++;
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Backend Health
+ *---------------------------------------------------------------------------*/
+
+void Router::pingBackends() {
+    for (auto& [backendPort, backend] : backends) {
+        if (backend.probe) {
+            continue;
+        }
+        backend.probe = HealthProbe::start(backendPort);
+        if (!backend.probe) {
+            setUp(backendPort, backend, false);
+        }
+    }
+}
+
+void Router::collectPings(std::chrono::steady_clock::time_point now) {
+    for (auto& [backendPort, backend] : backends) {
+        json status;
+        HealthProbe::Status result = backend.probe ? backend.probe->poll(status) : HealthProbe::Status::PENDING;
+        if (result == HealthProbe::Status::PENDING) {
+            continue;
+        }
+        backend.probe.reset();
+        setUp(backendPort, backend, result == HealthProbe::Status::UP);
+        if (backend.up) {
+            applyReport(backendPort, backend, status, now);
+        }
+    }
+}
+
+/**
+ * Takes in a backend's report. The room of a backend nobody is in is left over from
+ * an earlier game; any other room is confirmed on the backend, or on the one it moved to.
+ */
+void Router::applyReport(uint16_t backendPort, Backend& backend, const json& status,
+                         std::chrono::steady_clock::time_point now) {
+    backend.room = stringField(status, "room").value_or(std::string());
+    backend.clients = unsignedField(status, "clients").value_or(0);
+    backend.held = unsignedField(status, "held").value_or(0);
+    uint64_t movedTo = unsignedField(status, "movedTo").value_or(0);
+
+    if (movedTo != 0 && backends.count(static_cast<uint16_t>(movedTo))) {
+        owners[backend.room] = Owner{static_cast<uint16_t>(movedTo), now};
+    } else if (backend.occupied()) {
+        owners[backend.room] = Owner{backendPort, now};
+    }
+}
+
+// Only the backends that are up are on the ring, so a backend that comes back competes for new rooms again
+void Router::setUp(uint16_t backendPort, Backend& backend, bool up) {
+    if (up == backend.up) {
+        return;
+    }
+    backend.up = up;
+    if (up) {
+        ring.add(backendPort);
+    } else {
+        ring.remove(backendPort);
+        backend.room.clear();
+        backend.clients = 0;
+        backend.held = 0;
+    }
+    printf("[ROUTER] Backend on port %u is %s (%zu in the ring)\n", backendPort, up ? "up" : "down",
+           ring.getNodes().size());
+}
+
+// A room whose backend went down, or that its backend stopped reporting, is over
+void Router::expireClaims(std::chrono::steady_clock::time_point now) {
+    for (auto it = owners.begin(); it != owners.end();) {
+        bool expired = now - it->second.confirmed > std::chrono::milliseconds(CLAIM_TIMEOUT_MS);
+        if (!backends[it->second.backend].up || expired) {
+            it = owners.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Router::report() {
+    if (counters == reportedCounters) {
+        return;
+    }
+    reportedCounters = counters;
+    printf("[ROUTER] Routed %llu; refused %llu busy, %llu old protocol, %llu malformed, %llu without backend; "
+           "abandoned %llu; %zu waiting for hello, %zu room(s)\n",
+           static_cast<unsigned long long>(counters.routed), static_cast<unsigned long long>(counters.refusedBusy),
+           static_cast<unsigned long long>(counters.refusedVersion),
+           static_cast<unsigned long long>(counters.refusedMalformed),
+           static_cast<unsigned long long>(counters.refusedNoBackend),
+           static_cast<unsigned long long>(counters.abandoned), pending.size(), owners.size());
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Connection Status Callbacks
+ *---------------------------------------------------------------------------*/
+
+void Router::SteamNetConnectionStatusChangedCallback(SteamNetConnectionStatusChangedCallback_t* info) {
+    if (g_RouterCallback) {
+        g_RouterCallback->onConnectionStatusChanged(info);
+    }
+}
+
+void Router::onConnectionStatusChanged(SteamNetConnectionStatusChangedCallback_t* info) {
+    HSteamNetConnection connection = info->m_hConn;
+
+    switch (info->m_info.m_eState) {
+        case k_ESteamNetworkingConnectionState_Connecting:
+            if (pending.size() >= MAX_PENDING) {
+                interface->CloseConnection(connection, 0, "Router busy, try again", false);
+                counters.refusedBusy++;
+            } else if (interface->AcceptConnection(connection) != k_EResultOK) {
+                interface->CloseConnection(connection, 0, nullptr, false);
+            } else {
+                // Counted from the accept, so connections that never finish expire too
+                pending[connection] = std::chrono::steady_clock::now();
+            }
+            break;
+
+        case k_ESteamNetworkingConnectionState_Connected:
+            interface->SetConnectionPollGroup(connection, pollGroup);
+            break;
+
+        case k_ESteamNetworkingConnectionState_ClosedByPeer:
+        case k_ESteamNetworkingConnectionState_ProblemDetectedLocally:
+            if (pending.erase(connection) > 0) {
+                counters.abandoned++;
+            }
+            interface->CloseConnection(connection, 0, nullptr, false);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void printUsage(const char* program) {
+    printf("Usage: %s <publicPort> <backendPort> [backendPort...]\n", program);
+    printf("  Sends every client on to the game server on this machine that owns its room.\n");
+    printf("  Clients name the room as \"host:port/room\"; unnamed clients share the default room.\n");
+}
+
+bool parsePort(const char* text, uint16_t& port) {
+    char* end = nullptr;
+    long value = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || value < 1 || value > 65535) {
+        return false;
+    }
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    uint16_t publicPort = 0;
+    std::vector<uint16_t> backends;
+    if (!parsePort(argv[1], publicPort)) {
+        std::cerr << "[ROUTER] Invalid port: " << argv[1] << std::endl;
+        return 1;
+    }
+    for (int i = 2; i < argc; i++) {
+        uint16_t backend = 0;
+        if (!parsePort(argv[i], backend) || backend == publicPort) {
+            std::cerr << "[ROUTER] Invalid backend port: " << argv[i] << std::endl;
+            return 1;
+        }
+        backends.push_back(backend);
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    Router router(publicPort, backends);
+    if (!router.start()) {
+        router.stop();
+        return 1;
+    }
+    router.run();
+    router.stop();
+    return 0;
+}
@@ -0,0 +1,620 @@
+/*******************************************************************************
+ * SearchEngine.cpp
+ *
+ * Alpha-beta (negamax) search over the Board with a shared transposition table.
+ * Used by the analysis tools and any AI player to pick moves.
+ *
+ * Architecture:
+ * - Lazy SMP: every thread runs its own iterative deepening on the same root,
+ *   helper threads skip depths in a staggered pattern so they run ahead of the
+ *   main thread and fill the transposition table with useful entries
+ * - Threads share nothing but the transposition table and the stop flag
+ * - The table is a lock-free TranspositionTable, either owned by the engine or
+ *   shared with other engines/tools
+ * - The result of the main thread (id 0) is the search result
+ * - Positions covered by an attached tablebase are answered exactly without search
+ * - Moves are ordered TT/PV move first, then killer moves, then by history score,
+ *   with the number of lines through a cell (center first) as the static tiebreak
+ * - With an NNUE network attached, each thread keeps an accumulator that is updated
+ *   together with every setTile/clearTile, so leaf evaluation is one dot product
+ ******************************************************************************/
+
+#include "SearchEngine.h"
+#include "Tablebase.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// Depth skipping pattern for helper threads (thread i uses entry (i - 1) % 20).
+// A helper skips depth d when ((d + phase) / size) is odd.
+constexpr int SKIP_SIZE[20]  = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+constexpr int SKIP_PHASE[20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+// Mate scores are stored relative to the node, not the root
+constexpr int MATE_BOUND = SearchEngine::WIN_SCORE - 256;
+
+TileState opponentOf(TileState side) {
+    return side == TileState::X ? TileState::O : TileState::X;
+}
+
+// Ordering score bands: TT/PV move > killers > history (history is capped below them)
+constexpr int ORDER_TT_MOVE = 1 << 30;
+constexpr int ORDER_KILLER = 1 << 29;
+constexpr int HISTORY_MAX = 1 << 24;
+
+/**
+ * Number of winning lines through a cell (center 4, corners 3, edges 2 on 3x3).
+ */
+int linesThrough(int cell, int size) {
+    int x = cell % size;
+    int y = cell / size;
+    return 2 + (x == y ? 1 : 0) + (x + y == size - 1 ? 1 : 0);
+}
+
+} // namespace
+
+/*-----------------------------------------------------------------------------
+ *                          Construction
+ *---------------------------------------------------------------------------*/
+
+SearchEngine::SearchEngine(const SearchConfig& config, std::shared_ptr<TranspositionTable> sharedTable)
+    : config(config)
+    , table(std::move(sharedTable)) {
+    if (!table) {
+        table = std::make_shared<TranspositionTable>(config.ttSizeMB, config.useHugePages);
+    }
+}
+
+SearchEngine::~SearchEngine() = default;
+
+/**
+ * Clears all transposition table entries. Must not be called while a search is running.
+ */
+void SearchEngine::clearTable() {
+    table->clear();
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Search Entry Point
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Searches the given position and returns the best move for the side to move.
+ * Spawns (threadCount - 1) helper threads that search the same root (Lazy SMP)
+ * and share the transposition table with the calling thread.
+ *
+ * @param board The position to search (copied per thread, never modified)
+ * @param toMove The side to move (X or O)
+ * @return SearchResult with the best move, score, completed depth and node statistics
+ */
+SearchResult SearchEngine::findBestMove(const Board& board, TileState toMove) {
+    SearchResult result;
+    searchStart = std::chrono::steady_clock::now();
+    stopFlag = false;
+    table->newSearch();
+
+    if (board.checkWinner() != GameResult::IN_PROGRESS) {
+        return result;
+    }
+
+    // Tablebase hit: exact answer, no search. The tablebase has no distance to mate,
+    // so wins/losses are scored as the slowest possible mate.
+    SolveOutcome outcome;
+    if (tablebase && tablebase->bestMove(board, toMove, result.bestX, result.bestY, outcome)) {
+        int emptyTiles = 0;
+        for (const auto& row : board.getGrid()) {
+            emptyTiles += static_cast<int>(std::count(row.begin(), row.end(), TileState::EMPTY));
+        }
+        result.score = outcome == SolveOutcome::WIN ? WIN_SCORE - emptyTiles
+                     : outcome == SolveOutcome::LOSS ? -(WIN_SCORE - emptyTiles)
+                     : 0;
+        result.depth = emptyTiles;
+        result.elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - searchStart).count();
+        return result;
+    }
+
+    int threadCount = std::max(1, config.threadCount);
+    std::vector<ThreadContext> contexts(threadCount);
+    for (int i = 0; i < threadCount; i++) {
+        contexts[i].id = i;
+    }
+
+    // Helpers first, then the main thread searches on the calling thread
+    std::vector<std::thread> helpers;
+    helpers.reserve(threadCount - 1);
+    for (int i = 1; i < threadCount; i++) {
+        helpers.emplace_back(&SearchEngine::iterativeDeepening, this, board, toMove, std::ref(contexts[i]));
+    }
+
+    iterativeDeepening(board, toMove, contexts[0]);
+
+    // Main thread is done: stop helpers and collect statistics
+    stopFlag = true;
+    for (auto& helper : helpers) {
+        helper.join();
+    }
+
+    const ThreadContext& main = contexts[0];
+    if (main.bestMove != NO_MOVE) {
+        result.bestX = main.bestMove % board.getSize();
+        result.bestY = main.bestMove / board.getSize();
+    }
+    result.score = main.bestScore;
+    result.depth = main.completedDepth;
+    for (const auto& ctx : contexts) {
+        result.nodes += ctx.nodes;
+        result.cutoffs += ctx.cutoffs;
+        result.firstMoveCutoffs += ctx.firstMoveCutoffs;
+        result.tableStats += ctx.tableStats;
+    }
+    result.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - searchStart).count();
+
+    return result;
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Iterative Deepening
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Runs iterative deepening for a single thread. Helper threads skip depths according
+ * to their skip pattern so the threads are staggered across depths.
+ *
+ * @param board Thread-local copy of the root position
+ * @param toMove The side to move at the root
+ * @param ctx Thread context receiving the best move and statistics
+ */
+void SearchEngine::iterativeDeepening(Board board, TileState toMove, ThreadContext& ctx) {
+    int emptyTiles = 0;
+    for (const auto& row : board.getGrid()) {
+        emptyTiles += static_cast<int>(std::count(row.begin(), row.end(), TileState::EMPTY));
+    }
+    int maxDepth = std::min(config.maxDepth, emptyTiles);
+
+    if (network) {
+        network->refresh(board, ctx.accumulator);
+    }
+
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        if (ctx.id > 0) {
+            int slot = (ctx.id - 1) % 20;
+            if (((depth + SKIP_PHASE[slot]) / SKIP_SIZE[slot]) % 2 != 0) {
+                continue;
+            }
+        }
+
+        int move = NO_MOVE;
+        int score = searchRoot(board, toMove, depth, ctx, move);
+
+        // Results of an interrupted iteration are discarded (except the very first)
+        if (stopFlag && ctx.completedDepth > 0) {
+            break;
+        }
+
+        ctx.bestMove = move;
+        ctx.bestScore = score;
+        ctx.completedDepth = depth;
+
+        if (stopFlag) {
+            break;
+        }
+    }
+}
+
+/**
+ * Searches all moves at the root with a full window.
+ *
+ * @param board The root position (restored before returning)
+ * @param side The side to move
+ * @param depth The depth to search in plies
+ * @param ctx Thread context
+ * @param bestMove Receives the index (y * size + x) of the best root move
+ * @return Score of the best move from the perspective of side
+ */
+int SearchEngine::searchRoot(Board& board, TileState side, int depth, ThreadContext& ctx, int& bestMove) {
+    int ttScore = 0;
+    int ttMove = NO_MOVE;
+    probeTable(board.getHash(), 0, -INFINITE_SCORE, INFINITE_SCORE, 0, ttScore, ttMove, ctx);
+
+    // Principal variation move: the previous iteration's best move
+    int pvMove = ctx.bestMove != NO_MOVE ? ctx.bestMove : ttMove;
+
+    std::vector<int> moves;
+    generateMoves(board, pvMove, 0, side, ctx, moves);
+
+    // Diversify helper threads by rotating the root move order (TT move stays first)
+    if (ctx.id > 0 && moves.size() > 2) {
+        std::rotate(moves.begin() + 1, moves.begin() + 1 + ctx.id % (moves.size() - 1), moves.end());
+    }
+
+    int alpha = -INFINITE_SCORE;
+    int beta = INFINITE_SCORE;
+    bestMove = moves.empty() ? NO_MOVE : moves.front();
+
+    for (int move : moves) {
+        makeMove(board, move, side, ctx);
+        int score = -negamax(board, opponentOf(side), depth - 1, -beta, -alpha, 1, ctx);
+        unmakeMove(board, move, side, ctx);
+
+        if (stopFlag) {
+            break;
+        }
+
+        if (score > alpha) {
+            alpha = score;
+            bestMove = move;
+        }
+    }
+
+    if (!stopFlag) {
+        storeTable(board.getHash(), depth, alpha, TTBound::EXACT, bestMove, 0, ctx);
+    }
+    return alpha;
+}
+
+/**
+ * Negamax alpha-beta search with transposition table cutoffs.
+ *
+ * @param board The position (restored before returning)
+ * @param side The side to move
+ * @param depth Remaining depth in plies
+ * @param alpha Lower bound of the search window
+ * @param beta Upper bound of the search window
+ * @param ply Distance from the root (used to prefer faster wins)
+ * @param ctx Thread context
+ * @return Score from the perspective of side
+ */
+int SearchEngine::negamax(Board& board, TileState side, int depth, int alpha, int beta, int ply,
+                          ThreadContext& ctx) {
+    ctx.nodes++;
+    if (ctx.id == 0 && (ctx.nodes & 1023) == 0) {
+        checkTime();
+    }
+    if (stopFlag.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+
+    GameResult result = board.checkWinner();
+    if (result == GameResult::DRAW) {
+        return 0;
+    }
+    if (result != GameResult::IN_PROGRESS) {
+        // The previous mover completed a line
+        return -(WIN_SCORE - ply);
+    }
+
+    if (depth <= 0) {
+        return network ? network->evaluate(ctx.accumulator, side) : evaluate(board, side);
+    }
+
+    uint64_t hash = board.getHash();
+    int ttScore = 0;
+    int ttMove = NO_MOVE;
+    if (probeTable(hash, depth, alpha, beta, ply, ttScore, ttMove, ctx)) {
+        return ttScore;
+    }
+
+    std::vector<int> moves;
+    generateMoves(board, ttMove, ply, side, ctx, moves);
+
+    int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    int bestMove = NO_MOVE;
+
+    for (size_t i = 0; i < moves.size(); i++) {
+        int move = moves[i];
+        makeMove(board, move, side, ctx);
+        int score = -negamax(board, opponentOf(side), depth - 1, -beta, -alpha, ply + 1, ctx);
+        unmakeMove(board, move, side, ctx);
+
+        if (stopFlag.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+        }
+        if (score > alpha) {
+            alpha = score;
+        }
+        if (alpha >= beta) {
+            recordCutoff(move, static_cast<int>(i), depth, ply, side, ctx);
+            break;
+        }
+    }
+
+    TTBound bound = bestScore <= originalAlpha ? TTBound::UPPER
+                  : bestScore >= beta ? TTBound::LOWER
+                  : TTBound::EXACT;
+    storeTable(hash, depth, bestScore, bound, bestMove, ply, ctx);
+
+    return bestScore;
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Evaluation / Move Generation
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Static evaluation used at the depth horizon. Scores every row, column and diagonal
+ * that is still open for one side: the more marks on an open line, the better.
+ *
+ * @param board The position to evaluate
+ * @param side The side to score for
+ * @return Heuristic score from the perspective of side (always well below WIN_SCORE)
+ */
+int SearchEngine::evaluate(const Board& board, TileState side) {
+    static constexpr int LINE_WEIGHT[4] = {0, 1, 10, 100};
+
+    int size = board.getSize();
+    const auto& grid = board.getGrid();
+    int score = 0;
+
+    auto scoreLine = [&](int startX, int startY, int stepX, int stepY) {
+        int mine = 0;
+        int theirs = 0;
+        for (int i = 0; i < size; i++) {
+            TileState tile = grid[startY + i * stepY][startX + i * stepX];
+            if (tile == side) {
+                mine++;
+            } else if (tile != TileState::EMPTY) {
+                theirs++;
+            }
+        }
+        if (theirs == 0) {
+            score += LINE_WEIGHT[std::min(mine, 3)];
+        } else if (mine == 0) {
+            score -= LINE_WEIGHT[std::min(theirs, 3)];
+        }
+    };
+
+    for (int i = 0; i < size; i++) {
+        scoreLine(0, i, 1, 0);  // Row
+        scoreLine(i, 0, 0, 1);  // Column
+    }
+    scoreLine(0, 0, 1, 1);          // Main diagonal
+    scoreLine(size - 1, 0, -1, 1);  // Anti-diagonal
+
+    return score;
+}
+
+/**
+ * Generates the legal moves of a position in search order: the TT/PV move, the
+ * killer moves of this ply, then the rest by history score with center-first as
+ * the static tiebreak.
+ *
+ * @param board The position
+ * @param firstMove Move to search first (TT or PV move), or NO_MOVE
+ * @param ply Distance from the root (selects the killer slots)
+ * @param side The side to move (selects the history table)
+ * @param ctx Thread context holding killers and history
+ * @param moves Receives the ordered moves (cell index y * size + x)
+ */
+void SearchEngine::generateMoves(const Board& board, int firstMove, int ply, TileState side,
+                                 const ThreadContext& ctx, std::vector<int>& moves) const {
+    int size = board.getSize();
+    const auto& grid = board.getGrid();
+    const int* history = ctx.history[side == TileState::X ? 0 : 1];
+    const int* killers = ctx.killers[std::min(ply, MAX_PLY - 1)];
+
+    // Scores live next to the moves (<= MAX_CELLS entries, no allocation)
+    int scores[MAX_CELLS];
+    moves.clear();
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            if (grid[y][x] != TileState::EMPTY) {
+                continue;
+            }
+            int move = y * size + x;
+            int score = history[move] * 8 + linesThrough(move, size);
+            if (move == firstMove) {
+                score = ORDER_TT_MOVE;
+            } else if (move == killers[0]) {
+                score = ORDER_KILLER + 1;
+            } else if (move == killers[1]) {
+                score = ORDER_KILLER;
+            }
+            scores[moves.size()] = score;
+            moves.push_back(move);
+        }
+    }
+
+    // Insertion sort: at most a handful of moves, mostly already in order
+    for (size_t i = 1; i < moves.size(); i++) {
+        int move = moves[i];
+        int score = scores[i];
+        size_t j = i;
+        for (; j > 0 && scores[j - 1] < score; j--) {
+            moves[j] = moves[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        moves[j] = move;
+        scores[j] = score;
+    }
+}
+
+/**
+ * Updates the ordering heuristics after a beta cutoff: the move becomes a killer for
+ * this ply and gains depth^2 history (all history is halved when it grows too large).
+ */
+void SearchEngine::recordCutoff(int move, int moveIndex, int depth, int ply, TileState side,
+                                ThreadContext& ctx) const {
+    ctx.cutoffs++;
+    if (moveIndex == 0) {
+        ctx.firstMoveCutoffs++;
+    }
+
+    int* killers = ctx.killers[std::min(ply, MAX_PLY - 1)];
+    if (killers[0] != move) {
+        killers[1] = killers[0];
+        killers[0] = move;
+    }
+
+    int* history = ctx.history[side == TileState::X ? 0 : 1];
+    history[move] += depth * depth;
+    if (history[move] > HISTORY_MAX) {
+        for (int cell = 0; cell < MAX_CELLS; cell++) {
+            history[cell] /= 2;
+        }
+    }
+}
+
+/**
+ * Perft: number of leaf nodes at exactly the given depth. Exercises the same move
+ * generation and make/unmake path as the search, so it doubles as a correctness check.
+ * With a network attached, the incrementally updated accumulator is compared with a
+ * fresh refresh at every leaf.
+ *
+ * @param board The position (restored before returning)
+ * @param side The side to move
+ * @param depth Remaining depth in plies
+ * @param accumulatorMatches Cleared if any leaf's accumulator differs from a refresh
+ * @return Number of move sequences of length depth from this position
+ */
+uint64_t SearchEngine::perft(Board& board, TileState side, int depth, bool& accumulatorMatches) const {
+    ThreadContext ctx;
+    if (network) {
+        network->refresh(board, ctx.accumulator);
+    }
+    return perftNode(board, side, depth, ctx, accumulatorMatches);
+}
+
+uint64_t SearchEngine::perftNode(Board& board, TileState side, int depth, ThreadContext& ctx,
+                                 bool& accumulatorMatches) const {
+    if (depth == 0) {
+        if (network) {
+            NnueAccumulator fresh;
+            network->refresh(board, fresh);
+            size_t bytes = network->getHiddenSize() * sizeof(int16_t);
+            for (int perspective = 0; perspective < 2; perspective++) {
+                if (std::memcmp(fresh.values[perspective], ctx.accumulator.values[perspective], bytes) != 0) {
+                    accumulatorMatches = false;
+                }
+            }
+        }
+        return 1;
+    }
+    if (board.checkWinner() != GameResult::IN_PROGRESS) {
+        return 0;
+    }
+
+    std::vector<int> moves;
+    generateMoves(board, NO_MOVE, 0, side, ctx, moves);
+    // Bulk-count the last ply unless the leaves' accumulators need checking
+    if (depth == 1 && !network) {
+        return moves.size();
+    }
+
+    uint64_t leaves = 0;
+    for (int move : moves) {
+        makeMove(board, move, side, ctx);
+        leaves += perftNode(board, opponentOf(side), depth - 1, ctx, accumulatorMatches);
+        unmakeMove(board, move, side, ctx);
+    }
+    return leaves;
+}
+
+/**
+ * Plays a move on the board and updates the NNUE accumulator (if any) alongside.
+ */
+void SearchEngine::makeMove(Board& board, int move, TileState side, ThreadContext& ctx) const {
+    int size = board.getSize();
+    board.setTile(move % size, move / size, side);
+    if (network) {
+        network->addTile(ctx.accumulator, move, side);
+    }
+}
+
+void SearchEngine::unmakeMove(Board& board, int move, TileState side, ThreadContext& ctx) const {
+    int size = board.getSize();
+    board.clearTile(move % size, move / size);
+    if (network) {
+        network->removeTile(ctx.accumulator, move, side);
+    }
+}
+
+/**
+ * Raises the stop flag once the configured time limit is exceeded.
+ * Only the main thread polls the clock; helpers just watch the flag.
+ */
+void SearchEngine::checkTime() {
+    if (config.timeLimit.count() <= 0) {
+        return;
+    }
+    if (std::chrono::steady_clock::now() - searchStart >= config.timeLimit) {
+        stopFlag = true;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Transposition Table
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Probes the transposition table for the given position.
+ *
+ * @param hash Zobrist hash of the position
+ * @param depth Remaining depth; entries with less depth only supply a move
+ * @param alpha Current alpha bound
+ * @param beta Current beta bound
+ * @param ply Distance from the root (to convert stored mate scores)
+ * @param score Receives the stored score if the entry causes a cutoff
+ * @param move Receives the stored best move (even without a cutoff)
+ * @param ctx Thread context (table statistics)
+ * @return true if the stored score can be returned directly
+ */
+bool SearchEngine::probeTable(uint64_t hash, int depth, int alpha, int beta, int ply, int& score, int& move,
+                              ThreadContext& ctx) const {
+    TTEntry entry;
+    if (!table->probe(hash, entry, &ctx.tableStats)) {
+        return false;
+    }
+
+    move = entry.move;
+    if (entry.depth < depth) {
+        return false;
+    }
+
+    int entryScore = entry.score;
+    if (entryScore > MATE_BOUND) {
+        entryScore -= ply;
+    } else if (entryScore < -MATE_BOUND) {
+        entryScore += ply;
+    }
+
+    if (entry.bound == TTBound::EXACT ||
+        (entry.bound == TTBound::LOWER && entryScore >= beta) ||
+        (entry.bound == TTBound::UPPER && entryScore <= alpha)) {
+        score = entryScore;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Stores a search result in the transposition table.
+ *
+ * @param hash Zobrist hash of the position
+ * @param depth Depth the score was searched to
+ * @param score Score from the perspective of the side to move
+ * @param bound Whether score is exact, a lower bound or an upper bound
+ * @param move Best move found, or NO_MOVE
+ * @param ply Distance from the root (mate scores are stored relative to this node)
+ * @param ctx Thread context (table statistics)
+ */
+void SearchEngine::storeTable(uint64_t hash, int depth, int score, TTBound bound, int move, int ply,
+                              ThreadContext& ctx) {
+    if (score > MATE_BOUND) {
+        score += ply;
+    } else if (score < -MATE_BOUND) {
+        score -= ply;
+    }
+
+    table->store(hash, move, score, depth, bound, &ctx.tableStats);
+}
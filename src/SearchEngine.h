@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Board.h"
+#include "Nnue.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Tablebase;
+
+struct SearchConfig {
+    int maxDepth = 9;                       // Plies; capped by the number of empty tiles
+    int threadCount = 1;                    // 1 = single-threaded, >1 = Lazy SMP
+    std::chrono::milliseconds timeLimit{0}; // 0 = no limit
+    size_t ttSizeMB = 16;                   // Only used when the engine allocates its own table
+    bool useHugePages = false;
+};
+
+struct SearchResult {
+    int bestX = -1;
+    int bestY = -1;
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    uint64_t cutoffs = 0;           // Beta cutoffs
+    uint64_t firstMoveCutoffs = 0;  // Beta cutoffs on the first move searched (ordering quality)
+    double elapsedMs = 0.0;
+    TableStats tableStats;
+
+    bool hasMove() const { return bestX >= 0 && bestY >= 0; }
+    double nodesPerSecond() const { return elapsedMs > 0.0 ? nodes * 1000.0 / elapsedMs : 0.0; }
+    double firstMoveCutoffRate() const { return cutoffs > 0 ? static_cast<double>(firstMoveCutoffs) / cutoffs : 0.0; }
+};
+
+class SearchEngine {
+public:
+    static constexpr int WIN_SCORE = 10000;
+    static constexpr int INFINITE_SCORE = 32000;
+
+    explicit SearchEngine(const SearchConfig& config = SearchConfig(),
+                          std::shared_ptr<TranspositionTable> sharedTable = nullptr);
+    ~SearchEngine();
+
+    SearchResult findBestMove(const Board& board, TileState toMove);
+    void stop() { stopFlag = true; }
+    void clearTable();
+
+    const SearchConfig& getConfig() const { return config; }
+    TranspositionTable& getTable() { return *table; }
+
+    static int evaluate(const Board& board, TileState side);
+
+    // Counts move sequences of exactly 'depth' plies (finished games end a sequence early)
+    // using the engine's own move generation and make/unmake; see the perft tool command.
+    // accumulatorMatches is cleared if the NNUE accumulator drifts from a refresh.
+    uint64_t perft(Board& board, TileState side, int depth, bool& accumulatorMatches) const;
+
+    // Positions covered by the tablebase are answered without searching
+    void setTablebase(std::shared_ptr<const Tablebase> tablebase) { this->tablebase = std::move(tablebase); }
+
+    // Evaluate leaves with an NNUE network instead of evaluate() (nullptr or a network
+    // that failed to load = hand-written evaluation)
+    void setNetwork(std::shared_ptr<const NnueNetwork> network) {
+        this->network = network && network->isLoaded() ? std::move(network) : nullptr;
+    }
+
+private:
+    static constexpr int NO_MOVE = -1;
+    static constexpr int MAX_PLY = 64;
+    static constexpr int MAX_CELLS = 64;
+
+    // Per-thread search state (no sharing except through the transposition table)
+    struct ThreadContext {
+        int id = 0;
+        uint64_t nodes = 0;
+        uint64_t cutoffs = 0;
+        uint64_t firstMoveCutoffs = 0;
+        int completedDepth = 0;
+        int bestMove = NO_MOVE;
+        int bestScore = 0;
+        TableStats tableStats;
+        NnueAccumulator accumulator;    // Only maintained when a network is attached
+
+        // Move ordering: two killer moves per ply, history scores per side and cell
+        int killers[MAX_PLY][2];
+        int history[2][MAX_CELLS] = {};
+
+        ThreadContext() {
+            for (auto& slot : killers) {
+                slot[0] = slot[1] = NO_MOVE;
+            }
+        }
+    };
+
+    SearchConfig config;
+    std::atomic<bool> stopFlag{false};
+    std::chrono::steady_clock::time_point searchStart;
+
+    // Shared by all search threads (and possibly other engines/tools)
+    std::shared_ptr<TranspositionTable> table;
+    std::shared_ptr<const Tablebase> tablebase;
+    std::shared_ptr<const NnueNetwork> network;
+
+    void iterativeDeepening(Board board, TileState toMove, ThreadContext& ctx);
+    int searchRoot(Board& board, TileState side, int depth, ThreadContext& ctx, int& bestMove);
+    int negamax(Board& board, TileState side, int depth, int alpha, int beta, int ply, ThreadContext& ctx);
+    void generateMoves(const Board& board, int firstMove, int ply, TileState side, const ThreadContext& ctx,
+                       std::vector<int>& moves) const;
+    void recordCutoff(int move, int moveIndex, int depth, int ply, TileState side, ThreadContext& ctx) const;
+    uint64_t perftNode(Board& board, TileState side, int depth, ThreadContext& ctx, bool& accumulatorMatches) const;
+    void makeMove(Board& board, int move, TileState side, ThreadContext& ctx) const;
+    void unmakeMove(Board& board, int move, TileState side, ThreadContext& ctx) const;
+    void checkTime();
+
+    bool probeTable(uint64_t hash, int depth, int alpha, int beta, int ply, int& score, int& move,
+                    ThreadContext& ctx) const;
+    void storeTable(uint64_t hash, int depth, int score, TTBound bound, int move, int ply, ThreadContext& ctx);
+};
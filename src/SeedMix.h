@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// Derives the seed of job 'index' (a game, a pairing) from a run's seed with the
+// splitmix64 finalizer, so neighbouring indexes get unrelated random streams and a run
+// replays identically for the same seed whatever the thread count.
+inline uint64_t mixSeed(uint64_t seed, uint64_t index) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (index + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,145 @@
+/*******************************************************************************
+ * SelfPlay.cpp
+ *
+ * Self-play training data generation for evaluation functions.
+ *
+ * Architecture:
+ * - One SearchEngine (with its own transposition table) per worker thread; workers
+ *   claim game numbers from a shared counter, so all cores stay busy until done
+ * - Each game is seeded from its game number, so a run is reproducible for a given
+ *   seed regardless of the thread count (only the row order differs)
+ * - Rows are buffered per worker; a full buffer is encoded on the worker and then
+ *   written under the writer lock, so memory is bounded by threads x rowsPerChunk
+ ******************************************************************************/
+
+#include "SelfPlay.h"
+#include "Board.h"
+#include "PositionCodec.h"
+#include "SearchEngine.h"
+#include "SeedMix.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+SelfPlayGenerator::SelfPlayGenerator(const SelfPlayConfig& config)
+    : config(config) {
+}
+
+/**
+ * Plays config.games self-play games across config.threads workers and streams the
+ * samples to config.outputPath.
+ *
+ * @param stats Filled with the number of games, rows, bytes and elapsed time
+ * @return false if the output cannot be written
+ */
+bool SelfPlayGenerator::run(SelfPlayStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+
+    DatasetWriter writer;
+    if (!writer.open(config.outputPath)) {
+        fprintf(stderr, "[SELFPLAY] Cannot write %s\n", config.outputPath.c_str());
+        return false;
+    }
+
+    std::atomic<uint64_t> nextGame{0};
+    std::atomic<bool> failed{false};
+    std::mutex writerMutex;
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < config.threads; t++) {
+        workers.emplace_back([&]() {
+            SearchConfig searchConfig;
+            searchConfig.maxDepth = config.depth;
+            searchConfig.ttSizeMB = 4;
+            SearchEngine engine(searchConfig);
+
+            std::vector<TrainingSample> buffer;
+            buffer.reserve(config.rowsPerChunk);
+
+            auto flush = [&]() {
+                if (buffer.empty()) {
+                    return;
+                }
+                std::vector<uint8_t> encoded = DatasetWriter::encodeChunk(buffer);
+                std::lock_guard<std::mutex> lock(writerMutex);
+                if (!writer.writeChunk(encoded, buffer.size())) {
+                    failed = true;
+                }
+                buffer.clear();
+            };
+
+            uint64_t game;
+            while (!failed && (game = nextGame.fetch_add(1)) < config.games) {
+                std::mt19937_64 rng(mixSeed(config.seed, game));
+                std::uniform_real_distribution<double> chance(0.0, 1.0);
+                Board board;
+                TileState side = TileState::X;
+                size_t firstRow = buffer.size();
+                int size = board.getSize();
+
+                for (int ply = 0; board.checkWinner() == GameResult::IN_PROGRESS; ply++) {
+                    std::vector<int> empty;
+                    for (int cell = 0; cell < size * size; cell++) {
+                        if (board.getTile(cell % size, cell / size) == TileState::EMPTY) {
+                            empty.push_back(cell);
+                        }
+                    }
+
+                    int move = empty[rng() % empty.size()];
+                    if (ply >= config.openingPlies) {
+                        SearchResult result = engine.findBestMove(board, side);
+
+                        TrainingSample sample;
+                        sample.position = PositionCodec::encode(board);
+                        sample.sideToMove = static_cast<uint8_t>(side);
+                        sample.score = static_cast<int16_t>(result.score);
+                        sample.bestMove = static_cast<uint8_t>(result.bestY * size + result.bestX);
+                        sample.ply = static_cast<uint8_t>(ply);
+                        if (chance(rng) >= config.randomMoveRate) {
+                            move = sample.bestMove;
+                        }
+                        sample.playedMove = static_cast<uint8_t>(move);
+                        buffer.push_back(sample);
+                    }
+
+                    board.setTile(move % size, move / size, side);
+                    side = side == TileState::X ? TileState::O : TileState::X;
+                }
+
+                // Back-fill the final result from each sample's side to move
+                GameResult result = board.checkWinner();
+                for (size_t i = firstRow; i < buffer.size(); i++) {
+                    TrainingSample& sample = buffer[i];
+                    if (result == GameResult::DRAW) {
+                        sample.result = 0;
+                    } else {
+                        bool xWon = result == GameResult::X_WINS;
+                        bool sideIsX = sample.sideToMove == static_cast<uint8_t>(TileState::X);
+                        sample.result = xWon == sideIsX ? 1 : -1;
+                    }
+                }
+
+                if (buffer.size() >= config.rowsPerChunk) {
+                    flush();
+                }
+            }
+            flush();
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    stats.games = std::min<uint64_t>(nextGame.load(), config.games);
+    stats.rows = writer.getRowsWritten();
+    stats.bytes = writer.getBytesWritten();
+    stats.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    writer.close();
+    return !failed;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Dataset.h"
+#include <cstdint>
+#include <string>
+
+struct SelfPlayConfig {
+    uint64_t games = 10000;
+    int threads = 1;
+    int depth = 9;                  // Search depth for the values and best moves
+    double randomMoveRate = 0.1;    // Chance of playing a random move instead of the best one
+    int openingPlies = 2;           // Random plies at the start of every game
+    size_t rowsPerChunk = 65536;    // Rows buffered per worker before a chunk is written
+    uint64_t seed = 1;
+    std::string outputPath;
+};
+
+struct SelfPlayStats {
+    uint64_t games = 0;
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+    double elapsedMs = 0.0;
+};
+
+// Generates training data by self-play: every worker thread plays games with its own
+// SearchEngine, records (position, search value, best move, played move, result) per
+// ply and hands full chunks to a shared DatasetWriter.
+class SelfPlayGenerator {
+public:
+    explicit SelfPlayGenerator(const SelfPlayConfig& config);
+
+    bool run(SelfPlayStats& stats);
+
+private:
+    SelfPlayConfig config;
+};
@@ -0,0 +1,450 @@
+/*******************************************************************************
+ * SharedMemoryTransport.cpp
+ *
+ * Same-host transport for GameServer/GameClient: message rings in a POSIX
+ * shared memory segment, with futex doorbells.
+ *
+ * Architecture:
+ * - Segment "/ma1-shm-<port>": a header (owner pid, server doorbell) and
+ *   MAX_SLOTS slots; a client claims a free slot with a compare-and-swap and
+ *   the server picks it up on its next accept()
+ * - Each ring has one producer and one consumer: head and tail are running
+ *   byte counts, published with release/acquire, so the rings need no lock;
+ *   senders on several threads are serialized per channel instead
+ * - Messages are framed as a 32-bit length and the bytes, wrapping around
+ *   the end of the ring
+ * - Doorbells are counters: a writer bumps the reader's after publishing and
+ *   wakes it, a reader sleeps only while the counter still has the value it
+ *   saw before it last found its rings empty, so no wakeup is ever lost
+ * - A slot is freed by whichever end closes second; a crashed peer is found
+ *   by the heartbeats like on the network path
+ ******************************************************************************/
+
+#include "SharedMemoryTransport.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace shm {
+
+constexpr uint32_t MAGIC = 0x5331414d;      // "MA1S"
+constexpr uint32_t LAYOUT_VERSION = 1;
+constexpr size_t RING_BYTES = SharedMemoryListener::RING_BYTES;
+
+enum SlotState : uint32_t {
+    FREE,
+    CLAIMED,            // A client is setting it up
+    OPEN,
+    CLOSED_BY_CLIENT,   // Waiting for the server to let go
+    CLOSED_BY_SERVER    // Waiting for the client to let go
+};
+
+struct Ring {
+    alignas(64) std::atomic<uint64_t> head;     // Bytes ever written
+    alignas(64) std::atomic<uint64_t> tail;     // Bytes ever read
+    alignas(64) uint8_t data[RING_BYTES];
+};
+
+struct Slot {
+    std::atomic<uint32_t> state;
+    std::atomic<uint32_t> generation;           // Bumped on every claim
+    std::atomic<uint32_t> clientDoorbell;
+    std::atomic<int32_t> clientPid;
+    Ring toServer;
+    Ring toClient;
+};
+
+struct Segment {
+    uint32_t magic;
+    uint32_t layoutVersion;
+    int32_t serverPid;
+    std::atomic<uint32_t> ready;
+    alignas(64) std::atomic<uint32_t> serverDoorbell;
+    Slot slots[SharedMemoryListener::MAX_SLOTS];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "Shared memory rings need address-free atomics");
+static_assert((RING_BYTES & (RING_BYTES - 1)) == 0, "Ring size must be a power of two");
+
+struct Mapping {
+    Segment* segment = nullptr;
+    std::string name;
+    bool owner = false;     // The server unlinks the segment when it goes
+
+    ~Mapping();
+};
+
+} // namespace shm
+
+namespace {
+
+using namespace shm;
+
+std::string segmentName(uint16_t port) {
+    return "/ma1-shm-" + std::to_string(port);
+}
+
+#ifdef __linux__
+
+bool processAlive(int32_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int timeoutMs) {
+    timespec timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000000L};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#else
+
+bool processAlive(int32_t) {
+    return false;
+}
+
+void futexWait(std::atomic<uint32_t>&, uint32_t, int timeoutMs) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+}
+
+void futexWake(std::atomic<uint32_t>&) {
+}
+
+#endif
+
+void ringDoorbell(std::atomic<uint32_t>& doorbell) {
+    doorbell.fetch_add(1, std::memory_order_release);
+    futexWake(doorbell);
+}
+
+void copyIn(Ring& ring, uint64_t position, const void* source, size_t size) {
+    size_t offset = position & (RING_BYTES - 1);
+    size_t first = std::min(size, RING_BYTES - offset);
+    std::memcpy(ring.data + offset, source, first);
+    std::memcpy(ring.data, static_cast<const uint8_t*>(source) + first, size - first);
+}
+
+void copyOut(const Ring& ring, uint64_t position, void* destination, size_t size) {
+    size_t offset = position & (RING_BYTES - 1);
+    size_t first = std::min(size, RING_BYTES - offset);
+    std::memcpy(destination, ring.data + offset, first);
+    std::memcpy(static_cast<uint8_t*>(destination) + first, ring.data, size - first);
+}
+
+// Producer side
+bool writeMessage(Ring& ring, const std::string& message) {
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    uint64_t tail = ring.tail.load(std::memory_order_acquire);
+    uint32_t length = static_cast<uint32_t>(message.size());
+    if (RING_BYTES - (head - tail) < sizeof(length) + message.size()) {
+        return false;
+    }
+    copyIn(ring, head, &length, sizeof(length));
+    copyIn(ring, head + sizeof(length), message.data(), message.size());
+    ring.head.store(head + sizeof(length) + message.size(), std::memory_order_release);
+    return true;
+}
+
+// Consumer side
+bool readMessage(Ring& ring, std::string& message) {
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    uint32_t length = 0;
+    if (head - tail < sizeof(length)) {
+        return false;
+    }
+    copyOut(ring, tail, &length, sizeof(length));
+    if (length > head - tail - sizeof(length)) {
+        return false;   // Only possible if the peer scribbled over the ring
+    }
+    message.resize(length);
+    copyOut(ring, tail + sizeof(length), message.data(), length);
+    ring.tail.store(tail + sizeof(length) + length, std::memory_order_release);
+    return true;
+}
+
+} // namespace
+
+shm::Mapping::~Mapping() {
+#ifdef __linux__
+    if (segment) {
+        munmap(segment, sizeof(Segment));
+    }
+    if (owner) {
+        shm_unlink(name.c_str());
+    }
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Channel
+ *---------------------------------------------------------------------------*/
+
+SharedMemoryChannel::SharedMemoryChannel(std::shared_ptr<shm::Mapping> mapping, int slot, bool serverSide)
+    : mapping(std::move(mapping))
+    , slot(slot)
+    , serverSide(serverSide) {
+    generation = slotState().generation.load(std::memory_order_acquire);
+}
+
+SharedMemoryChannel::~SharedMemoryChannel() {
+    close();
+}
+
+Slot& SharedMemoryChannel::slotState() const {
+    return mapping->segment->slots[slot];
+}
+
+Ring& SharedMemoryChannel::outbound() const {
+    return serverSide ? slotState().toClient : slotState().toServer;
+}
+
+Ring& SharedMemoryChannel::inbound() const {
+    return serverSide ? slotState().toServer : slotState().toClient;
+}
+
+/**
+ * Claims a slot of the local server's segment and opens it.
+ *
+ * @param port The server's port
+ * @return The channel, or nullptr if the server is not on this machine or is full
+ */
+std::unique_ptr<SharedMemoryChannel> SharedMemoryChannel::connect(uint16_t port) {
+    if (!SharedMemoryListener::isSupported()) {
+        return nullptr;
+    }
+#ifdef __linux__
+    auto mapping = std::make_shared<Mapping>();
+    mapping->name = segmentName(port);
+    int descriptor = shm_open(mapping->name.c_str(), O_RDWR, 0);
+    if (descriptor < 0) {
+        return nullptr;
+    }
+    struct stat info{};
+    void* address = MAP_FAILED;
+    if (fstat(descriptor, &info) == 0 && static_cast<size_t>(info.st_size) == sizeof(Segment)) {
+        address = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    ::close(descriptor);
+    if (address == MAP_FAILED) {
+        return nullptr;
+    }
+    mapping->segment = static_cast<Segment*>(address);
+
+    Segment& segment = *mapping->segment;
+    if (segment.ready.load(std::memory_order_acquire) != 1 || segment.magic != MAGIC ||
+        segment.layoutVersion != LAYOUT_VERSION || !processAlive(segment.serverPid)) {
+        return nullptr;     // Being set up, another build, or left behind by a crashed server
+    }
+
+    for (int index = 0; index < SharedMemoryListener::MAX_SLOTS; index++) {
+        Slot& candidate = segment.slots[index];
+        uint32_t state = candidate.state.load(std::memory_order_acquire);
+        bool abandoned = state == CLOSED_BY_SERVER && !processAlive(candidate.clientPid.load());
+        if ((state != FREE && !abandoned) ||
+            !candidate.state.compare_exchange_strong(state, CLAIMED, std::memory_order_acq_rel)) {
+            continue;
+        }
+
+        candidate.toServer.head.store(0, std::memory_order_relaxed);
+        candidate.toServer.tail.store(0, std::memory_order_relaxed);
+        candidate.toClient.head.store(0, std::memory_order_relaxed);
+        candidate.toClient.tail.store(0, std::memory_order_relaxed);
+        candidate.clientPid.store(getpid(), std::memory_order_relaxed);
+        candidate.generation.fetch_add(1, std::memory_order_relaxed);
+        candidate.state.store(OPEN, std::memory_order_release);
+        ringDoorbell(segment.serverDoorbell);
+
+        return std::unique_ptr<SharedMemoryChannel>(new SharedMemoryChannel(std::move(mapping), index, false));
+    }
+    std::cerr << "[NETWORK] Shared memory: no free slot on port " << port << std::endl;
+#endif
+    return nullptr;
+}
+
+bool SharedMemoryChannel::send(const std::string& message) {
+    std::lock_guard<std::mutex> lock(sendMutex);
+    if (!isOpen() || !writeMessage(outbound(), message)) {
+        return false;
+    }
+    ringDoorbell(serverSide ? slotState().clientDoorbell : mapping->segment->serverDoorbell);
+    return true;
+}
+
+bool SharedMemoryChannel::receive(std::string& message) {
+    if (closed) {
+        return false;
+    }
+    if (readMessage(inbound(), message)) {
+        return true;
+    }
+    if (serverSide) {
+        return false;   // The listener tracks the server's doorbell
+    }
+    // Anything written after this load rings past it, so wait() will not sleep through it
+    seenDoorbell = slotState().clientDoorbell.load(std::memory_order_acquire);
+    return readMessage(inbound(), message);
+}
+
+int64_t SharedMemoryChannel::pendingBytes() const {
+    const Ring& ring = outbound();
+    return static_cast<int64_t>(ring.head.load(std::memory_order_relaxed) - ring.tail.load(std::memory_order_acquire));
+}
+
+bool SharedMemoryChannel::isOpen() const {
+    const Slot& state = slotState();
+    return !closed && state.state.load(std::memory_order_acquire) == OPEN &&
+           state.generation.load(std::memory_order_acquire) == generation;
+}
+
+void SharedMemoryChannel::close() {
+    std::lock_guard<std::mutex> lock(sendMutex);
+    if (closed) {
+        return;
+    }
+    closed = true;
+
+    Slot& state = slotState();
+    if (state.generation.load(std::memory_order_acquire) != generation) {
+        return;
+    }
+    uint32_t expected = OPEN;
+    if (!state.state.compare_exchange_strong(expected, serverSide ? CLOSED_BY_SERVER : CLOSED_BY_CLIENT)) {
+        // The peer closed first: the slot is ours to free
+        if (expected == (serverSide ? CLOSED_BY_CLIENT : CLOSED_BY_SERVER)) {
+            state.state.store(FREE, std::memory_order_release);
+        }
+    } else if (serverSide && !processAlive(state.clientPid.load())) {
+        state.state.store(FREE, std::memory_order_release);     // Nobody left to let go
+    }
+    ringDoorbell(serverSide ? state.clientDoorbell : mapping->segment->serverDoorbell);
+}
+
+void SharedMemoryChannel::wait(int timeoutMs) {
+    futexWait(slotState().clientDoorbell, seenDoorbell, timeoutMs);
+}
+
+/*-----------------------------------------------------------------------------
+ *                              Listener
+ *---------------------------------------------------------------------------*/
+
+SharedMemoryListener::SharedMemoryListener(std::shared_ptr<shm::Mapping> mapping)
+    : mapping(std::move(mapping)) {
+}
+
+SharedMemoryListener::~SharedMemoryListener() = default;
+
+bool SharedMemoryListener::isSupported() {
+#ifdef __linux__
+    const char* setting = std::getenv("MA1_SHM");
+    return !setting || std::strcmp(setting, "0") != 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Creates the segment clients on this machine connect to.
+ *
+ * @param port The server's port
+ * @return The listener, or nullptr if shared memory is unavailable or a live server owns the port
+ */
+std::unique_ptr<SharedMemoryListener> SharedMemoryListener::create(uint16_t port) {
+    if (!isSupported()) {
+        return nullptr;
+    }
+#ifdef __linux__
+    std::string name = segmentName(port);
+
+    // A segment whose server is gone is left over from a crash
+    int existing = shm_open(name.c_str(), O_RDONLY, 0);
+    if (existing >= 0) {
+        struct stat info{};
+        bool live = false;
+        if (fstat(existing, &info) == 0 && static_cast<size_t>(info.st_size) == sizeof(Segment)) {
+            void* address = mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, existing, 0);
+            if (address != MAP_FAILED) {
+                const Segment* previous = static_cast<const Segment*>(address);
+                live = previous->magic == MAGIC && previous->serverPid != getpid() && processAlive(previous->serverPid);
+                munmap(address, sizeof(Segment));
+            }
+        }
+        ::close(existing);
+        if (live) {
+            std::cerr << "[NETWORK] Shared memory: port " << port << " belongs to another server" << std::endl;
+            return nullptr;
+        }
+        shm_unlink(name.c_str());
+    }
+
+    int descriptor = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (descriptor < 0) {
+        return nullptr;
+    }
+    void* address = MAP_FAILED;
+    if (ftruncate(descriptor, sizeof(Segment)) == 0) {
+        address = mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    ::close(descriptor);
+    if (address == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+
+    auto mapping = std::make_shared<Mapping>();
+    mapping->name = name;
+    mapping->owner = true;
+    mapping->segment = new (address) Segment;   // Fresh pages are zero: every slot FREE
+    mapping->segment->magic = MAGIC;
+    mapping->segment->layoutVersion = LAYOUT_VERSION;
+    mapping->segment->serverPid = getpid();
+    mapping->segment->ready.store(1, std::memory_order_release);
+    return std::unique_ptr<SharedMemoryListener>(new SharedMemoryListener(std::move(mapping)));
+#else
+    (void)port;
+    return nullptr;
+#endif
+}
+
+std::vector<std::unique_ptr<SharedMemoryChannel>> SharedMemoryListener::accept() {
+    Segment& segment = *mapping->segment;
+    seenDoorbell = segment.serverDoorbell.load(std::memory_order_acquire);
+
+    std::vector<std::unique_ptr<SharedMemoryChannel>> opened;
+    for (int index = 0; index < MAX_SLOTS; index++) {
+        Slot& slot = segment.slots[index];
+        if (slot.state.load(std::memory_order_acquire) != OPEN) {
+            continue;
+        }
+        uint32_t generation = slot.generation.load(std::memory_order_acquire);
+        if (generation != acceptedGeneration[index]) {
+            acceptedGeneration[index] = generation;
+            opened.push_back(std::unique_ptr<SharedMemoryChannel>(new SharedMemoryChannel(mapping, index, true)));
+        }
+    }
+    return opened;
+}
+
+void SharedMemoryListener::wait(int timeoutMs) {
+    futexWait(mapping->segment->serverDoorbell, seenDoorbell, timeoutMs);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Connections between a GameServer and GameClients on the same machine through shared
+// memory instead of UDP on loopback. A server owns one segment per port, with a fixed
+// number of slots; each slot is a pair of single-consumer byte rings, one per direction.
+// A writer rings the reader's doorbell (a futex word), so a waiting reader is running
+// again within microseconds of a message being written.
+//
+// Messages keep the framing of the network path (one serialized NetworkPacket each)
+// and arrive reliably and in order. Linux only: isSupported() is false elsewhere, and
+// also when MA1_SHM=0, and then everything stays on the network.
+namespace shm {
+struct Mapping;
+struct Ring;
+struct Slot;
+}
+
+class SharedMemoryChannel {
+public:
+    ~SharedMemoryChannel();
+
+    SharedMemoryChannel(const SharedMemoryChannel&) = delete;
+    SharedMemoryChannel& operator=(const SharedMemoryChannel&) = delete;
+
+    // Client side: claims a free slot of the server listening on port; nullptr if there is
+    // no live server on this machine or all slots are taken
+    static std::unique_ptr<SharedMemoryChannel> connect(uint16_t port);
+
+    // Any thread. False if the message does not fit in the ring right now, or the channel is closed.
+    bool send(const std::string& message);
+    // Network thread: the next whole message, if any
+    bool receive(std::string& message);
+    // Bytes written by this end that the peer has not read yet
+    int64_t pendingBytes() const;
+    // Neither end has closed
+    bool isOpen() const;
+    void close();
+
+    // Client side: blocks until the server writes or timeoutMs passes. Call after receive()
+    // has returned false, so nothing written in between is slept through.
+    void wait(int timeoutMs);
+
+    int getSlot() const { return slot; }
+    uint32_t getGeneration() const { return generation; }
+
+private:
+    friend class SharedMemoryListener;
+
+    SharedMemoryChannel(std::shared_ptr<shm::Mapping> mapping, int slot, bool serverSide);
+
+    std::shared_ptr<shm::Mapping> mapping;
+    int slot;
+    bool serverSide;
+    uint32_t generation = 0;
+    bool closed = false;
+    uint32_t seenDoorbell = 0;
+    std::mutex sendMutex;           // The rings have one producer; the game sends from two threads
+
+    shm::Slot& slotState() const;
+    shm::Ring& outbound() const;
+    shm::Ring& inbound() const;
+};
+
+class SharedMemoryListener {
+public:
+    static constexpr int MAX_SLOTS = 8;
+    static constexpr size_t RING_BYTES = 256 * 1024;    // Per direction; at least GameServer::HARD_PENDING_BYTES
+
+    ~SharedMemoryListener();
+
+    SharedMemoryListener(const SharedMemoryListener&) = delete;
+    SharedMemoryListener& operator=(const SharedMemoryListener&) = delete;
+
+    static bool isSupported();
+    // Creates the segment for port (replacing one left behind by a crashed server); nullptr on failure
+    static std::unique_ptr<SharedMemoryListener> create(uint16_t port);
+
+    // Channels opened by clients since the last call. Call this, then drain every channel,
+    // then wait(); whatever is written after this call wakes wait().
+    std::vector<std::unique_ptr<SharedMemoryChannel>> accept();
+    // Blocks until any client writes (or connects) or timeoutMs passes
+    void wait(int timeoutMs);
+
+private:
+    explicit SharedMemoryListener(std::shared_ptr<shm::Mapping> mapping);
+
+    std::shared_ptr<shm::Mapping> mapping;
+    uint32_t acceptedGeneration[MAX_SLOTS] = {};
+    uint32_t seenDoorbell = 0;
+};
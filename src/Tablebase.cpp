@@ -0,0 +1,552 @@
+/*******************************************************************************
+ * Tablebase.cpp
+ *
+ * Generation and probing of endgame tablebases for the Board.
+ *
+ * Architecture:
+ * - Positions are indexed by their PositionCodec base-3 index (tile (x, y) is digit
+ *   y * size + x, EMPTY=0, X=1, O=2), which covers every placement of marks;
+ *   unreachable ones are INVALID
+ * - Generation is layered, every layer split across worker threads: a forward
+ *   pass from the empty board marks the reachable positions (a layer only
+ *   depends on the layer with one mark fewer), then a retrograde analysis solves
+ *   them from the full board back to the empty board (a layer only depends on
+ *   the layer with one more mark)
+ * - Outcomes are stored at 2 bits per position and compressed in fixed-size blocks
+ *   (PackBits run-length), so a probe only decodes part of one block
+ * - At play time the file is memory-mapped (mmap / MapViewOfFile); nothing is
+ *   loaded or decompressed up front
+ ******************************************************************************/
+
+#include "Tablebase.h"
+#include "PositionCodec.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 2-bit values
+constexpr uint8_t VALUE_INVALID = 0;
+constexpr uint8_t VALUE_WIN = 1;
+constexpr uint8_t VALUE_DRAW = 2;
+constexpr uint8_t VALUE_LOSS = 3;
+
+const char MAGIC[8] = {'M', 'A', '1', 'T', 'B', 0, 0, 0};
+
+/**
+ * PackBits run-length encoding: a control byte c < 128 is followed by c + 1 literal
+ * bytes; c >= 128 repeats the next byte (c - 126) times (2-129).
+ */
+void compressBlock(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    size_t i = 0;
+    while (i < size) {
+        size_t run = 1;
+        while (i + run < size && run < 129 && data[i + run] == data[i]) {
+            run++;
+        }
+
+        if (run >= 2) {
+            out.push_back(static_cast<uint8_t>(run + 126));
+            out.push_back(data[i]);
+            i += run;
+            continue;
+        }
+
+        // Literal run until the next repeat (or 128 bytes)
+        size_t start = i;
+        size_t length = 0;
+        while (i < size && length < 128 && !(i + 1 < size && data[i + 1] == data[i])) {
+            i++;
+            length++;
+        }
+        out.push_back(static_cast<uint8_t>(length - 1));
+        out.insert(out.end(), data + start, data + start + length);
+    }
+}
+
+SolveOutcome toOutcome(uint8_t value) {
+    switch (value) {
+        case VALUE_WIN: return SolveOutcome::WIN;
+        case VALUE_DRAW: return SolveOutcome::DRAW;
+        case VALUE_LOSS: return SolveOutcome::LOSS;
+        default: return SolveOutcome::UNKNOWN;
+    }
+}
+
+} // namespace
+
+Tablebase::Tablebase() = default;
+
+Tablebase::~Tablebase() {
+    close();
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Indexing
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Computes the base-3 index of a position.
+ *
+ * @param board The position
+ * @return Index in [0, 3^(size*size))
+ */
+uint32_t Tablebase::indexOf(const Board& board) {
+    return PositionCodec::encode(board);
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Generation (Retrograde Analysis)
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Generates the tablebase for the current Board size and writes it to disk.
+ *
+ * @param path Output file
+ * @param threads Worker threads per layer
+ * @return true if the file was written
+ */
+bool Tablebase::generate(const std::string& path, int threads) {
+    Board probeBoard;
+    const int size = probeBoard.getSize();
+    const int cells = size * size;
+
+    std::vector<uint32_t> power(cells + 1, 1);
+    for (int i = 1; i <= cells; i++) {
+        power[i] = power[i - 1] * 3;
+    }
+    const uint32_t positionCount = PositionCodec::indexCount(cells);
+
+    // Expand every index once; the tiles of position i are positionCells[i * cells ...]
+    std::vector<uint32_t> allIndices(positionCount);
+    for (uint32_t index = 0; index < positionCount; index++) {
+        allIndices[index] = index;
+    }
+    std::vector<uint8_t> positionCells(static_cast<size_t>(positionCount) * cells);
+    PositionCodec::decodeBatch(allIndices.data(), cells, positionCount, positionCells.data());
+
+    // Bucket positions into layers by number of marks, dropping impossible mark counts
+    std::vector<std::vector<uint32_t>> layers(cells + 1);
+    for (uint32_t index = 0; index < positionCount; index++) {
+        const uint8_t* tiles = &positionCells[static_cast<size_t>(index) * cells];
+        int xCount = static_cast<int>(std::count(tiles, tiles + cells, static_cast<uint8_t>(TileState::X)));
+        int oCount = static_cast<int>(std::count(tiles, tiles + cells, static_cast<uint8_t>(TileState::O)));
+        if (xCount == oCount || xCount == oCount + 1) {
+            layers[xCount + oCount].push_back(index);
+        }
+    }
+
+    std::vector<uint8_t> values(positionCount, VALUE_INVALID);
+    threads = std::max(1, threads);
+
+    // Runs work(index, marks) over one layer, split across the worker threads
+    auto forEachInLayer = [&](int marks, const auto& work) {
+        const auto& layer = layers[marks];
+        std::vector<std::thread> workers;
+
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                for (size_t i = t; i < layer.size(); i += threads) {
+                    work(layer[i], marks);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    };
+
+    auto loadBoard = [&](uint32_t index, Board& board) {
+        const uint8_t* tiles = &positionCells[static_cast<size_t>(index) * cells];
+        for (int cell = 0; cell < cells; cell++) {
+            if (tiles[cell] != 0) {
+                board.setTile(cell % size, cell / size, static_cast<TileState>(tiles[cell]));
+            }
+        }
+    };
+
+    // Forward pass from the empty board: a position is reachable when removing one of the
+    // last mover's marks gives a reachable position that was still in progress. Each
+    // position only reads the previous layer, so workers never write the same entry.
+    constexpr uint8_t UNREACHABLE = 0;
+    constexpr uint8_t FINISHED = 1;
+    constexpr uint8_t OPEN = 2;
+    std::vector<uint8_t> reach(positionCount, UNREACHABLE);
+
+    auto classifyPosition = [&](uint32_t index, int marks) {
+        if (marks > 0) {
+            const uint8_t* tiles = &positionCells[static_cast<size_t>(index) * cells];
+            // X moves when the counts are equal, so X placed the odd-numbered marks
+            uint8_t lastMover = static_cast<uint8_t>(marks % 2 == 1 ? TileState::X : TileState::O);
+            bool hasOpenParent = false;
+            for (int cell = 0; cell < cells && !hasOpenParent; cell++) {
+                hasOpenParent = tiles[cell] == lastMover && reach[index - lastMover * power[cell]] == OPEN;
+            }
+            if (!hasOpenParent) {
+                return;
+            }
+        }
+
+        Board board;
+        loadBoard(index, board);
+        reach[index] = board.checkWinner() == GameResult::IN_PROGRESS ? OPEN : FINISHED;
+    };
+
+    // Solve one reachable position from its (already solved) children
+    auto solvePosition = [&](uint32_t index, int marks) {
+        if (reach[index] == UNREACHABLE) {
+            return;
+        }
+
+        // Every finished position was entered by a move that ended the game, so it is
+        // either a draw or a loss for the side to move
+        if (reach[index] == FINISHED) {
+            Board board;
+            loadBoard(index, board);
+            values[index] = board.checkWinner() == GameResult::DRAW ? VALUE_DRAW : VALUE_LOSS;
+            return;
+        }
+
+        // Children of an open position are all reachable
+        const uint8_t* tiles = &positionCells[static_cast<size_t>(index) * cells];
+        uint32_t toMove = static_cast<uint32_t>(marks % 2 == 0 ? TileState::X : TileState::O);
+        bool canDraw = false;
+        for (int cell = 0; cell < cells; cell++) {
+            if (tiles[cell] != 0) {
+                continue;
+            }
+            uint8_t child = values[index + toMove * power[cell]];
+            if (child == VALUE_LOSS) {
+                values[index] = VALUE_WIN;
+                return;
+            }
+            canDraw |= child == VALUE_DRAW;
+        }
+        values[index] = canDraw ? VALUE_DRAW : VALUE_LOSS;
+    };
+
+    for (int marks = 0; marks <= cells; marks++) {
+        forEachInLayer(marks, classifyPosition);
+    }
+    for (int marks = cells; marks >= 0; marks--) {
+        forEachInLayer(marks, solvePosition);
+    }
+
+    // Pack 4 values per byte and compress block by block
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.boardSize = static_cast<uint32_t>(size);
+    header.positionCount = positionCount;
+    header.positionsPerBlock = POSITIONS_PER_BLOCK;
+    header.blockCount = (positionCount + POSITIONS_PER_BLOCK - 1) / POSITIONS_PER_BLOCK;
+
+    std::vector<uint32_t> offsets;
+    std::vector<uint8_t> compressed;
+    std::vector<uint8_t> packed(POSITIONS_PER_BLOCK / 4);
+
+    for (uint32_t block = 0; block < header.blockCount; block++) {
+        uint32_t first = block * POSITIONS_PER_BLOCK;
+        uint32_t count = std::min(POSITIONS_PER_BLOCK, positionCount - first);
+
+        std::fill(packed.begin(), packed.end(), 0);
+        for (uint32_t i = 0; i < count; i++) {
+            packed[i / 4] |= static_cast<uint8_t>(values[first + i] << ((i % 4) * 2));
+        }
+
+        offsets.push_back(static_cast<uint32_t>(compressed.size()));
+        compressBlock(packed.data(), (count + 3) / 4, compressed);
+    }
+    offsets.push_back(static_cast<uint32_t>(compressed.size()));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        fprintf(stderr, "[TABLEBASE] Cannot write %s\n", path.c_str());
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+
+    size_t counts[4] = {};
+    for (uint8_t value : values) {
+        counts[value]++;
+    }
+    printf("[TABLEBASE] %ux%u: %u indexes, %zu win / %zu draw / %zu loss, %zu bytes (%.1fx compression)\n",
+           header.boardSize, header.boardSize, positionCount,
+           counts[VALUE_WIN], counts[VALUE_DRAW], counts[VALUE_LOSS],
+           sizeof(header) + offsets.size() * sizeof(uint32_t) + compressed.size(),
+           compressed.empty() ? 0.0 : (positionCount / 4.0) / compressed.size());
+
+    return static_cast<bool>(file);
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Memory-Mapped Probing
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Memory-maps a tablebase file and validates its header.
+ *
+ * @param path Tablebase file written by generate()
+ * @return true if the file is mapped and matches the current Board size
+ */
+bool Tablebase::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize)) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    mappedData = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    fileHandle = file;
+    mappingHandle = mapping;
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fileDescriptor, &info) != 0 || info.st_size == 0) {
+        close();
+        return false;
+    }
+    void* memory = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    if (memory != MAP_FAILED) {
+        mappedData = static_cast<const uint8_t*>(memory);
+        mappedSize = static_cast<size_t>(info.st_size);
+    }
+#endif
+
+    if (!mappedData || mappedSize < sizeof(Header)) {
+        fprintf(stderr, "[TABLEBASE] Failed to map %s\n", path.c_str());
+        close();
+        return false;
+    }
+
+    header = reinterpret_cast<const Header*>(mappedData);
+    Board board;
+    uint64_t expectedPositions = PositionCodec::indexCount(board.getSize() * board.getSize());
+    uint64_t expectedBlocks = (expectedPositions + POSITIONS_PER_BLOCK - 1) / POSITIONS_PER_BLOCK;
+    size_t tableBytes = sizeof(Header) + (static_cast<size_t>(header->blockCount) + 1) * sizeof(uint32_t);
+
+    // The counts must be the ones generate() writes for this board size, which also
+    // keeps the offset table (checked against the file size below) in range
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header->version != VERSION ||
+        header->boardSize != static_cast<uint32_t>(board.getSize()) ||
+        header->positionCount != expectedPositions ||
+        header->positionsPerBlock != POSITIONS_PER_BLOCK ||
+        header->blockCount != expectedBlocks ||
+        mappedSize < tableBytes) {
+        fprintf(stderr, "[TABLEBASE] %s is not a valid %dx%d tablebase\n",
+                path.c_str(), board.getSize(), board.getSize());
+        close();
+        return false;
+    }
+
+    blockOffsets = reinterpret_cast<const uint32_t*>(mappedData + sizeof(Header));
+    blockData = mappedData + tableBytes;
+
+    // Offsets must be ascending and inside the file, so every block is a valid range
+    size_t dataBytes = mappedSize - tableBytes;
+    bool offsetsValid = blockOffsets[0] == 0;
+    for (uint32_t block = 0; block < header->blockCount && offsetsValid; block++) {
+        offsetsValid = blockOffsets[block] <= blockOffsets[block + 1];
+    }
+    if (!offsetsValid || blockOffsets[header->blockCount] > dataBytes) {
+        fprintf(stderr, "[TABLEBASE] %s is truncated or corrupt\n", path.c_str());
+        close();
+        return false;
+    }
+
+    printf("[TABLEBASE] Mapped %s (%zu bytes, %u positions)\n", path.c_str(), mappedSize, header->positionCount);
+    return true;
+}
+
+/**
+ * Unmaps the file (if any).
+ */
+void Tablebase::close() {
+#ifdef _WIN32
+    if (mappedData) {
+        UnmapViewOfFile(mappedData);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+    }
+#else
+    if (mappedData) {
+        munmap(const_cast<uint8_t*>(mappedData), mappedSize);
+    }
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+#endif
+
+    mappedData = nullptr;
+    mappedSize = 0;
+    header = nullptr;
+    blockOffsets = nullptr;
+    blockData = nullptr;
+}
+
+/**
+ * Reads the 2-bit value of a position by decoding its block up to the needed byte.
+ *
+ * @param index Base-3 position index
+ * @return VALUE_INVALID/WIN/DRAW/LOSS
+ */
+uint8_t Tablebase::readValue(uint32_t index) const {
+    if (index >= header->positionCount) {
+        return VALUE_INVALID;
+    }
+
+    uint32_t block = index / header->positionsPerBlock;
+    uint32_t target = (index % header->positionsPerBlock) / 4;
+
+    const uint8_t* in = blockData + blockOffsets[block];
+    const uint8_t* end = blockData + blockOffsets[block + 1];
+    uint32_t position = 0;
+
+    while (in < end) {
+        uint8_t control = *in++;
+        uint32_t length;
+        uint8_t byte;
+
+        if (control < 128) {
+            length = control + 1u;
+            if (length > static_cast<uint32_t>(end - in)) {
+                break;
+            }
+            if (target < position + length) {
+                byte = in[target - position];
+            } else {
+                in += length;
+                position += length;
+                continue;
+            }
+        } else {
+            length = control - 126u;
+            if (in == end) {
+                break;
+            }
+            if (target < position + length) {
+                byte = *in;
+            } else {
+                in++;
+                position += length;
+                continue;
+            }
+        }
+
+        return (byte >> ((index % 4) * 2)) & 0x3;
+    }
+    return VALUE_INVALID;
+}
+
+/**
+ * Looks up the exact outcome of a position for the side to move.
+ *
+ * @param board The position
+ * @param outcome Receives WIN/DRAW/LOSS
+ * @return false if no tablebase is loaded or the position is not legal
+ */
+bool Tablebase::probe(const Board& board, SolveOutcome& outcome) const {
+    if (!isOpen()) {
+        return false;
+    }
+
+    uint8_t value = readValue(indexOf(board));
+    if (value == VALUE_INVALID) {
+        return false;
+    }
+    outcome = toOutcome(value);
+    return true;
+}
+
+/**
+ * Picks a move that keeps the tablebase outcome: an immediate win if there is one,
+ * otherwise any move leading to a lost (for the opponent) or drawn position.
+ *
+ * @param board The position
+ * @param toMove The side to move
+ * @param bestX Receives the move's x-coordinate
+ * @param bestY Receives the move's y-coordinate
+ * @param outcome Receives the outcome of the position for the side to move
+ * @return false if the position is not covered or has no moves
+ */
+bool Tablebase::bestMove(const Board& board, TileState toMove, int& bestX, int& bestY, SolveOutcome& outcome) const {
+    if (!probe(board, outcome) || board.checkWinner() != GameResult::IN_PROGRESS) {
+        return false;
+    }
+
+    Board work = board;
+    int size = work.getSize();
+    int bestRank = -1;
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            if (work.getTile(x, y) != TileState::EMPTY) {
+                continue;
+            }
+
+            work.setTile(x, y, toMove);
+            GameResult result = work.checkWinner();
+            SolveOutcome child = SolveOutcome::UNKNOWN;
+            probe(work, child);
+            work.clearTile(x, y);
+
+            // Rank: immediate win > forced win > draw > anything
+            int rank = 0;
+            if (result != GameResult::IN_PROGRESS && result != GameResult::DRAW) {
+                rank = 3;
+            } else if (child == SolveOutcome::LOSS) {
+                rank = 2;
+            } else if (child == SolveOutcome::DRAW) {
+                rank = 1;
+            }
+
+            if (rank > bestRank) {
+                bestRank = rank;
+                bestX = x;
+                bestY = y;
+            }
+        }
+    }
+
+    return bestRank >= 0;
+}
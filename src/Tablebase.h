@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Board.h"
+#include "ProofNumberSolver.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Endgame tablebase: exact WIN/DRAW/LOSS (for the side to move) of every position,
+// stored at 2 bits per position in independently compressed blocks and probed
+// straight from a memory-mapped file.
+class Tablebase {
+public:
+    Tablebase();
+    ~Tablebase();
+
+    Tablebase(const Tablebase&) = delete;
+    Tablebase& operator=(const Tablebase&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return mappedData != nullptr; }
+
+    bool probe(const Board& board, SolveOutcome& outcome) const;
+    bool bestMove(const Board& board, TileState toMove, int& bestX, int& bestY, SolveOutcome& outcome) const;
+
+    static bool generate(const std::string& path, int threads);
+    static uint32_t indexOf(const Board& board);
+
+private:
+    // On-disk layout: Header, uint32 blockOffsets[blockCount + 1], compressed blocks.
+    // Offsets are relative to the start of the block data.
+    struct Header {
+        char magic[8];              // "MA1TB\0\0\0"
+        uint32_t version;
+        uint32_t boardSize;
+        uint32_t positionCount;
+        uint32_t positionsPerBlock;
+        uint32_t blockCount;
+        uint32_t reserved;
+    };
+
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t POSITIONS_PER_BLOCK = 4096; // 1 KB of 2-bit values per block
+
+    const uint8_t* mappedData = nullptr;
+    size_t mappedSize = 0;
+    const Header* header = nullptr;
+    const uint32_t* blockOffsets = nullptr;
+    const uint8_t* blockData = nullptr;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+
+    uint8_t readValue(uint32_t index) const;
+};
@@ -0,0 +1,38 @@
+/*******************************************************************************
+ * TokenBucket.cpp
+ *
+ * Rate limiting shared by the chat relay and connection admission.
+ *
+ * Architecture:
+ * - Tokens are refilled lazily from the elapsed time when the bucket is used,
+ *   so an idle bucket costs nothing
+ ******************************************************************************/
+
+#include "TokenBucket.h"
+#include <algorithm>
+
+TokenBucket::TokenBucket(double ratePerSecond, double burst)
+    : ratePerSecond(ratePerSecond)
+    , burst(burst)
+    , tokens(burst)
+    , lastRefill(std::chrono::steady_clock::now()) {
+}
+
+double TokenBucket::tokensAt(std::chrono::steady_clock::time_point now) const {
+    double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+    return std::min(burst, tokens + std::max(0.0, elapsed) * ratePerSecond);
+}
+
+bool TokenBucket::consume(std::chrono::steady_clock::time_point now) {
+    tokens = tokensAt(now);
+    lastRefill = now;
+    if (tokens < 1.0) {
+        return false;
+    }
+    tokens -= 1.0;
+    return true;
+}
+
+bool TokenBucket::isFull(std::chrono::steady_clock::time_point now) const {
+    return tokensAt(now) >= burst;
+}
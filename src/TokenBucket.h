@@ -0,0 +1,21 @@
+#pragma once
+
+#include <chrono>
+
+// Token bucket: 'burst' tokens, refilled at 'ratePerSecond'; one token per event (message, accept, ...)
+class TokenBucket {
+public:
+    TokenBucket(double ratePerSecond, double burst);
+
+    bool consume(std::chrono::steady_clock::time_point now);
+    // A full bucket behaves exactly like a new one, so it can be dropped
+    bool isFull(std::chrono::steady_clock::time_point now) const;
+
+private:
+    double ratePerSecond;
+    double burst;
+    double tokens;
+    std::chrono::steady_clock::time_point lastRefill;
+
+    double tokensAt(std::chrono::steady_clock::time_point now) const;
+};
@@ -0,0 +1,401 @@
+/*******************************************************************************
+ * Tournament.cpp
+ *
+ * Bot-vs-bot tournaments for tuning engine configurations before deploying them.
+ *
+ * Architecture:
+ * - Games are played directly on Board (setTile/checkWinner are the rules), so no
+ *   sockets, queues or game threads are involved and thousands of games run per second
+ * - Every game starts with a few seeded random plies so deterministic engines do not
+ *   replay the same game; colors alternate within each pairing
+ * - Round-robin schedules all games at once; Swiss schedules round by round, pairing
+ *   engines with similar scores that have not met yet
+ * - A pool of worker threads pulls games from a shared index (one transposition table
+ *   per worker); finished games are appended to the output file immediately
+ * - Elo is a maximum-likelihood fit over all pairings (field average = 0), with a 95%
+ *   confidence interval from each engine's score variance
+ ******************************************************************************/
+
+#include "Tournament.h"
+#include "SearchEngine.h"
+#include "SeedMix.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <thread>
+
+namespace {
+
+// Elo difference for an expected score p (0 < p < 1)
+double eloFromScore(double p) {
+    return -400.0 * std::log10(1.0 / p - 1.0);
+}
+
+double expectedScore(double eloDifference) {
+    return 1.0 / (1.0 + std::pow(10.0, -eloDifference / 400.0));
+}
+
+const char* resultText(GameResult result) {
+    switch (result) {
+        case GameResult::X_WINS: return "1-0";
+        case GameResult::O_WINS: return "0-1";
+        default: return "1/2-1/2";
+    }
+}
+
+} // namespace
+
+/**
+ * Parses an engine spec: "random" or "d<depth>" (e.g. "d3"), optionally prefixed with
+ * a display name ("fast=d2").
+ */
+bool EngineSpec::parse(const std::string& text, EngineSpec& spec) {
+    size_t separator = text.find('=');
+    std::string name = separator == std::string::npos ? text : text.substr(0, separator);
+    std::string value = separator == std::string::npos ? text : text.substr(separator + 1);
+
+    if (value == "random") {
+        spec.depth = 0;
+    } else if (value.size() > 1 && value[0] == 'd') {
+        spec.depth = std::atoi(value.c_str() + 1);
+        if (spec.depth <= 0) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    spec.name = name;
+    return true;
+}
+
+Tournament::Tournament(const TournamentConfig& config)
+    : config(config) {
+    size_t count = config.engines.size();
+    standings.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        standings[i].name = config.engines[i].name;
+    }
+    points.assign(count, std::vector<double>(count, 0.0));
+    gamesPlayed.assign(count, std::vector<int>(count, 0));
+    byes.assign(count, 0);
+}
+
+/**
+ * Plays the whole tournament and computes the standings.
+ *
+ * @return false if the output file cannot be written or fewer than two engines are given
+ */
+bool Tournament::run() {
+    if (config.engines.size() < 2) {
+        fprintf(stderr, "[TOURNAMENT] Need at least two engines\n");
+        return false;
+    }
+
+    FILE* output = std::fopen(config.outputPath.c_str(), "w");
+    if (!output) {
+        fprintf(stderr, "[TOURNAMENT] Cannot write %s\n", config.outputPath.c_str());
+        return false;
+    }
+    fprintf(output, "game,round,x,o,result,moves,ms\n");
+
+    bool ok = true;
+    if (config.format == PairingFormat::ROUND_ROBIN) {
+        ok = playJobs(roundRobinJobs(), output);
+    } else {
+        for (int round = 1; round <= config.swissRounds && ok; round++) {
+            ok = playJobs(swissJobs(round), output);
+        }
+    }
+
+    std::fclose(output);
+    computeRatings();
+    return ok;
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Pairings
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Adds the games of one pairing, alternating which engine plays X.
+ */
+void Tournament::addPairing(std::vector<GameJob>& jobs, int round, int a, int b) const {
+    for (int game = 0; game < config.gamesPerPairing; game++) {
+        GameJob job;
+        job.round = round;
+        job.xEngine = game % 2 == 0 ? a : b;
+        job.oEngine = game % 2 == 0 ? b : a;
+        // Both colors of a pair of games share the same opening
+        job.seed = mixSeed(config.seed, (static_cast<uint64_t>(round) << 48) ^
+                                        (static_cast<uint64_t>(a) << 32) ^
+                                        (static_cast<uint64_t>(b) << 16) ^ (game / 2));
+        jobs.push_back(job);
+    }
+}
+
+std::vector<Tournament::GameJob> Tournament::roundRobinJobs() const {
+    std::vector<GameJob> jobs;
+    int count = static_cast<int>(config.engines.size());
+    for (int a = 0; a < count; a++) {
+        for (int b = a + 1; b < count; b++) {
+            addPairing(jobs, 1, a, b);
+        }
+    }
+    return jobs;
+}
+
+/**
+ * Pairs engines by current score (highest first), preferring opponents not met yet.
+ * With an odd number of engines the lowest-ranked engine with the fewest byes sits out;
+ * so does any engine the greedy pass cannot pair. A bye scores like a drawn pairing.
+ */
+std::vector<Tournament::GameJob> Tournament::swissJobs(int round) {
+    int count = static_cast<int>(config.engines.size());
+    std::vector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return swissScore(a) > swissScore(b);
+    });
+
+    std::vector<GameJob> jobs;
+    std::vector<bool> paired(count, false);
+
+    if (count % 2 == 1) {
+        int bye = order.back();
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            if (byes[*it] < byes[bye]) {
+                bye = *it;
+            }
+        }
+        byes[bye]++;
+        paired[bye] = true;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int a = order[i];
+        if (paired[a]) {
+            continue;
+        }
+
+        int opponent = -1;
+        for (int j = i + 1; j < count; j++) {
+            int b = order[j];
+            if (paired[b]) {
+                continue;
+            }
+            if (opponent < 0) {
+                opponent = b; // Fallback: closest score, even if already met
+            }
+            if (gamesPlayed[a][b] == 0) {
+                opponent = b;
+                break;
+            }
+        }
+
+        if (opponent >= 0) {
+            paired[a] = paired[opponent] = true;
+            addPairing(jobs, round, a, opponent);
+        } else {
+            byes[a]++;
+            paired[a] = true;
+        }
+    }
+    return jobs;
+}
+
+/**
+ * Score used for Swiss pairing: game points plus half the points of a pairing per bye,
+ * so sitting out a round neither promotes nor demotes an engine. Byes are not games
+ * and do not enter the Elo fit.
+ */
+double Tournament::swissScore(int engine) const {
+    const EngineStanding& standing = standings[engine];
+    return standing.wins + 0.5 * standing.draws + 0.5 * config.gamesPerPairing * byes[engine];
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Playing Games
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Plays all jobs on the worker pool and streams every finished game to the output.
+ */
+bool Tournament::playJobs(const std::vector<GameJob>& jobs, FILE* output) {
+    std::atomic<size_t> nextIndex{0};
+    std::mutex resultMutex;
+    std::vector<std::thread> workers;
+    int threads = std::max(1, std::min<int>(config.threads, static_cast<int>(jobs.size())));
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            auto table = std::make_shared<TranspositionTable>(1);
+
+            size_t index;
+            while ((index = nextIndex.fetch_add(1)) < jobs.size()) {
+                const GameJob& job = jobs[index];
+                GameRecord record = playGame(job, table);
+
+                std::lock_guard<std::mutex> lock(resultMutex);
+                recordResult(job, record.result);
+                fprintf(output, "%d,%d,%s,%s,%s,%s,%.3f\n", nextGameId++, job.round,
+                        config.engines[job.xEngine].name.c_str(), config.engines[job.oEngine].name.c_str(),
+                        resultText(record.result), record.moves.c_str(), record.elapsedMs);
+                fflush(output);
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return !std::ferror(output);
+}
+
+/**
+ * Plays one game: seeded random opening plies, then each side's engine moves.
+ * The table is cleared before every search so one engine's deeper results never
+ * leak into another engine's depth-limited search.
+ */
+Tournament::GameRecord Tournament::playGame(const GameJob& job, const std::shared_ptr<TranspositionTable>& table) const {
+    auto start = std::chrono::steady_clock::now();
+    GameRecord record;
+    std::mt19937_64 rng(job.seed);
+    Board board;
+    TileState side = TileState::X;
+    int size = board.getSize();
+    int ply = 0;
+
+    while (board.checkWinner() == GameResult::IN_PROGRESS) {
+        const EngineSpec& engine = config.engines[side == TileState::X ? job.xEngine : job.oEngine];
+        int move = -1;
+
+        if (ply < config.openingPlies || engine.depth == 0) {
+            std::vector<int> empty;
+            for (int cell = 0; cell < size * size; cell++) {
+                if (board.getTile(cell % size, cell / size) == TileState::EMPTY) {
+                    empty.push_back(cell);
+                }
+            }
+            move = empty[rng() % empty.size()];
+        } else {
+            SearchConfig searchConfig;
+            searchConfig.maxDepth = engine.depth;
+            table->clear();
+            SearchEngine search(searchConfig, table);
+            SearchResult result = search.findBestMove(board, side);
+            move = result.bestY * size + result.bestX;
+        }
+
+        board.setTile(move % size, move / size, side);
+        if (!record.moves.empty()) {
+            record.moves += ' ';
+        }
+        record.moves += std::to_string(move);
+        side = side == TileState::X ? TileState::O : TileState::X;
+        ply++;
+    }
+
+    record.result = board.checkWinner();
+    record.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return record;
+}
+
+void Tournament::recordResult(const GameJob& job, GameResult result) {
+    EngineStanding& x = standings[job.xEngine];
+    EngineStanding& o = standings[job.oEngine];
+    x.games++;
+    o.games++;
+
+    double xPoints = 0.5;
+    if (result == GameResult::X_WINS) {
+        x.wins++;
+        o.losses++;
+        xPoints = 1.0;
+    } else if (result == GameResult::O_WINS) {
+        o.wins++;
+        x.losses++;
+        xPoints = 0.0;
+    } else {
+        x.draws++;
+        o.draws++;
+    }
+
+    points[job.xEngine][job.oEngine] += xPoints;
+    points[job.oEngine][job.xEngine] += 1.0 - xPoints;
+    gamesPlayed[job.xEngine][job.oEngine]++;
+    gamesPlayed[job.oEngine][job.xEngine]++;
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Ratings
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Fits Elo ratings by maximum likelihood (Newton iterations on the pairwise results)
+ * and derives each engine's 95% interval from the variance of its game scores.
+ */
+void Tournament::computeRatings() {
+    size_t count = standings.size();
+    const double scale = std::log(10.0) / 400.0;
+    const double maxRating = 2000.0; // Perfect scores would diverge; clamp them
+    std::vector<double> ratings(count, 0.0);
+
+    for (int iteration = 0; iteration < 200; iteration++) {
+        double largestStep = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            double actual = 0.0;
+            double expected = 0.0;
+            double curvature = 0.0;
+            for (size_t j = 0; j < count; j++) {
+                if (i == j || gamesPlayed[i][j] == 0) {
+                    continue;
+                }
+                double e = expectedScore(ratings[i] - ratings[j]);
+                actual += points[i][j];
+                expected += gamesPlayed[i][j] * e;
+                curvature += gamesPlayed[i][j] * e * (1.0 - e) * scale;
+            }
+            if (curvature <= 0.0) {
+                continue;
+            }
+            double step = std::clamp((actual - expected) / curvature, -200.0, 200.0);
+            ratings[i] = std::clamp(ratings[i] + step, -maxRating, maxRating);
+            largestStep = std::max(largestStep, std::abs(step));
+        }
+        if (largestStep < 0.01) {
+            break;
+        }
+    }
+
+    double mean = std::accumulate(ratings.begin(), ratings.end(), 0.0) / count;
+    for (size_t i = 0; i < count; i++) {
+        EngineStanding& standing = standings[i];
+        standing.elo = ratings[i] - mean;
+
+        // Per-game score variance -> standard error of the mean score -> Elo interval
+        double n = standing.games;
+        double s = standing.score();
+        if (n == 0) {
+            standing.eloError = std::numeric_limits<double>::infinity();
+            continue;
+        }
+        double variance = (standing.wins * (1.0 - s) * (1.0 - s) +
+                           standing.draws * (0.5 - s) * (0.5 - s) +
+                           standing.losses * s * s) / n;
+        double margin = 1.96 * std::sqrt(variance / n);
+        double low = s - margin;
+        double high = s + margin;
+        standing.eloError = low > 0.0 && high < 1.0
+            ? (eloFromScore(high) - eloFromScore(low)) / 2.0
+            : std::numeric_limits<double>::infinity();
+    }
+}
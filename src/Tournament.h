@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Board.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TranspositionTable;
+
+// One engine configuration taking part in a tournament
+struct EngineSpec {
+    std::string name;
+    int depth = 9;          // Search depth in plies; 0 = random legal moves
+
+    static bool parse(const std::string& text, EngineSpec& spec);
+};
+
+enum class PairingFormat {
+    ROUND_ROBIN,
+    SWISS
+};
+
+struct TournamentConfig {
+    std::vector<EngineSpec> engines;
+    PairingFormat format = PairingFormat::ROUND_ROBIN;
+    int gamesPerPairing = 100;      // Colors alternate, so keep it even
+    int swissRounds = 5;            // Only used for SWISS
+    int openingPlies = 2;           // Random plies before the engines take over
+    int threads = 1;
+    uint64_t seed = 1;
+    std::string outputPath;         // Per-game results are streamed here
+};
+
+struct EngineStanding {
+    std::string name;
+    int games = 0;
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+    double elo = 0.0;               // Relative to the field average (0)
+    double eloError = 0.0;          // 95% confidence half-width (infinite on 0% / 100% scores)
+
+    double score() const { return games > 0 ? (wins + 0.5 * draws) / games : 0.0; }
+};
+
+// Headless bot-vs-bot tournament: games are played straight on Board (no sockets, no
+// game threads) by a pool of worker threads, results are streamed to a file as they
+// finish, and engines are rated with Elo and confidence intervals at the end.
+class Tournament {
+public:
+    explicit Tournament(const TournamentConfig& config);
+
+    bool run();
+    const std::vector<EngineStanding>& getStandings() const { return standings; }
+
+private:
+    struct GameJob {
+        int round = 0;
+        int xEngine = 0;
+        int oEngine = 0;
+        uint64_t seed = 0;
+    };
+
+    struct GameRecord {
+        GameResult result = GameResult::DRAW;
+        std::string moves;          // Cell indices (y * size + x) in play order, space-separated
+        double elapsedMs = 0.0;
+    };
+
+    TournamentConfig config;
+    std::vector<EngineStanding> standings;
+    // results[i][j] = points engine i scored against engine j (1 / 0.5 / 0 per game)
+    std::vector<std::vector<double>> points;
+    std::vector<std::vector<int>> gamesPlayed;
+    std::vector<int> byes;
+    int nextGameId = 0;
+
+    std::vector<GameJob> roundRobinJobs() const;
+    std::vector<GameJob> swissJobs(int round);
+    double swissScore(int engine) const;
+    void addPairing(std::vector<GameJob>& jobs, int round, int a, int b) const;
+
+    bool playJobs(const std::vector<GameJob>& jobs, FILE* output);
+    GameRecord playGame(const GameJob& job, const std::shared_ptr<TranspositionTable>& table) const;
+    void recordResult(const GameJob& job, GameResult result);
+    void computeRatings();
+};
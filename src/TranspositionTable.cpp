@@ -0,0 +1,308 @@
+/*******************************************************************************
+ * TranspositionTable.cpp
+ *
+ * Shared, lock-free hash table of position evaluations used by all search
+ * engines and analysis tools.
+ *
+ * Architecture:
+ * - Fixed power-of-two array of 64-byte (cache-line) buckets, 4 entries each
+ * - Each entry is two 64-bit words (key ^ data, data) written with relaxed atomics;
+ *   a probe only accepts an entry if (key ^ data) reproduces the position hash
+ * - Replacement prefers the same position, then an empty slot, then the slot with
+ *   the lowest (depth - 8 * age), so stale entries from older searches go first
+ * - Optional huge-page backing (MAP_HUGETLB / MEM_LARGE_PAGES) with a silent
+ *   fallback to normal pages
+ ******************************************************************************/
+
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <cstdio>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+// Data word layout:
+//   [15.. 0] move + 1 (0 = no move)
+//   [31..16] score (int16)
+//   [39..32] depth
+//   [41..40] bound
+//   [47..42] generation
+uint64_t packData(int move, int score, int depth, TTBound bound, uint8_t generation) {
+    return static_cast<uint64_t>(static_cast<uint16_t>(move + 1))
+         | (static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16)
+         | (static_cast<uint64_t>(std::clamp(depth, 0, 255)) << 32)
+         | (static_cast<uint64_t>(bound) << 40)
+         | (static_cast<uint64_t>(generation & 0x3F) << 42);
+}
+
+int dataMove(uint64_t data) { return static_cast<int>(data & 0xFFFF) - 1; }
+int dataScore(uint64_t data) { return static_cast<int16_t>((data >> 16) & 0xFFFF); }
+int dataDepth(uint64_t data) { return static_cast<int>((data >> 32) & 0xFF); }
+TTBound dataBound(uint64_t data) { return static_cast<TTBound>((data >> 40) & 0x3); }
+uint8_t dataGeneration(uint64_t data) { return static_cast<uint8_t>((data >> 42) & 0x3F); }
+
+} // namespace
+
+/*-----------------------------------------------------------------------------
+ *                          Construction / Allocation
+ *---------------------------------------------------------------------------*/
+
+TranspositionTable::TranspositionTable(size_t sizeMB, bool useHugePages) {
+    allocate(sizeMB, useHugePages);
+}
+
+TranspositionTable::~TranspositionTable() {
+    release();
+}
+
+/**
+ * Reallocates the table with a new size. All entries are lost.
+ * Must not be called while any search is using the table.
+ *
+ * @param sizeMB Requested size in megabytes (rounded down to a power-of-two bucket count)
+ * @param useHugePages Try to back the table with huge/large pages
+ */
+void TranspositionTable::resize(size_t sizeMB, bool useHugePages) {
+    release();
+    allocate(sizeMB, useHugePages);
+}
+
+/**
+ * Allocates the bucket array. Huge pages are attempted first when requested and the
+ * allocation falls back to normal pages if the OS refuses (no reserved huge pages,
+ * missing SeLockMemoryPrivilege on Windows, ...).
+ */
+void TranspositionTable::allocate(size_t sizeMB, bool useHugePages) {
+    size_t requested = std::max<size_t>(1, sizeMB) * 1024 * 1024 / sizeof(Bucket);
+    bucketCount = 1;
+    while (bucketCount * 2 <= requested) {
+        bucketCount *= 2;
+    }
+    bucketMask = bucketCount - 1;
+    hugePages = false;
+
+    size_t bytes = getSizeBytes();
+    void* memory = nullptr;
+
+#ifdef _WIN32
+    if (useHugePages) {
+        SIZE_T largePage = GetLargePageMinimum();
+        if (largePage > 0 && bytes % largePage == 0) {
+            memory = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            hugePages = memory != nullptr;
+        }
+    }
+    if (!memory) {
+        memory = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+#else
+    if (useHugePages) {
+        memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory == MAP_FAILED) {
+            memory = nullptr;
+        } else {
+            hugePages = true;
+        }
+    }
+    if (!memory) {
+        memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            memory = nullptr;
+        }
+#ifdef MADV_HUGEPAGE
+        else if (useHugePages) {
+            // Transparent huge pages as a best-effort fallback
+            madvise(memory, bytes, MADV_HUGEPAGE);
+        }
+#endif
+    }
+#endif
+
+    if (!memory) {
+        bucketCount = 0;
+        bucketMask = 0;
+        throw std::bad_alloc();
+    }
+
+    buckets = static_cast<Bucket*>(memory);
+    for (size_t i = 0; i < bucketCount; i++) {
+        new (&buckets[i]) Bucket();
+    }
+    clear();
+
+    printf("[TT] Allocated %zu MB (%zu buckets)%s\n",
+           bytes / (1024 * 1024), bucketCount, hugePages ? " on huge pages" : "");
+}
+
+/**
+ * Releases the bucket array (Bucket is trivially destructible, so no destructors run).
+ */
+void TranspositionTable::release() {
+    if (!buckets) {
+        return;
+    }
+
+#ifdef _WIN32
+    VirtualFree(buckets, 0, MEM_RELEASE);
+#else
+    munmap(buckets, getSizeBytes());
+#endif
+
+    buckets = nullptr;
+    bucketCount = 0;
+    bucketMask = 0;
+}
+
+/**
+ * Clears all entries and resets the generation. Must not race with probes/stores.
+ */
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < bucketCount; i++) {
+        for (auto& slot : buckets[i].slots) {
+            slot.keyXorData.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Probe / Store
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Looks up a position. Safe to call concurrently with stores from other threads.
+ *
+ * @param hash Zobrist hash of the position
+ * @param entry Receives the stored move, score, depth and bound on a hit
+ * @param stats Optional per-thread counters
+ * @return true if a verified entry for this position was found
+ */
+bool TranspositionTable::probe(uint64_t hash, TTEntry& entry, TableStats* stats) const {
+    if (stats) {
+        stats->probes++;
+    }
+
+    Bucket& bucket = bucketFor(hash);
+    for (const auto& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t keyXorData = slot.keyXorData.load(std::memory_order_relaxed);
+
+        if (dataBound(data) == TTBound::NONE || (keyXorData ^ data) != hash) {
+            continue;
+        }
+
+        entry.move = dataMove(data);
+        entry.score = dataScore(data);
+        entry.depth = dataDepth(data);
+        entry.bound = dataBound(data);
+
+        if (stats) {
+            stats->hits++;
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Stores a position. Safe to call concurrently with probes/stores from other threads;
+ * a lost race just means one of the two writes wins.
+ *
+ * @param hash Zobrist hash of the position
+ * @param move Best move (cell index) or -1 if none
+ * @param score Score to store (callers adjust mate scores to be node-relative)
+ * @param depth Depth the score was searched to
+ * @param bound Whether score is exact, a lower bound or an upper bound
+ * @param stats Optional per-thread counters
+ */
+void TranspositionTable::store(uint64_t hash, int move, int score, int depth, TTBound bound, TableStats* stats) {
+    Bucket& bucket = bucketFor(hash);
+    uint8_t currentGeneration = generation.load(std::memory_order_relaxed);
+    Slot* victim = nullptr;
+    int victimValue = 0;
+    bool victimLive = false;
+
+    for (auto& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t keyXorData = slot.keyXorData.load(std::memory_order_relaxed);
+        bool live = dataBound(data) != TTBound::NONE;
+
+        // Same position: overwrite, but keep the old best move if we have none
+        if (live && (keyXorData ^ data) == hash) {
+            if (move < 0) {
+                move = dataMove(data);
+            }
+            victim = &slot;
+            victimLive = false;
+            if (stats) {
+                stats->overwrites++;
+            }
+            break;
+        }
+
+        if (!live) {
+            if (!victim || victimLive) {
+                victim = &slot;
+                victimLive = false;
+                victimValue = -1000;
+            }
+            continue;
+        }
+
+        // Older generations and shallower entries are cheaper to lose
+        int age = (currentGeneration - dataGeneration(data)) & GENERATION_MASK;
+        int value = dataDepth(data) - 8 * age;
+        if (!victim || (victimLive && value < victimValue)) {
+            victim = &slot;
+            victimLive = true;
+            victimValue = value;
+        }
+    }
+
+    if (stats) {
+        stats->stores++;
+        if (victimLive) {
+            stats->collisions++;
+        }
+    }
+
+    uint64_t data = packData(move, score, depth, bound, currentGeneration);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->keyXorData.store(hash ^ data, std::memory_order_relaxed);
+}
+
+/*-----------------------------------------------------------------------------
+ *                          Statistics
+ *---------------------------------------------------------------------------*/
+
+/**
+ * Estimates how full the table is with entries from the current search, by sampling
+ * the first 1000 buckets.
+ *
+ * @return Occupancy in permill (0-1000)
+ */
+int TranspositionTable::occupancyPermill() const {
+    size_t sampled = std::min<size_t>(1000, bucketCount);
+    uint8_t currentGeneration = generation.load(std::memory_order_relaxed);
+    size_t used = 0;
+
+    for (size_t i = 0; i < sampled; i++) {
+        for (const auto& slot : buckets[i].slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (dataBound(data) != TTBound::NONE && dataGeneration(data) == currentGeneration) {
+                used++;
+            }
+        }
+    }
+
+    return sampled > 0 ? static_cast<int>(used * 1000 / (sampled * ENTRIES_PER_BUCKET)) : 0;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class TTBound : uint8_t {
+    NONE = 0,
+    EXACT = 1,
+    LOWER = 2,
+    UPPER = 3
+};
+
+struct TTEntry {
+    int move = -1;      // Cell index (y * size + x), -1 if none
+    int score = 0;
+    int depth = 0;
+    TTBound bound = TTBound::NONE;
+};
+
+// Counters are accumulated by the caller (one instance per thread) so probing
+// never touches shared cache lines other than the bucket itself
+struct TableStats {
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+    uint64_t stores = 0;
+    uint64_t collisions = 0;    // Store evicted a live entry of a different position
+    uint64_t overwrites = 0;    // Store replaced an entry of the same position
+
+    double hitRate() const { return probes > 0 ? static_cast<double>(hits) / probes : 0.0; }
+
+    TableStats& operator+=(const TableStats& other) {
+        probes += other.probes;
+        hits += other.hits;
+        stores += other.stores;
+        collisions += other.collisions;
+        overwrites += other.overwrites;
+        return *this;
+    }
+};
+
+class TranspositionTable {
+public:
+    static constexpr int ENTRIES_PER_BUCKET = 4;
+
+    explicit TranspositionTable(size_t sizeMB = 16, bool useHugePages = false);
+    ~TranspositionTable();
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    bool probe(uint64_t hash, TTEntry& entry, TableStats* stats = nullptr) const;
+    void store(uint64_t hash, int move, int score, int depth, TTBound bound, TableStats* stats = nullptr);
+
+    void newSearch() { generation.store((generation.load() + 1) & GENERATION_MASK); }
+    void clear();
+    void resize(size_t sizeMB, bool useHugePages);
+
+    int occupancyPermill() const;
+    size_t getBucketCount() const { return bucketCount; }
+    size_t getSizeBytes() const { return bucketCount * sizeof(Bucket); }
+    bool isUsingHugePages() const { return hugePages; }
+
+private:
+    static constexpr uint64_t GENERATION_MASK = 0x3F;
+
+    // Lockless entry: the key is stored XOR-ed with the data word, so a torn write
+    // (key from one store, data from another) fails verification instead of
+    // returning another position's data
+    struct Slot {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[ENTRIES_PER_BUCKET];
+    };
+    static_assert(sizeof(Bucket) == 64, "Bucket must fill exactly one cache line");
+
+    Bucket* buckets = nullptr;
+    size_t bucketCount = 0;
+    uint64_t bucketMask = 0;
+    bool hugePages = false;
+    std::atomic<uint8_t> generation{0};
+
+    void allocate(size_t sizeMB, bool useHugePages);
+    void release();
+
+    Bucket& bucketFor(uint64_t hash) const { return buckets[hash & bucketMask]; }
+};